@@ -0,0 +1,64 @@
+/**
+ * @file AsyncNeoPixel.ino
+ * @brief Example sketch for asynchronous NeoPixel output on the RP2040.
+ *
+ * @details By default `show()` bit-bangs the whole strip with interrupts disabled,
+ * which takes 30 µs per pixel. This sketch attaches a PIO/DMA transport to the strip,
+ * so `show()` only starts the transmission and the loop keeps running. It shows how to:
+ * 1.  Start an Rp2040PioStripTransport and attach it with `setTransport()`.
+ * 2.  Render the next frame while the previous one is still being sent.
+ * 3.  Use `isBusy()` and a completion callback.
+ *
+ * ### Hardware Setup:
+ * - An RP2040 board, e.g. a Seeed XIAO RP2040 or a Raspberry Pi Pico.
+ * - A NeoPixel (WS2812B) strip with 300 pixels, data input on GPIO 6.
+ * - Provide appropriate 5V power and ground to the strip.
+ */
+#include <ArduinoLedDriverHAL.h>
+#include <StripTransport_Rp2040.h>
+
+const uint8_t stripPin = 6;
+const uint16_t numLeds = 300;
+
+ArduinoLedDriverHAL ledHal;
+Rp2040PioStripTransport transport(stripPin);
+LedNeoPixel* strip;
+
+volatile uint32_t framesSent = 0;
+
+// Called from the DMA interrupt when a frame was handed to the PIO.
+void onFrameSent(void*) {
+  framesSent++;
+}
+
+void setup() {
+  Serial.begin(115200);
+  const uint8_t pins[] = {stripPin};
+  strip = static_cast<LedNeoPixel*>(ledHal.addLeds(NEOPIXEL, pins, 1, numLeds));
+  if (strip && transport.begin()) {
+    transport.setCompletionCallback(onFrameSent);
+    strip->setTransport(&transport);
+  }
+}
+
+void loop() {
+  static uint16_t position = 0;
+
+  // Render the next frame. The render buffer is separate from the one being sent.
+  strip->fill(0, numLeds, {0, 0, 0});
+  strip->fill(position, 10, {0, 0, 255});
+  position = (position + 1) % (numLeds - 10);
+
+  // Starts the transmission and returns; waits only if the previous frame is still busy.
+  strip->show();
+
+  // The CPU is free here while the strip is being updated.
+  if (!strip->isBusy()) {
+    Serial.println("frame already done");
+  }
+  if (framesSent % 100 == 0) {
+    Serial.print("frames sent: ");
+    Serial.println(framesSent);
+  }
+  delay(10);
+}
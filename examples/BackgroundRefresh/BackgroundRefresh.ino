@@ -0,0 +1,93 @@
+/**
+ * @file BackgroundRefresh.ino
+ * @brief Refreshes a charlieplexed array and a matrix in the background.
+ *
+ * @details This sketch demonstrates the background POV refresh (@see PovRefresh.h):
+ * 1.  The drivers are registered with a refresh that scans them at 200 frames per
+ *     second, independently of the loop.
+ * 2.  The loop draws and calls `show()`, which commits the finished frame. It may
+ *     block with `delay()` without the displays flickering.
+ * 3.  The measured refresh rate and jitter are printed every second.
+ *
+ * On the RP2040 the scan runs in a timer interrupt on the second core. On other
+ * boards the loop polls the refresh, so there it must not block.
+ *
+ * ### Hardware Setup:
+ * - Eight pins (2-9) driving a charlieplexed array of 8 * 7 = 56 LEDs.
+ * - A 4x4 LED matrix with rows on pins 10-13 and columns on pins 14-17.
+ */
+#include <ArduinoLedDriverHAL.h>
+#include <PovRefresh.h>
+#if defined(ARDUINO_ARCH_RP2040)
+#include <PovRefresh_Rp2040.h>
+Rp2040PovRefresh refresh(200);
+#else
+PovRefresh refresh(200);
+#endif
+
+ArduinoLedDriverHAL hal;
+
+const uint8_t charliePins[] = {2, 3, 4, 5, 6, 7, 8, 9};
+const uint8_t matrixPins[] = {10, 11, 12, 13, 14, 15, 16, 17};
+
+LedCharliePlex* charlie;
+LedMatrix* matrix;
+uint16_t position = 0;
+unsigned long lastReport = 0;
+
+void setup() {
+  Serial.begin(115200);
+  charlie = static_cast<LedCharliePlex*>(hal.addLeds(CHARLIEPLEX, charliePins, sizeof(charliePins)));
+  matrix = static_cast<LedMatrix*>(hal.addLeds(MATRIX, matrixPins, sizeof(matrixPins), 4));
+
+  // Light the LEDs of one anode together, at most four at a time.
+  charlie->setScanMode(LedCharliePlex::SCAN_ROW);
+  charlie->setMaxLedsPerStep(4);
+
+  refresh.add(*charlie);
+  refresh.add(*matrix);
+}
+
+#if defined(ARDUINO_ARCH_RP2040)
+void setup1() {
+  // The alarm interrupt runs on the core that starts it.
+  refresh.begin();
+}
+
+void loop1() {
+}
+#endif
+
+void loop() {
+  // Draw the next frame: a dot chasing around both displays.
+  charlie->fill(0, charlie->numPixels(), {0, 0, 0});
+  charlie->setPixelColor(position % charlie->numPixels(), {255, 255, 255});
+  matrix->fill(0, matrix->numPixels(), {0, 0, 0});
+  matrix->setPixelColor(position % matrix->numPixels(), {255, 255, 255});
+  position++;
+
+  // Commit both frames; the refresh switches to them at its next frame boundary.
+  charlie->show();
+  matrix->show();
+
+#if defined(ARDUINO_ARCH_RP2040)
+  delay(50);
+#else
+  unsigned long drawn = millis();
+  while (millis() - drawn < 50) {
+    refresh.poll(micros());
+  }
+#endif
+
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    PovRefreshStats stats = refresh.getStats();
+    Serial.print("Refresh: ");
+    Serial.print(stats.refreshHz);
+    Serial.print(" Hz, jitter mean ");
+    Serial.print(stats.meanJitterMicros());
+    Serial.print(" us, max ");
+    Serial.print(stats.maxJitterMicros);
+    Serial.println(" us");
+  }
+}
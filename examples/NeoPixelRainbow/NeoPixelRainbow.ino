@@ -5,9 +5,9 @@
  * @details This sketch demonstrates how to use the LedNeoPixel driver, which is a
  * wrapper around the Adafruit_NeoPixel library. It shows how to:
  * 1.  Instantiate a NeoPixel driver.
- * 2.  Cast the base `Led*` to a `LedNeoPixel*` to access specific methods
- *     like `numPixels()` and `ColorHSV()`.
- * 3.  Create a rainbow animation using the underlying library's utility functions.
+ * 2.  Cast the base `Led*` to a `LedNeoPixel*` to access strip methods
+ *     like `numPixels()` and `fillRainbow()`.
+ * 3.  Create a rainbow animation, with gamma applied by a ColorCorrection.
  *
  * ### Hardware Setup:
  * - An Adafruit NeoPixel (WS2812B) strip with at least 10 pixels.
@@ -27,11 +27,15 @@ const uint16_t numLeds = 10;
 // Create a pointer for our NeoPixel object
 LedNeoPixel* myStrip;
 
+// Gamma correction, applied by the driver when the pixels are sent
+ColorCorrection gammaCorrection;
+
 void setup() {
   // Create the LED driver using the factory
   // We cast the generic Led* pointer returned by addLeds to a LedNeoPixel*
   // so we can access the specific helper methods of the NeoPixel class.
   myStrip = static_cast<LedNeoPixel*>(ledHal.addLeds(NEOPIXEL, neoPixelPins, 1, numLeds));
+  ledHal.setColorCorrection(&gammaCorrection);
 }
 
 void loop() {
@@ -45,14 +49,8 @@ void loop() {
 void rainbow(int wait) {
   // Cycle through all 65536 hues
   for (long firstPixelHue = 0; firstPixelHue < 65536; firstPixelHue += 256) {
-    // Set the color of each pixel
-    for (int i = 0; i < myStrip->numPixels(); i++) {
-      // Calculate the hue for this pixel, spreading it across the strip
-      int pixelHue = firstPixelHue + (i * 65536L / myStrip->numPixels());
-      // The LedNeoPixel class exposes the underlying ColorHSV and gamma32 methods
-      // from the Adafruit library for convenience.
-      myStrip->setColor(i, myStrip->gamma32(myStrip->ColorHSV(pixelHue)));
-    }
+    // Spread one full hue circle across the strip, rendered in a single pass
+    myStrip->fillRainbow(0, myStrip->numPixels(), firstPixelHue, 65536L / myStrip->numPixels());
     // After setting all the pixel colors in the buffer, push them to the strip.
     myStrip->show();
     delay(wait);
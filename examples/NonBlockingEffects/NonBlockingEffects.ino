@@ -0,0 +1,62 @@
+/**
+ * @file NonBlockingEffects.ino
+ * @brief Runs several animations without `delay()` while a matrix is refreshed.
+ *
+ * @details This sketch demonstrates the effect engine (@see LedEffects.h):
+ * 1.  Effects are attached to single drivers, to a group, or to a strip.
+ * 2.  `EffectEngine::tick()` is called once per loop iteration and only updates
+ *     effects whose next step is due.
+ * 3.  A time budget keeps each tick short, so the multiplexed matrix, which must
+ *     be refreshed on every iteration, does not flicker.
+ *
+ * ### Hardware Setup:
+ * - A 4x4 LED matrix with rows on pins 2-5 and columns on pins 6-9.
+ * - A common anode RGB LED on pins 10, 11 and 12.
+ * - Two single LEDs on pins 14 and 15, blinking together as group 1.
+ * - A NeoPixel strip with 30 pixels on pin 16.
+ */
+#include <ArduinoLedDriverHAL.h>
+#include <LedEffects.h>
+
+ArduinoLedDriverHAL hal;
+EffectEngine effects(&hal);
+
+const uint8_t matrixPins[] = {2, 3, 4, 5, 6, 7, 8, 9};
+const uint8_t rgbPins[] = {10, 11, 12};
+const uint8_t signalPins[] = {14, 15};
+const uint8_t stripPin = 16;
+
+LedMatrix* matrix;
+
+const RgbColor cycleColors[] = {{255, 0, 0}, {0, 255, 0}, {0, 0, 255}};
+
+void setup() {
+  matrix = static_cast<LedMatrix*>(hal.addLeds(MATRIX, matrixPins, sizeof(matrixPins), 4));
+  Led* rgb = hal.addLeds(RGB_LED, rgbPins, 3);
+  hal.addLeds(SINGLE_LED, &signalPins[0], 1, 0, 1);
+  hal.addLeds(SINGLE_LED, &signalPins[1], 1, 0, 1);
+  LedStrip* strip = static_cast<LedStrip*>(hal.addLeds(NEOPIXEL, &stripPin, 1, 30));
+
+  // Effects must outlive the engine's use of them, so they are created once here.
+  static ColorCycleEffect cycle(*rgb, cycleColors, 3, 1000);
+  static BlinkEffect crossing(hal, 1, {255, 255, 255}, 500, 500);
+  static RainbowEffect rainbow(*strip, 65536 / 30, 5000);
+
+  uint32_t now = millis();
+  effects.add(cycle, now);
+  effects.add(crossing, now);
+  effects.add(rainbow, now);
+
+  // Spend at most 1.5 ms per tick on effects, including the ~1 ms it takes to send
+  // the 30 pixels of the strip; the rest waits for the next tick.
+  effects.setBudget(1500);
+
+  matrix->setColor(1, 1, {255, 0, 0});
+}
+
+void loop() {
+  effects.tick(millis());
+
+  // The matrix still gets a row refresh on every iteration.
+  matrix->show();
+}
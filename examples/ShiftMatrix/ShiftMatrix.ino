@@ -0,0 +1,55 @@
+/**
+ * @file ShiftMatrix.ino
+ * @brief Example sketch for a 16x32 LED panel behind 74HC595 shift registers.
+ *
+ * @details This sketch demonstrates the LedShiftMatrix driver. A diagonal gradient
+ * scrolls across the panel, shown with 16 brightness levels by bit angle modulation.
+ * Only three pins are used, however large the panel is.
+ *
+ * ### Hardware Setup:
+ * - Six 74HC595 registers in one chain: MOSI → four column registers → two row registers.
+ * - SCK to all SRCLK inputs, pin 10 to all RCLK (latch) inputs, OE tied low.
+ * - The row outputs switch the rows through drivers that are active LOW, e.g. PNP
+ *   transistors; the column outputs light an LED when HIGH.
+ *
+ * ### Important:
+ * As with LedMatrix, `show()` lights one row per call and must be called on every
+ * iteration of the `loop()`, so all animation uses non-blocking timers. With
+ * a PovRefresh the panel is scanned in the background instead
+ * (@see BackgroundRefresh.ino).
+ */
+#include <LedHAL_ShiftMatrix.h>
+
+#define ROWS 16
+#define COLS 32
+#define LATCH_PIN 10
+
+LedShiftMatrix panel(LATCH_PIN, ROWS, COLS);
+
+// --- Animation State ---
+uint8_t offset = 0;
+unsigned long lastUpdateTime = 0;
+const int updateInterval = 40; // ms, speed of the animation
+
+void setup() {
+  panel.begin();                  // Hardware SPI at 8 MHz
+  panel.setBitAngleModulation(4); // 16 levels, 15 slots of 8 µs per row
+  panel.setBrightness(128);
+}
+
+void loop() {
+  unsigned long currentTime = millis();
+
+  if (currentTime - lastUpdateTime >= updateInterval) {
+    lastUpdateTime = currentTime;
+    offset++;
+    for (uint8_t row = 0; row < ROWS; row++) {
+      for (uint8_t col = 0; col < COLS; col++) {
+        uint8_t level = (uint8_t)((row + col + offset) * 8);
+        panel.setColor(col, row, {level, level, level});
+      }
+    }
+  }
+
+  panel.show();
+}
@@ -0,0 +1,44 @@
+/**
+ * @file StaticLayout.ino
+ * @brief Example sketch for the compile-time configured StaticLedHAL.
+ *
+ * @details When the wiring of a layout is known at build time, the drivers can be
+ * listed as template arguments of `StaticLedHAL`. Pins, pixel counts and group IDs
+ * become compile-time constants, so every call is a direct function call without
+ * virtual dispatch, and group operations are unrolled by the compiler.
+ *
+ * ### Hardware Setup:
+ * - A single-color LED connected to pin 13 (group 0).
+ * - A common anode RGB LED with its R, G, B pins connected to 9, 10, and 11 (group 1).
+ * - A NeoPixel (WS2812B) strip with 30 pixels on pin 6 (group 1).
+ */
+#include <StaticLedHAL.h>
+
+StaticLedHAL<StaticLed::Single<13>,
+             StaticLed::Rgb<9, 10, 11, 1>,
+             StaticLed::NeoPixel<6, 30, 1>> leds;
+
+void setup() {
+  // The drivers are constructed with the HAL, but touch the hardware only here.
+  leds.begin();
+}
+
+void loop() {
+  // The group ID is a template argument: only the members of group 1 are called.
+  leds.beginFrame();
+  leds.setGroupColor<1>({255, 0, 0});
+  leds.commitFrame();
+  leds.setGroupBrightness<0>(255);
+  delay(1000);
+
+  leds.beginFrame();
+  leds.setGroupColor<1>({0, 0, 255});
+  leds.commitFrame();
+  leds.setGroupBrightness<0>(0);
+  delay(1000);
+
+  // Individual drivers are addressed by their position in the list.
+  leds.get<2>().setPixelColor(0, {255, 255, 255});
+  leds.get<2>().show();
+  delay(1000);
+}
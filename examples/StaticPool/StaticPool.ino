@@ -0,0 +1,54 @@
+/**
+ * @file StaticPool.ino
+ * @brief Example sketch for the heap-free StaticLedDriverHAL.
+ *
+ * @details This sketch creates the same kinds of drivers as the other examples,
+ * but through `StaticLedDriverHAL`, which places every driver and its buffers in
+ * a fixed-size arena inside the HAL object. No heap memory is used, and the RAM
+ * footprint is reported by the compiler as part of the global variables.
+ *
+ * At startup the sketch prints how much of the arena the drivers occupy, which
+ * helps to size the `ArenaBytes` template parameter for a given layout.
+ *
+ * ### Hardware Setup:
+ * - A single-color LED connected to pin 13.
+ * - A common anode RGB LED with its R, G, B pins connected to 9, 10, and 11.
+ * - A NeoPixel (WS2812B) strip with 30 pixels on pin 6.
+ * - Open the Serial Monitor to see the memory report.
+ */
+#include <StaticLedDriverHAL.h>
+
+// Room for up to 4 drivers sharing a 512 byte arena.
+StaticLedDriverHAL<4, 512> ledHal;
+
+const uint8_t singleLedPins[] = {13};
+const uint8_t rgbLedPins[] = {9, 10, 11};
+const uint8_t neoPixelPins[] = {6};
+const uint16_t numLeds = 30;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  // Group 0: single LED and RGB LED, group 1: the strip.
+  ledHal.addLeds(SINGLE_LED, singleLedPins, 1, 0, 0);
+  ledHal.addLeds(RGB_LED, rgbLedPins, 3, 0, 0);
+  if (!ledHal.addLeds(NEOPIXEL, neoPixelPins, 1, numLeds, 1)) {
+    Serial.println("Arena too small for the strip, increase ArenaBytes.");
+  }
+
+  Serial.print("Drivers: ");
+  Serial.println(ledHal.getLedCount());
+  Serial.print("Arena bytes used: ");
+  Serial.print(ledHal.getArenaUsed());
+  Serial.print(" of ");
+  Serial.println(ledHal.getArenaCapacity());
+}
+
+void loop() {
+  ledHal.setGroupColor(0, {255, 160, 40});
+  ledHal.setGroupColor(1, {0, 0, 64});
+  delay(1000);
+  ledHal.setGroupColor(0, {0, 0, 0});
+  delay(1000);
+}
@@ -0,0 +1,143 @@
+/**
+ * @file Benchmark.h
+ * @brief Minimal benchmark harness for the host build.
+ *
+ * A benchmark suite is a function registered with LED_BENCHMARK_SUITE that calls
+ * `BenchmarkRunner::run()` once per parameter combination. Each run measures the
+ * host wall-clock time per operation together with the HostSim counters (GPIO
+ * calls, strip bytes, virtual time) per operation, so that results describe both
+ * the CPU cost of the driver code and the I/O it would generate on a board.
+ */
+#ifndef XDUINORAILS_BENCHMARK_H
+#define XDUINORAILS_BENCHMARK_H
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <HostSim.h>
+
+/**
+ * @struct BenchmarkResult
+ * @brief Measurements of a single benchmark run.
+ */
+struct BenchmarkResult {
+    std::string suite;                                  ///< Name of the suite the run belongs to.
+    std::string name;                                   ///< Name of the measured operation.
+    std::vector<std::pair<std::string, long>> params;   ///< Parameters of the run.
+    uint64_t iterations = 0;                            ///< Number of timed operations.
+    double nsPerOp = 0;                                 ///< Host wall-clock time per operation.
+    double gpioCallsPerOp = 0;                          ///< GPIO calls per operation.
+    double bytesPerOp = 0;                              ///< Bytes sent to strips or through SPI per operation.
+    double showsPerOp = 0;                              ///< Strip transmissions per operation.
+    double simUsPerOp = 0;                              ///< Virtual (on-board) time per operation.
+};
+
+/**
+ * @class BenchmarkRunner
+ * @brief Times operations and collects the results of all suites.
+ */
+class BenchmarkRunner {
+public:
+    /**
+     * @brief Measures an operation.
+     *
+     * The operation is run once to estimate its cost, then repeated until at least
+     * the minimum measurement time has passed. HostSim counters are reset before the
+     * timed loop so that they only reflect the measured operations.
+     *
+     * @param name The name of the operation.
+     * @param params The parameters of this run, reported alongside the results.
+     * @param op The operation to measure. One call is one "op" (typically one frame).
+     */
+    template <typename Op>
+    void run(const std::string& name, std::vector<std::pair<std::string, long>> params, Op&& op) {
+        if (!_filter.empty() && (_suite + "/" + name).find(_filter) == std::string::npos) {
+            return;
+        }
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point start = Clock::now();
+        op();
+        double estimateNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        uint64_t iterations = estimateNs > 0 ? (uint64_t)(_minTimeNs / estimateNs) : _maxIterations;
+        if (iterations < 1) {
+            iterations = 1;
+        }
+        if (iterations > _maxIterations) {
+            iterations = _maxIterations;
+        }
+
+        HostSim::resetCounters();
+        uint64_t simStart = HostSim::nowNs();
+        start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            op();
+        }
+        double elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        const HostSim::Counters& counters = HostSim::counters();
+
+        BenchmarkResult result;
+        result.suite = _suite;
+        result.name = name;
+        result.params = std::move(params);
+        result.iterations = iterations;
+        result.nsPerOp = elapsedNs / iterations;
+        result.gpioCallsPerOp = (double)counters.gpioCalls() / iterations;
+        result.bytesPerOp = (double)(counters.stripBytes + counters.spiBytes) / iterations;
+        result.showsPerOp = (double)counters.stripShows / iterations;
+        result.simUsPerOp = (double)(HostSim::nowNs() - simStart) / 1000.0 / iterations;
+        _results.push_back(std::move(result));
+    }
+
+    /**
+     * @brief Sets the suite that subsequent runs are reported under.
+     */
+    void setSuite(const std::string& suite) { _suite = suite; }
+
+    /**
+     * @brief Restricts runs to those whose "suite/name" contains `filter`.
+     */
+    void setFilter(const std::string& filter) { _filter = filter; }
+
+    /**
+     * @brief Sets the minimum wall-clock time of each timed loop.
+     */
+    void setMinTimeNs(double minTimeNs) { _minTimeNs = minTimeNs; }
+
+    /**
+     * @brief Gets all results collected so far.
+     */
+    const std::vector<BenchmarkResult>& results() const { return _results; }
+
+private:
+    std::string _suite;                     ///< Suite of the runs currently being added.
+    std::string _filter;                    ///< Only runs matching this filter are measured.
+    double _minTimeNs = 20e6;               ///< Minimum duration of each timed loop.
+    uint64_t _maxIterations = 1000000;      ///< Upper bound on iterations per run.
+    std::vector<BenchmarkResult> _results;  ///< Results in the order they were measured.
+};
+
+/**
+ * @brief Signature of a benchmark suite.
+ */
+typedef void (*BenchmarkSuite)(BenchmarkRunner& runner);
+
+/**
+ * @brief Adds a suite to the global list. Used by LED_BENCHMARK_SUITE.
+ */
+struct BenchmarkRegistration {
+    BenchmarkRegistration(const char* name, BenchmarkSuite suite);
+};
+
+/**
+ * @brief Defines and registers a benchmark suite.
+ * @param name The identifier of the suite, also used as its reported name.
+ */
+#define LED_BENCHMARK_SUITE(name)                                               \
+    static void name(BenchmarkRunner& runner);                                  \
+    static BenchmarkRegistration name##Registration(#name, name);               \
+    static void name(BenchmarkRunner& runner)
+
+#endif // XDUINORAILS_BENCHMARK_H
@@ -0,0 +1,99 @@
+/**
+ * @file BenchmarkMain.cpp
+ * @brief Entry point of the host benchmarks.
+ *
+ * Runs all registered suites and writes the results as JSON, either to standard
+ * output or to the file given with `--output`. A short human-readable summary is
+ * written to standard error.
+ *
+ * Usage: led_benchmarks [--filter <text>] [--output <file>] [--min-time-ms <ms>]
+ */
+#include "Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+struct Suite {
+    const char* name;
+    BenchmarkSuite run;
+};
+
+std::vector<Suite>& suites() {
+    static std::vector<Suite> list;
+    return list;
+}
+
+void writeJson(FILE* out, const std::vector<BenchmarkResult>& results) {
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        fprintf(out, "    {\"suite\": \"%s\", \"name\": \"%s\", \"params\": {", r.suite.c_str(), r.name.c_str());
+        for (size_t p = 0; p < r.params.size(); p++) {
+            fprintf(out, "%s\"%s\": %ld", p ? ", " : "", r.params[p].first.c_str(), r.params[p].second);
+        }
+        fprintf(out, "}, \"iterations\": %llu, \"ns_per_op\": %.1f, \"gpio_calls_per_op\": %.2f, "
+                     "\"bytes_per_op\": %.2f, \"shows_per_op\": %.3f, \"sim_us_per_op\": %.2f}%s\n",
+                (unsigned long long)r.iterations, r.nsPerOp, r.gpioCallsPerOp, r.bytesPerOp, r.showsPerOp,
+                r.simUsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+void writeSummary(FILE* out, const std::vector<BenchmarkResult>& results) {
+    fprintf(out, "%-44s %12s %10s %10s %12s\n", "benchmark", "ns/op", "gpio/op", "bytes/op", "sim us/op");
+    for (const BenchmarkResult& r : results) {
+        std::string label = r.suite + "/" + r.name;
+        for (const auto& param : r.params) {
+            label += " " + param.first + "=" + std::to_string(param.second);
+        }
+        fprintf(out, "%-44s %12.1f %10.1f %10.1f %12.1f\n", label.c_str(), r.nsPerOp, r.gpioCallsPerOp, r.bytesPerOp, r.simUsPerOp);
+    }
+}
+
+} // namespace
+
+BenchmarkRegistration::BenchmarkRegistration(const char* name, BenchmarkSuite suite) {
+    suites().push_back({name, suite});
+}
+
+int main(int argc, char** argv) {
+    BenchmarkRunner runner;
+    const char* outputPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            runner.setFilter(argv[++i]);
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            runner.setMinTimeNs(atof(argv[++i]) * 1e6);
+        } else {
+            fprintf(stderr, "Usage: %s [--filter <text>] [--output <file>] [--min-time-ms <ms>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (const Suite& suite : suites()) {
+        HostSim::reset();
+        runner.setSuite(suite.name);
+        suite.run(runner);
+    }
+
+    FILE* out = stdout;
+    if (outputPath) {
+        out = fopen(outputPath, "w");
+        if (!out) {
+            perror(outputPath);
+            return 1;
+        }
+    }
+    writeJson(out, runner.results());
+    if (out != stdout) {
+        fclose(out);
+    }
+    writeSummary(stderr, runner.results());
+    return 0;
+}
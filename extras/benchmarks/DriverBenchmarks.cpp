@@ -0,0 +1,874 @@
+/**
+ * @file DriverBenchmarks.cpp
+ * @brief Benchmarks of the driver hot paths.
+ *
+ * Each operation corresponds to one visible update: one strip transmission, one
+ * full matrix or charlieplex scan, one RGB color change, or one group change.
+ */
+#include "Benchmark.h"
+
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <ArduinoLedDriverHAL.h>
+#include <HostPovRefresh.h>
+#include <HostStripTransport.h>
+#include <LedEffects.h>
+#include <LedHAL_Max7219.h>
+#include <LedHAL_ShiftMatrix.h>
+#include <PovRefresh.h>
+#include <StripTransport_Spi.h>
+
+namespace {
+
+/**
+ * @brief Alternates between two colors so that every operation changes the output.
+ */
+RgbColor alternatingColor(uint32_t step) {
+    return (step & 1) ? RgbColor{200, 100, 50} : RgbColor{50, 100, 200};
+}
+
+// The targets have no SIMD unit, so the per-channel baselines are kept scalar
+// instead of letting the host compiler vectorize them.
+#if defined(__GNUC__) && !defined(__clang__)
+#define LED_BENCHMARK_SCALAR __attribute__((optimize("no-tree-vectorize")))
+#else
+#define LED_BENCHMARK_SCALAR
+#endif
+
+/**
+ * @brief Scales a buffer with Arduino's map(), as the PWM drivers did before ColorMath.
+ */
+LED_BENCHMARK_SCALAR void mapScale(uint8_t* data, size_t length, uint8_t scale) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)map(data[i], 0, 255, 0, scale);
+    }
+}
+
+/**
+ * @brief Scales a buffer one channel at a time.
+ */
+LED_BENCHMARK_SCALAR void scalarScale(uint8_t* data, size_t length, uint8_t scale) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = ColorMath::scale8(data[i], scale);
+    }
+}
+
+/**
+ * @brief Adds two buffers one channel at a time.
+ */
+LED_BENCHMARK_SCALAR void scalarAdd(uint8_t* data, const uint8_t* other, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = ColorMath::qadd8(data[i], other[i]);
+    }
+}
+
+/**
+ * @brief Blends two buffers one channel at a time.
+ */
+LED_BENCHMARK_SCALAR void scalarBlend(uint8_t* data, const uint8_t* other, size_t length, uint8_t amount) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = ColorMath::blend8(data[i], other[i], amount);
+    }
+}
+
+/**
+ * @brief Checks the word-wide kernels against the per-channel ones; exits on a mismatch.
+ */
+void verifyColorMath() {
+    for (uint32_t a = 0; a < 256; a++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t wordA = a * 0x01010101u ^ 0x00FF5A00u;
+            uint32_t wordB = b * 0x01010101u ^ 0x5A00FF00u;
+            uint32_t scaled = ColorMath::scale8x4(wordA, (uint8_t)b);
+            uint32_t sum = ColorMath::qadd8x4(wordA, wordB);
+            uint32_t blended = ColorMath::blend8x4(wordA, wordB, (uint8_t)a);
+            for (uint8_t shift = 0; shift < 32; shift += 8) {
+                uint8_t x = (uint8_t)(wordA >> shift);
+                uint8_t y = (uint8_t)(wordB >> shift);
+                if ((uint8_t)(scaled >> shift) != ColorMath::scale8(x, (uint8_t)b) ||
+                    (uint8_t)(sum >> shift) != ColorMath::qadd8(x, y) ||
+                    (uint8_t)(blended >> shift) != ColorMath::blend8(x, y, (uint8_t)a)) {
+                    fprintf(stderr, "color_math: word kernels differ from the channel kernels for %u, %u\n",
+                            (unsigned)a, (unsigned)b);
+                    exit(1);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Transposes eight lane bytes into bit planes one bit at a time.
+ */
+LED_BENCHMARK_SCALAR void transposeBitsReference(const uint8_t* laneBytes, uint8_t* planes) {
+    for (uint8_t plane = 0; plane < 8; plane++) {
+        uint8_t value = 0;
+        for (uint8_t lane = 0; lane < LedParallelStrip::kMaxLanes; lane++) {
+            value |= (uint8_t)(((laneBytes[lane] >> (7 - plane)) & 1) << lane);
+        }
+        planes[plane] = value;
+    }
+}
+
+/**
+ * @brief Checks the block-swap transpose against the bit-by-bit one; exits on a mismatch.
+ */
+void verifyTransposeBits() {
+    srand(8);
+    for (uint32_t test = 0; test < 4096; test++) {
+        uint8_t laneBytes[LedParallelStrip::kMaxLanes];
+        for (uint8_t lane = 0; lane < LedParallelStrip::kMaxLanes; lane++) {
+            // A single set bit for the first tests, random bytes for the rest.
+            laneBytes[lane] = test < 64 ? (uint8_t)(test / 8 == lane ? 0x80 >> (test % 8) : 0) : (uint8_t)rand();
+        }
+        uint8_t planes[8];
+        uint8_t reference[8];
+        LedParallelStrip::transposeBits(laneBytes, planes);
+        transposeBitsReference(laneBytes, reference);
+        if (memcmp(planes, reference, sizeof(planes)) != 0) {
+            fprintf(stderr, "parallel: transposeBits differs from the reference for test %u\n", (unsigned)test);
+            exit(1);
+        }
+    }
+}
+
+/**
+ * @brief Level of one LED of the test pattern of the shift chain checks.
+ */
+uint8_t chainTestLevel(uint8_t row, uint8_t col) {
+    return (row * 7 + col * 3) % 5 == 0 ? 255 : 0;
+}
+
+/**
+ * @brief Scans a LedShiftMatrix into a simulated 74HC595 chain and checks every latched
+ * word against the documented wiring; exits on a mismatch.
+ *
+ * The chain runs MOSI → column registers → row registers, so the last byte shifted in
+ * is column register 0, with column `c` on output `Q(c % 8)` of register `c / 8`.
+ */
+void verifyShiftMatrixChain(bool rowActiveHigh, bool columnActiveHigh) {
+    const uint8_t latchPin = 10;
+    const uint8_t rows = 12;
+    const uint8_t cols = 20;
+    const size_t rowBytes = (rows + 7) / 8;
+    const size_t colBytes = (cols + 7) / 8;
+    HostSim::reset();
+    HostSim::attachShiftChain(latchPin, rowBytes + colBytes);
+    HostSim::setRecording(true);
+    LedShiftMatrix panel(latchPin, rows, cols);
+    panel.setBitAngleModulation(1);
+    panel.setActiveLevels(rowActiveHigh, columnActiveHigh);
+    panel.begin();
+    for (uint8_t r = 0; r < rows; r++) {
+        for (uint8_t c = 0; c < cols; c++) {
+            uint8_t level = chainTestLevel(r, c);
+            panel.setColor(c, r, {level, level, level});
+        }
+    }
+    for (uint8_t r = 0; r < rows; r++) {
+        panel.show();
+    }
+    std::vector<bool> scanned(rows, false);
+    for (const HostSim::LatchedWord& word : HostSim::latchedWords()) {
+        const uint8_t* columnRegs = word.data.data() + word.data.size() - 1;
+        const uint8_t* rowRegs = columnRegs - colBytes;
+        int active = -1;
+        for (uint8_t r = 0; r < rows; r++) {
+            bool high = (rowRegs[-(r >> 3)] >> (r & 7)) & 1;
+            if (high == rowActiveHigh) {
+                if (active >= 0) {
+                    fprintf(stderr, "shift_matrix: rows %d and %u are active in one word\n", active, r);
+                    exit(1);
+                }
+                active = r;
+            }
+        }
+        for (uint8_t c = 0; c < cols; c++) {
+            bool lit = ((columnRegs[-(c >> 3)] >> (c & 7)) & 1) == columnActiveHigh;
+            bool expected = active >= 0 && chainTestLevel((uint8_t)active, c);
+            if (lit != expected) {
+                fprintf(stderr, "shift_matrix: column %u of row %d is %s in the latched word\n", c, active, lit ? "lit" : "dark");
+                exit(1);
+            }
+        }
+        if (active >= 0) {
+            scanned[active] = true;
+        }
+    }
+    for (uint8_t r = 0; r < rows; r++) {
+        if (!scanned[r]) {
+            fprintf(stderr, "shift_matrix: row %u was never latched\n", r);
+            exit(1);
+        }
+    }
+    HostSim::setRecording(false);
+    HostSim::attachShiftChain(latchPin, 0);
+    HostSim::reset();
+}
+
+/**
+ * @brief Replays the words a LedMax7219Matrix latches into a simulated MAX7219 chain
+ * and checks the digit registers against the buffer; exits on a mismatch.
+ *
+ * Module 0 is nearest to MOSI, so its register and data byte are the last two bytes
+ * shifted in. Row `r` of a module is digit register `r + 1`, column `c` data bit `7 - c`.
+ */
+void verifyMax7219Chain() {
+    const uint8_t loadPin = 11;
+    const uint8_t rows = 16;
+    const uint8_t cols = 24;
+    const uint8_t modCols = (cols + 7) / 8;
+    const uint8_t chips = ((rows + 7) / 8) * modCols;
+    HostSim::reset();
+    HostSim::attachShiftChain(loadPin, (size_t)chips * 2);
+    HostSim::setRecording(true);
+    LedMax7219Matrix controllers(loadPin, rows, cols);
+    controllers.begin();
+    for (uint8_t r = 0; r < rows; r++) {
+        for (uint8_t c = 0; c < cols; c++) {
+            uint8_t level = chainTestLevel(r, c);
+            controllers.setColor(c, r, {level, level, level});
+        }
+    }
+    controllers.show();
+    // A second frame that only changes some digit rows.
+    controllers.setColor(0, 0, {255, 255, 255});
+    controllers.setColor(cols - 1, rows - 1, {0, 0, 0});
+    controllers.show();
+    std::vector<uint8_t> digits((size_t)chips * 8, 0);
+    for (const HostSim::LatchedWord& word : HostSim::latchedWords()) {
+        for (uint8_t chip = 0; chip < chips; chip++) {
+            const uint8_t* command = word.data.data() + word.data.size() - 2 - chip * 2;
+            if (command[0] != word.data[0]) {
+                fprintf(stderr, "max7219: chips %u and %u get different registers in one word\n", 0, chip);
+                exit(1);
+            }
+            if (command[0] >= 0x01 && command[0] <= 0x08) {
+                digits[chip * 8 + command[0] - 1] = command[1];
+            }
+        }
+    }
+    for (uint8_t chip = 0; chip < chips; chip++) {
+        for (uint8_t digit = 0; digit < 8; digit++) {
+            for (uint8_t c = 0; c < 8; c++) {
+                uint8_t row = (uint8_t)((chip / modCols) * 8 + digit);
+                uint8_t col = (uint8_t)((chip % modCols) * 8 + c);
+                bool lit = (digits[chip * 8 + digit] & (0x80 >> c)) != 0;
+                bool expected = controllers.getPixelColor((uint16_t)row * cols + col).r >= 128;
+                if (lit != expected) {
+                    fprintf(stderr, "max7219: LED %u of digit %u of chip %u is %s\n", c, digit, chip, lit ? "lit" : "dark");
+                    exit(1);
+                }
+            }
+        }
+    }
+    HostSim::setRecording(false);
+    HostSim::attachShiftChain(loadPin, 0);
+    HostSim::reset();
+}
+
+/**
+ * @brief Waits until a threaded refresh has completed `frames` more frames; exits if it stalls.
+ */
+void waitForFrames(HostPovRefresh& refresh, uint32_t frames) {
+    uint32_t target = refresh.getStats().frames + frames;
+    for (uint32_t ms = 0; refresh.getStats().frames < target; ms++) {
+        if (ms == 2000) {
+            fprintf(stderr, "pov_refresh: the worker thread stopped scanning\n");
+            exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/**
+ * @brief Commits frames and changes scan settings from this thread while a HostPovRefresh
+ * scans from its worker thread; exits if the scan stalls or leaves a pin driven.
+ *
+ * Build with `-fsanitize=thread` to check the frame and settings handover for data races.
+ */
+void verifyThreadedRefresh() {
+    HostSim::reset();
+    uint8_t pins[6] = {0, 1, 2, 3, 4, 5};
+    LedCharliePlex charlie(pins, 6);
+    uint8_t rowPins[4] = {10, 11, 12, 13};
+    uint8_t colPins[4] = {14, 15, 16, 17};
+    LedMatrix matrix(rowPins, 4, colPins, 4);
+    const uint8_t latchPin = 20;
+    HostSim::attachShiftChain(latchPin, 2);
+    LedShiftMatrix panel(latchPin, 4, 8);
+    panel.begin();
+    HostPovRefresh refresh(500);
+    refresh.add(charlie);
+    refresh.add(matrix);
+    refresh.add(panel);
+    refresh.begin();
+    for (uint32_t i = 0; i < 100; i++) {
+        // All changes come before the first commit, which would order them after the scan.
+        charlie.fill(0, charlie.numPixels(), alternatingColor(i));
+        charlie.setBrightness((uint8_t)(64 + i));
+        charlie.setScanMode((i & 1) ? LedCharliePlex::SCAN_ROW : LedCharliePlex::SCAN_LED);
+        charlie.setMaxLedsPerStep((uint8_t)(i % 4));
+        matrix.fill(0, matrix.numPixels(), alternatingColor(i));
+        matrix.setBrightness((uint8_t)(64 + i));
+        matrix.setBitAngleModulation((uint8_t)(i % 9));
+        panel.fill(0, panel.numPixels(), alternatingColor(i));
+        panel.setBitAngleModulation((uint8_t)(1 + i % 8));
+        panel.setActiveLevels((i & 2) != 0, (i & 4) == 0);
+        charlie.show();
+        matrix.show();
+        panel.show();
+        std::this_thread::sleep_for(std::chrono::microseconds(300));
+    }
+    // The blanking word after end() shows the active levels of the last frame.
+    panel.setActiveLevels(true, false);
+    panel.show();
+    waitForFrames(refresh, 2);
+    refresh.end();
+    for (uint8_t pin : pins) {
+        if (HostSim::getPinMode(pin) != INPUT) {
+            fprintf(stderr, "pov_refresh: charlieplex pin %u is still driven after end()\n", pin);
+            exit(1);
+        }
+    }
+    for (uint8_t pin : rowPins) {
+        if (HostSim::getPinValue(pin) != HIGH) {
+            fprintf(stderr, "pov_refresh: matrix row pin %u is still active after end()\n", pin);
+            exit(1);
+        }
+    }
+    const std::vector<uint8_t>& chain = HostSim::shiftChainOutputs();
+    if (chain[0] != 0x00 || chain[1] != 0xFF) {
+        fprintf(stderr, "pov_refresh: shift matrix blanked with rows %02x and columns %02x after end()\n", chain[0], chain[1]);
+        exit(1);
+    }
+    refresh.remove(panel);
+    refresh.remove(matrix);
+    refresh.remove(charlie);
+    HostSim::attachShiftChain(latchPin, 0);
+    HostSim::reset();
+}
+
+} // namespace
+
+LED_BENCHMARK_SUITE(neopixel) {
+    static const uint16_t lengths[] = {10, 50, 100, 300, 600, 1000, 2000};
+    for (uint16_t length : lengths) {
+        LedNeoPixel strip(6, length);
+        uint32_t step = 0;
+        runner.run("show", {{"pixels", length}}, [&]() {
+            strip.setPixelColor(0, alternatingColor(step++));
+            strip.show();
+        });
+        runner.run("set_color", {{"pixels", length}}, [&]() {
+            strip.setColor(alternatingColor(step++));
+        });
+        // Global dimming changed every frame without touching the pixel data.
+        runner.run("set_brightness", {{"pixels", length}}, [&]() {
+            strip.setBrightness((uint8_t)(128 + (step++ & 1)));
+        });
+        // Static scenery: show() is called every loop iteration without any change.
+        runner.run("show_unchanged", {{"pixels", length}}, [&]() {
+            strip.show();
+        });
+        // One signal near the start of the chain changes, with and without truncation.
+        for (int truncated = 0; truncated <= 1; truncated++) {
+            strip.setTruncatedShow(truncated != 0);
+            runner.run("show_near_start", {{"pixels", length}, {"truncated", truncated}}, [&]() {
+                strip.setPixelColor(length < 20 ? length - 1 : 20, alternatingColor(step++));
+                strip.show();
+            });
+        }
+        strip.setTruncatedShow(false);
+        // The full strip re-rendered through gamma and color temperature tables.
+        ColorCorrection correction(&ColorCorrection::standardGamma(), 255, ColorTemperature::Tungsten100W);
+        strip.setColorCorrection(&correction);
+        runner.run("show_corrected", {{"pixels", length}}, [&]() {
+            strip.setColor(alternatingColor(step++));
+            strip.show();
+        });
+        // Four LED batches, each with its own calibration folded into the tables.
+        ColorCorrection batches[4] = {{correction, {255, 255, 255}}, {correction, {255, 230, 210}},
+                                      {correction, {240, 255, 255}}, {correction, {255, 245, 200}}};
+        uint16_t quarter = length / 4;
+        LedSegmentCorrection segments[4] = {{0, quarter, &batches[0]}, {quarter, quarter, &batches[1]},
+                                            {(uint16_t)(2 * quarter), quarter, &batches[2]},
+                                            {(uint16_t)(3 * quarter), (uint16_t)(length - 3 * quarter), &batches[3]}};
+        strip.setSegmentCorrections(segments, 4);
+        runner.run("show_calibrated", {{"pixels", length}}, [&]() {
+            strip.setColor(alternatingColor(step++));
+            strip.show();
+        });
+        strip.setSegmentCorrections(nullptr, 0);
+        strip.setColorCorrection(nullptr);
+        runner.run("show_uncorrected", {{"pixels", length}}, [&]() {
+            strip.setColor(alternatingColor(step++));
+            strip.show();
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(neopixel_async) {
+    // show() through a background transport; the caller's simulated time stays free.
+    static const uint16_t lengths[] = {50, 300, 1000};
+    for (uint16_t length : lengths) {
+        HostStripTransport transport(6, 0.0);
+        LedNeoPixel strip(6, length);
+        strip.setTransport(&transport);
+        uint32_t step = 0;
+        runner.run("show", {{"pixels", length}}, [&]() {
+            strip.setPixelColor(0, alternatingColor(step++));
+            strip.show();
+        });
+        strip.setTransport(nullptr);
+    }
+}
+
+LED_BENCHMARK_SUITE(neopixel_dithered) {
+    // A static, dimmed night scene: every show() dithers and re-sends the whole strip.
+    static const uint16_t lengths[] = {50, 300, 600};
+    for (uint16_t length : lengths) {
+        LedNeoPixelDithered strip(6, length);
+        strip.setBrightness(24);
+        for (uint16_t i = 0; i < length; i++) {
+            strip.setPixelColor16(i, {(uint16_t)(i * 37), (uint16_t)(i * 11), 0x0180});
+        }
+        runner.run("show_static", {{"pixels", length}}, [&]() {
+            strip.show();
+        });
+        uint32_t step = 0;
+        runner.run("show", {{"pixels", length}}, [&]() {
+            strip.setPixelColor(0, alternatingColor(step++));
+            strip.show();
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(spi_encode) {
+    // Expanding strip data into SPI symbols: nibble table versus bit-by-bit reference.
+    static const uint16_t lengths[] = {50, 300, 1000};
+    for (uint16_t length : lengths) {
+        size_t bytes = (size_t)length * 3;
+        std::vector<uint8_t> data(bytes);
+        std::vector<uint8_t> encoded(Ws2812SpiEncoder::encodedSize(bytes));
+        std::vector<uint8_t> reference(encoded.size());
+        srand(length);
+        for (uint8_t& byte : data) {
+            byte = (uint8_t)rand();
+        }
+        Ws2812SpiEncoder::encode(data.data(), bytes, encoded.data());
+        Ws2812SpiEncoder::encodeReference(data.data(), bytes, reference.data());
+        if (memcmp(encoded.data(), reference.data(), encoded.size()) != 0) {
+            fprintf(stderr, "spi_encode: table output differs from the reference for %u pixels\n", length);
+            exit(1);
+        }
+        // Called through volatile pointers so that the compiler cannot hoist work out of the timed loop.
+        typedef void (*Encoder)(const uint8_t*, size_t, uint8_t*);
+        Encoder volatile lut = &Ws2812SpiEncoder::encode;
+        Encoder volatile bitwise = &Ws2812SpiEncoder::encodeReference;
+        uint32_t step = 0;
+        runner.run("lut", {{"pixels", length}}, [&]() {
+            data[0] = (uint8_t)step++;
+            lut(data.data(), bytes, encoded.data());
+        });
+        runner.run("reference", {{"pixels", length}}, [&]() {
+            data[0] = (uint8_t)step++;
+            bitwise(data.data(), bytes, reference.data());
+        });
+        // Full show() through the SPI transport; the virtual time is the SPI transfer.
+        SpiStripTransport transport(bytes);
+        transport.begin();
+        LedNeoPixel strip(6, length);
+        strip.setTransport(&transport);
+        runner.run("show", {{"pixels", length}}, [&]() {
+            strip.setPixelColor(0, alternatingColor(step++));
+            strip.show();
+        });
+        strip.setTransport(nullptr);
+    }
+}
+
+LED_BENCHMARK_SUITE(parallel) {
+    // One changed pixel per lane: lane by lane through the Adafruit library, versus
+    // encoding bit planes for a parallel transport (wire time per frame: one lane).
+    static const uint8_t pins[] = {6, 7, 8, 9, 10, 11, 12, 13};
+    static const uint8_t laneCounts[] = {2, 4, 8};
+    const uint16_t length = 300;
+    verifyTransposeBits();
+    // One pixel position of all lanes (24 planes): block swaps versus bit-by-bit reference.
+    typedef void (*Transposer)(const uint8_t*, uint8_t*);
+    Transposer volatile swaps = &LedParallelStrip::transposeBits;
+    Transposer volatile bitwise = &transposeBitsReference;
+    uint8_t laneBytes[3][LedParallelStrip::kMaxLanes] = {{0}};
+    uint8_t planes[24];
+    uint32_t transposeStep = 0;
+    runner.run("transpose", {{"lanes", (int)LedParallelStrip::kMaxLanes}}, [&]() {
+        laneBytes[0][0] = (uint8_t)transposeStep++;
+        for (uint8_t channel = 0; channel < 3; channel++) {
+            swaps(laneBytes[channel], planes + channel * 8);
+        }
+    });
+    runner.run("transpose_reference", {{"lanes", (int)LedParallelStrip::kMaxLanes}}, [&]() {
+        laneBytes[0][0] = (uint8_t)transposeStep++;
+        for (uint8_t channel = 0; channel < 3; channel++) {
+            bitwise(laneBytes[channel], planes + channel * 8);
+        }
+    });
+    for (uint8_t lanes : laneCounts) {
+        LedParallelStrip strip(pins, lanes, length);
+        uint32_t step = 0;
+        runner.run("show_sequential", {{"lanes", lanes}, {"pixels", length}}, [&]() {
+            RgbColor color = alternatingColor(step++);
+            for (uint8_t lane = 0; lane < lanes; lane++) {
+                strip.setPixelColor(lane * length, color);
+            }
+            strip.show();
+        });
+        HostStripTransport transport(pins[0], 0.0, lanes);
+        strip.setTransport(&transport);
+        runner.run("show_parallel", {{"lanes", lanes}, {"pixels", length}}, [&]() {
+            RgbColor color = alternatingColor(step++);
+            for (uint8_t lane = 0; lane < lanes; lane++) {
+                strip.setPixelColor(lane * length, color);
+            }
+            strip.show();
+        });
+        strip.setTransport(nullptr);
+    }
+}
+
+LED_BENCHMARK_SUITE(strip_write) {
+    // Writing a full frame through the LedStrip interface, without transmitting it.
+    static const uint16_t lengths[] = {50, 300, 1000};
+    for (uint16_t length : lengths) {
+        LedNeoPixel neoPixel(6, length);
+        LedStrip& strip = neoPixel;
+        std::vector<RgbColor> frame(length);
+        uint32_t step = 0;
+        runner.run("set_pixel_color", {{"pixels", length}}, [&]() {
+            RgbColor color = alternatingColor(step++);
+            for (uint16_t i = 0; i < length; i++) {
+                strip.setPixelColor(i, color);
+            }
+        });
+        runner.run("set_pixels", {{"pixels", length}}, [&]() {
+            RgbColor color = alternatingColor(step++);
+            for (uint16_t i = 0; i < length; i++) {
+                frame[i] = color;
+            }
+            strip.setPixels(0, frame.data(), length);
+        });
+        runner.run("fill", {{"pixels", length}}, [&]() {
+            strip.fill(0, length, alternatingColor(step++));
+        });
+        runner.run("pixel_span", {{"pixels", length}}, [&]() {
+            RgbColor color = alternatingColor(step++);
+            for (RgbColor& pixel : strip.getPixelSpan()) {
+                pixel = color;
+            }
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(group) {
+    // 256 single LEDs spread evenly over a varying number of groups.
+    static const uint16_t totalLeds = 256;
+    static const uint16_t groupCounts[] = {1, 4, 16, 64, 256};
+    for (uint16_t groups : groupCounts) {
+        ArduinoLedDriverHAL hal;
+        for (uint16_t i = 0; i < totalLeds; i++) {
+            uint8_t pin = (uint8_t)(i % 200);
+            hal.addLeds(SINGLE_LED, &pin, 1, 0, (uint8_t)(i % groups));
+        }
+        uint32_t step = 0;
+        runner.run("set_group_color", {{"leds", totalLeds}, {"groups", groups}}, [&]() {
+            hal.setGroupColor(0, alternatingColor(step++));
+        });
+    }
+
+    // A group of NeoPixel strips, changed inside and outside of a frame transaction.
+    static const uint16_t stripCounts[] = {1, 4, 8};
+    for (uint16_t strips : stripCounts) {
+        ArduinoLedDriverHAL hal;
+        for (uint16_t i = 0; i < strips; i++) {
+            uint8_t pin = (uint8_t)i;
+            hal.addLeds(NEOPIXEL, &pin, 1, 300, 1);
+        }
+        uint32_t step = 0;
+        runner.run("strip_group_color_and_brightness", {{"strips", strips}, {"pixels", 300}, {"frame", 0}}, [&]() {
+            hal.setGroupColor(1, alternatingColor(step++));
+            hal.setGroupBrightness(1, (uint8_t)(128 + (step & 1)));
+        });
+        runner.run("strip_group_color_and_brightness", {{"strips", strips}, {"pixels", 300}, {"frame", 1}}, [&]() {
+            hal.beginFrame();
+            hal.setGroupColor(1, alternatingColor(step++));
+            hal.setGroupBrightness(1, (uint8_t)(128 + (step & 1)));
+            hal.commitFrame();
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(matrix) {
+    static const uint8_t sizes[] = {4, 8, 12, 16};
+    for (uint8_t size : sizes) {
+        uint8_t rowPins[16];
+        uint8_t colPins[16];
+        for (uint8_t i = 0; i < size; i++) {
+            rowPins[i] = i;
+            colPins[i] = 16 + i;
+        }
+        LedMatrix matrix(rowPins, size, colPins, size);
+        for (uint16_t i = 0; i < size * size; i++) {
+            matrix.setPixelColor(i, {(uint8_t)i, (uint8_t)i, (uint8_t)i});
+        }
+        // One operation is a full frame, i.e. one scan step per row.
+        runner.run("show_frame", {{"rows", size}, {"cols", size}}, [&]() {
+            for (uint8_t r = 0; r < size; r++) {
+                matrix.show();
+            }
+        });
+        static const uint8_t depths[] = {4, 8};
+        for (uint8_t bits : depths) {
+            matrix.setBitAngleModulation(bits);
+            runner.run("show_frame_bam", {{"rows", size}, {"cols", size}, {"bits", bits}}, [&]() {
+                for (uint8_t r = 0; r < size; r++) {
+                    matrix.show();
+                }
+            });
+        }
+        matrix.setBitAngleModulation(0);
+    }
+}
+
+LED_BENCHMARK_SUITE(charlieplex) {
+    for (uint8_t pinCount = 3; pinCount <= 12; pinCount++) {
+        uint8_t pins[12];
+        for (uint8_t i = 0; i < pinCount; i++) {
+            pins[i] = i;
+        }
+        LedCharliePlex charlie(pins, pinCount);
+        charlie.setColor({255, 255, 255});
+        runner.run("show_frame", {{"pins", pinCount}, {"leds", pinCount * (pinCount - 1)}}, [&]() {
+            charlie.show();
+        });
+        charlie.setScanMode(LedCharliePlex::SCAN_ROW);
+        runner.run("show_frame_rows", {{"pins", pinCount}, {"leds", pinCount * (pinCount - 1)}}, [&]() {
+            charlie.show();
+        });
+        charlie.setMaxLedsPerStep(4);
+        runner.run("show_frame_rows_limited", {{"pins", pinCount}, {"leds", pinCount * (pinCount - 1)}, {"max", 4}},
+                   [&]() {
+            charlie.show();
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(pov_refresh) {
+    verifyThreadedRefresh();
+    // One call of the background scan, stepping the virtual time from event to event.
+    uint8_t rowPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+    uint8_t colPins[8] = {10, 11, 12, 13, 14, 15, 16, 17};
+    LedMatrix matrix(rowPins, 8, colPins, 8);
+    matrix.on();
+    uint8_t pins[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    LedCharliePlex charlie(pins, 12);
+    charlie.setColor({255, 255, 255});
+    charlie.setBrightness(128);
+
+    struct Target {
+        const char* name;
+        PovScanner& scanner;
+        LedStrip& strip;
+    };
+    Target targets[] = {{"matrix_8x8", matrix, matrix}, {"charlieplex_12", charlie, charlie}};
+    for (Target& target : targets) {
+        for (uint8_t rows = 0; rows < 2; rows++) {
+            if (&target.scanner == &matrix && rows) {
+                continue;
+            }
+            charlie.setScanMode(rows ? LedCharliePlex::SCAN_ROW : LedCharliePlex::SCAN_LED);
+            PovRefresh refresh(200);
+            refresh.add(target.scanner);
+            uint32_t now = 0;
+            uint32_t wait = refresh.service(now);
+            std::string name = std::string(target.name) + (rows ? "_rows" : "");
+            runner.run("service/" + name, {{"steps", target.scanner.scanStepCount()}}, [&]() {
+                now += wait;
+                wait = refresh.service(now);
+            });
+            runner.run("commit/" + name, {{"bytes", (long)target.scanner.scanFrameBytes()}}, [&]() {
+                target.strip.show();
+            });
+            refresh.remove(target.scanner);
+        }
+    }
+}
+
+LED_BENCHMARK_SUITE(shift_matrix) {
+    // 16x32 panels behind 74HC595 or MAX7219 chains, from MOSI, SCK and one latch pin.
+    verifyShiftMatrixChain(false, true);
+    verifyShiftMatrixChain(true, false);
+    verifyMax7219Chain();
+    LedShiftMatrix panel(10, 16, 32);
+    panel.begin();
+    for (uint16_t i = 0; i < panel.numPixels(); i++) {
+        panel.setPixelColor(i, {(uint8_t)i, (uint8_t)i, (uint8_t)i});
+    }
+    static const uint8_t depths[] = {1, 4, 8};
+    for (uint8_t bits : depths) {
+        panel.setBitAngleModulation(bits, 4);
+        // One operation is a full frame, i.e. one scan step per row.
+        runner.run("show_frame", {{"rows", 16}, {"cols", 32}, {"bits", bits}}, [&]() {
+            for (uint8_t r = 0; r < 16; r++) {
+                panel.show();
+            }
+        });
+        PovRefresh refresh(100);
+        refresh.add(panel);
+        uint32_t now = 0;
+        uint32_t wait = refresh.service(now);
+        runner.run("service", {{"rows", 16}, {"cols", 32}, {"bits", bits}, {"steps", panel.scanStepCount()}}, [&]() {
+            now += wait;
+            wait = refresh.service(now);
+        });
+        refresh.remove(panel);
+    }
+
+    LedMax7219Matrix controllers(11, 16, 32);
+    controllers.begin();
+    uint32_t frame = 0;
+    // The chips only show on/off levels, so the frames alternate between all on and all off.
+    runner.run("max7219_show", {{"rows", 16}, {"cols", 32}}, [&]() {
+        controllers.fill(0, controllers.numPixels(), (frame++ & 1) ? RgbColor{255, 255, 255} : RgbColor{0, 0, 0});
+        controllers.show();
+    });
+    runner.run("max7219_show_pixel", {{"rows", 16}, {"cols", 32}}, [&]() {
+        uint16_t pixel = frame++ % controllers.numPixels();
+        controllers.setPixelColor(pixel, (frame / controllers.numPixels()) & 1 ? RgbColor{0, 0, 0} : RgbColor{255, 255, 255});
+        controllers.show();
+    });
+}
+
+LED_BENCHMARK_SUITE(rgb) {
+    LedRgb led(9, 10, 11);
+    led.setBrightness(200);
+    uint32_t step = 0;
+    runner.run("set_color", {}, [&]() {
+        led.setColor(alternatingColor(step++));
+    });
+    runner.run("set_brightness", {}, [&]() {
+        led.setBrightness((uint8_t)(step++));
+    });
+    runner.run("set_color_unchanged", {}, [&]() {
+        led.setColor({200, 100, 50});
+    });
+    ColorCorrection correction;
+    led.setColorCorrection(&correction);
+    runner.run("set_color_corrected", {}, [&]() {
+        led.setColor(alternatingColor(step++));
+    });
+    led.setColorCorrection(nullptr);
+}
+
+LED_BENCHMARK_SUITE(color_math) {
+    // Buffer kernels four channels per word, versus one channel at a time and versus map().
+    verifyColorMath();
+    static const uint16_t lengths[] = {50, 300, 1000};
+    for (uint16_t length : lengths) {
+        size_t bytes = (size_t)length * 3;
+        std::vector<uint8_t> data(bytes);
+        std::vector<uint8_t> other(bytes);
+        srand(length);
+        for (size_t i = 0; i < bytes; i++) {
+            data[i] = (uint8_t)rand();
+            other[i] = (uint8_t)rand();
+        }
+        // Called through volatile pointers so that the compiler cannot hoist work out of the timed loop.
+        typedef void (*Scale)(uint8_t*, size_t, uint8_t);
+        typedef void (*Add)(uint8_t*, const uint8_t*, size_t);
+        typedef void (*Blend)(uint8_t*, const uint8_t*, size_t, uint8_t);
+        Scale volatile mapped = &mapScale;
+        Scale volatile scalar = &scalarScale;
+        Scale volatile words = static_cast<Scale>(&ColorMath::nscale8);
+        Add volatile scalarAdd8 = &scalarAdd;
+        Add volatile wordsAdd8 = static_cast<Add>(&ColorMath::qadd8);
+        Blend volatile scalarBlend8 = &scalarBlend;
+        Blend volatile wordsBlend8 = static_cast<Blend>(&ColorMath::blend8);
+        // Scales close to 255 keep the data from decaying to zero during the run.
+        uint32_t step = 0;
+        runner.run("scale_map", {{"pixels", length}}, [&]() {
+            mapped(data.data(), bytes, (uint8_t)(254 + (step++ & 1)));
+        });
+        runner.run("scale_scalar", {{"pixels", length}}, [&]() {
+            scalar(data.data(), bytes, (uint8_t)(254 + (step++ & 1)));
+        });
+        runner.run("scale_swar", {{"pixels", length}}, [&]() {
+            words(data.data(), bytes, (uint8_t)(254 + (step++ & 1)));
+        });
+        runner.run("qadd_scalar", {{"pixels", length}}, [&]() {
+            scalarAdd8(data.data(), other.data(), bytes);
+        });
+        runner.run("qadd_swar", {{"pixels", length}}, [&]() {
+            wordsAdd8(data.data(), other.data(), bytes);
+        });
+        runner.run("blend_scalar", {{"pixels", length}}, [&]() {
+            scalarBlend8(data.data(), other.data(), bytes, (uint8_t)step++);
+        });
+        runner.run("blend_swar", {{"pixels", length}}, [&]() {
+            wordsBlend8(data.data(), other.data(), bytes, (uint8_t)step++);
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(rainbow) {
+    // Rendering one rainbow frame: library HSV and gamma per pixel versus a single-pass fill.
+    static const uint16_t lengths[] = {50, 300, 1000};
+    for (uint16_t length : lengths) {
+        LedNeoPixel strip(6, length);
+        uint16_t hueStep = (uint16_t)(65536L / length);
+        uint16_t firstHue = 0;
+        runner.run("color_hsv_gamma32", {{"pixels", length}}, [&]() {
+            firstHue += 256;
+            for (uint16_t i = 0; i < length; i++) {
+                strip.setColor(i, strip.gamma32(strip.ColorHSV((uint16_t)(firstHue + i * hueStep))));
+            }
+        });
+        runner.run("fill_rainbow", {{"pixels", length}}, [&]() {
+            firstHue += 256;
+            strip.fillRainbow(0, length, firstHue, hueStep);
+        });
+        runner.run("fill_gradient", {{"pixels", length}}, [&]() {
+            firstHue += 256;
+            strip.fillGradient(0, length, {firstHue, 255, 255}, {(uint16_t)(firstHue + 20000), 128, 64});
+        });
+    }
+}
+
+LED_BENCHMARK_SUITE(effects) {
+    // One loop iteration of the effect engine: nothing due, or every effect due.
+    static const uint16_t counts[] = {8, 32, 128};
+    for (uint16_t count : counts) {
+        std::vector<std::unique_ptr<LedRgb>> leds;
+        std::vector<std::unique_ptr<BreatheEffect>> breathes;
+        EffectEngine engine;
+        for (uint16_t i = 0; i < count; i++) {
+            leds.emplace_back(new LedRgb(9, 10, 11));
+            breathes.emplace_back(new BreatheEffect(*leds.back(), {255, 120, 40}, 2000, 20));
+            engine.add(*breathes.back(), 0);
+        }
+        uint32_t now = 0;
+        engine.tick(now);
+        runner.run("tick_idle", {{"effects", count}}, [&]() {
+            engine.tick(now + 1);
+        });
+        runner.run("tick_all_due", {{"effects", count}}, [&]() {
+            now += 20;
+            engine.tick(now);
+        });
+    }
+}
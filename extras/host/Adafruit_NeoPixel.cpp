@@ -0,0 +1,235 @@
+/**
+ * @file Adafruit_NeoPixel.cpp
+ * @brief Implementation of the host stand-in for the Adafruit NeoPixel library.
+ */
+#include "Adafruit_NeoPixel.h"
+
+namespace {
+
+// WS2812 timing at 800 kHz: 1.25 us per bit.
+const uint32_t kNsPerByte800 = 10000;
+const uint32_t kNsPerByte400 = 20000;
+
+} // namespace
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, neoPixelType t)
+    : is800KHz(true), begun(false), numLEDs(0), numBytes(0), pin(-1), brightness(0), pixels(nullptr),
+      rOffset(1), gOffset(0), bOffset(2), wOffset(1), endTime(0) {
+    updateType(t);
+    updateLength(n);
+    setPin(p);
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel()
+    : is800KHz(true), begun(false), numLEDs(0), numBytes(0), pin(-1), brightness(0), pixels(nullptr),
+      rOffset(1), gOffset(0), bOffset(2), wOffset(1), endTime(0) {}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() {
+    free(pixels);
+}
+
+void Adafruit_NeoPixel::begin() {
+    if (pin >= 0) {
+        pinMode(pin, OUTPUT);
+        digitalWrite(pin, LOW);
+    }
+    begun = true;
+}
+
+void Adafruit_NeoPixel::show() {
+    if (!pixels) {
+        return;
+    }
+    // Wait out the latch interval of the previous frame, as the real library does.
+    if (!canShow()) {
+        HostSim::advanceMicros(300 - ((uint32_t)micros() - endTime));
+    }
+    uint32_t duration = numBytes * (is800KHz ? kNsPerByte800 : kNsPerByte400);
+    HostSim::onStripShow(pin, pixels, numBytes, duration);
+    endTime = micros();
+}
+
+void Adafruit_NeoPixel::setPin(int16_t p) {
+    if (begun && pin >= 0) {
+        pinMode(pin, INPUT);
+    }
+    pin = p;
+    if (begun) {
+        pinMode(p, OUTPUT);
+        digitalWrite(p, LOW);
+    }
+}
+
+void Adafruit_NeoPixel::updateLength(uint16_t n) {
+    free(pixels);
+    numBytes = n * ((wOffset == rOffset) ? 3 : 4);
+    pixels = static_cast<uint8_t*>(calloc(numBytes, 1));
+    if (pixels) {
+        numLEDs = n;
+    } else {
+        numLEDs = numBytes = 0;
+    }
+}
+
+void Adafruit_NeoPixel::updateType(neoPixelType t) {
+    bool oldThreeBytesPerPixel = (wOffset == rOffset);
+    wOffset = (t >> 6) & 0b11;
+    rOffset = (t >> 4) & 0b11;
+    gOffset = (t >> 2) & 0b11;
+    bOffset = t & 0b11;
+    is800KHz = (t < 256);
+    if (pixels && oldThreeBytesPerPixel != (wOffset == rOffset)) {
+        updateLength(numLEDs);
+    }
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n >= numLEDs) {
+        return;
+    }
+    if (brightness) {
+        r = (r * brightness) >> 8;
+        g = (g * brightness) >> 8;
+        b = (b * brightness) >> 8;
+    }
+    uint8_t* p;
+    if (wOffset == rOffset) {
+        p = &pixels[n * 3];
+    } else {
+        p = &pixels[n * 4];
+        p[wOffset] = 0;
+    }
+    p[rOffset] = r;
+    p[gOffset] = g;
+    p[bOffset] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (n >= numLEDs) {
+        return;
+    }
+    if (wOffset == rOffset) {
+        setPixelColor(n, r, g, b);
+        return;
+    }
+    if (brightness) {
+        r = (r * brightness) >> 8;
+        g = (g * brightness) >> 8;
+        b = (b * brightness) >> 8;
+        w = (w * brightness) >> 8;
+    }
+    uint8_t* p = &pixels[n * 4];
+    p[wOffset] = w;
+    p[rOffset] = r;
+    p[gOffset] = g;
+    p[bOffset] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+    setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c, (uint8_t)(c >> 24));
+}
+
+void Adafruit_NeoPixel::fill(uint32_t c, uint16_t first, uint16_t count) {
+    if (first >= numLEDs) {
+        return;
+    }
+    uint16_t end = (count == 0 || first + count > numLEDs) ? numLEDs : first + count;
+    for (uint16_t i = first; i < end; i++) {
+        setPixelColor(i, c);
+    }
+}
+
+void Adafruit_NeoPixel::setBrightness(uint8_t b) {
+    // Stored as b + 1 so that 0 means "no scaling" and the hot path stays cheap.
+    uint8_t newBrightness = b + 1;
+    if (newBrightness == brightness) {
+        return;
+    }
+    // Rescale the existing data. This is lossy, exactly like the real library.
+    uint8_t oldBrightness = brightness - 1;
+    uint16_t scale;
+    if (oldBrightness == 0) {
+        scale = 0;
+    } else if (b == 255) {
+        scale = 65535 / oldBrightness;
+    } else {
+        scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+    }
+    for (uint16_t i = 0; i < numBytes; i++) {
+        pixels[i] = (pixels[i] * scale) >> 8;
+    }
+    brightness = newBrightness;
+}
+
+void Adafruit_NeoPixel::clear() {
+    memset(pixels, 0, numBytes);
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+    if (n >= numLEDs) {
+        return 0;
+    }
+    const uint8_t* p = (wOffset == rOffset) ? &pixels[n * 3] : &pixels[n * 4];
+    uint32_t r = p[rOffset];
+    uint32_t g = p[gOffset];
+    uint32_t b = p[bOffset];
+    uint32_t w = (wOffset == rOffset) ? 0 : p[wOffset];
+    if (brightness) {
+        r = (r << 8) / brightness;
+        g = (g << 8) / brightness;
+        b = (b << 8) / brightness;
+        w = (w << 8) / brightness;
+    }
+    return (w << 24) | (r << 16) | (g << 8) | b;
+}
+
+uint8_t Adafruit_NeoPixel::sine8(uint8_t x) {
+    return (uint8_t)lround(127.5 + 127.5 * sin(x * 2.0 * M_PI / 256.0));
+}
+
+uint8_t Adafruit_NeoPixel::gamma8(uint8_t x) {
+    static uint8_t table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (int i = 0; i < 256; i++) {
+            table[i] = (uint8_t)lround(pow(i / 255.0, 2.6) * 255.0);
+        }
+        initialized = true;
+    }
+    return table[x];
+}
+
+uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+    // Map the 16-bit hue onto six 256-step ramps between the primaries.
+    uint32_t h = ((uint32_t)hue * 1530 + 32768) / 65536;
+    uint8_t r, g, b;
+    if (h < 255) {
+        r = 255; g = h; b = 0;
+    } else if (h < 510) {
+        r = 510 - h; g = 255; b = 0;
+    } else if (h < 765) {
+        r = 0; g = 255; b = h - 510;
+    } else if (h < 1020) {
+        r = 0; g = 1020 - h; b = 255;
+    } else if (h < 1275) {
+        r = h - 1020; g = 0; b = 255;
+    } else if (h < 1530) {
+        r = 255; g = 0; b = 1530 - h;
+    } else {
+        r = 255; g = 0; b = 0;
+    }
+    uint32_t v1 = 1 + val;
+    uint16_t s1 = 1 + sat;
+    uint8_t s2 = 255 - sat;
+    return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+           (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+           (((((b * s1) >> 8) + s2) * v1) >> 8);
+}
+
+uint32_t Adafruit_NeoPixel::gamma32(uint32_t x) {
+    uint8_t* y = reinterpret_cast<uint8_t*>(&x);
+    for (uint8_t i = 0; i < 4; i++) {
+        y[i] = gamma8(y[i]);
+    }
+    return x;
+}
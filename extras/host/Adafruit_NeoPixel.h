@@ -0,0 +1,90 @@
+/**
+ * @file Adafruit_NeoPixel.h
+ * @brief Host stand-in for the Adafruit NeoPixel library.
+ *
+ * Mirrors the public interface and the protected data members of the real
+ * Adafruit_NeoPixel class that the drivers rely on. Pixel data is stored in the
+ * same layout (color order, brightness applied on write), and `show()` hands the
+ * buffer to the HostSim recorder, charging the virtual clock with the time the
+ * transmission would take at 800 kHz including the latch interval.
+ */
+#ifndef XDUINORAILS_HOST_ADAFRUIT_NEOPIXEL_H
+#define XDUINORAILS_HOST_ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+// Color order: bits 7,6 = white offset, 5,4 = red, 3,2 = green, 1,0 = blue.
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_RGBW ((3 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRBW ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+typedef uint16_t neoPixelType;
+
+/**
+ * @class Adafruit_NeoPixel
+ * @brief Host stand-in for the Adafruit_NeoPixel strip class.
+ */
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800);
+    Adafruit_NeoPixel();
+    ~Adafruit_NeoPixel();
+
+    void begin();
+    void show();
+    void setPin(int16_t p);
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+    void setPixelColor(uint16_t n, uint32_t c);
+    void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+    void setBrightness(uint8_t b);
+    void clear();
+    void updateLength(uint16_t n);
+    void updateType(neoPixelType t);
+
+    /**
+     * @brief Checks whether the latch interval since the last transmission has passed.
+     */
+    bool canShow() const { return (uint32_t)micros() - endTime >= 300L; }
+
+    uint8_t* getPixels() const { return pixels; }
+    uint8_t getBrightness() const { return brightness - 1; }
+    int16_t getPin() const { return pin; }
+    uint16_t numPixels() const { return numLEDs; }
+    uint32_t getPixelColor(uint16_t n) const;
+
+    static uint8_t sine8(uint8_t x);
+    static uint8_t gamma8(uint8_t x);
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+        return ((uint32_t)w << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255);
+    static uint32_t gamma32(uint32_t x);
+
+protected:
+    bool is800KHz;      ///< True for 800 kHz pixels.
+    bool begun;         ///< True if begin() was called.
+    uint16_t numLEDs;   ///< Number of pixels in the strip.
+    uint16_t numBytes;  ///< Size of the `pixels` buffer.
+    int16_t pin;        ///< Output pin number (-1 if not set).
+    uint8_t brightness; ///< Strip brightness, stored as value + 1 (0 means full).
+    uint8_t* pixels;    ///< Pixel data, 3 or 4 bytes per pixel in wire order.
+    uint8_t rOffset;    ///< Red index within each pixel.
+    uint8_t gOffset;    ///< Green index within each pixel.
+    uint8_t bOffset;    ///< Blue index within each pixel.
+    uint8_t wOffset;    ///< White index within each pixel (same as rOffset if none).
+    uint32_t endTime;   ///< micros() at the end of the last transmission.
+};
+
+#endif // XDUINORAILS_HOST_ADAFRUIT_NEOPIXEL_H
@@ -0,0 +1,126 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core API.
+ *
+ * Provides the subset of the Arduino API used by the drivers in `src/`, so that
+ * they can be compiled and run on a desktop machine. GPIO calls and timing are
+ * forwarded to the HostSim recorder (@see HostSim.h) instead of hardware.
+ */
+#ifndef XDUINORAILS_HOST_ARDUINO_H
+#define XDUINORAILS_HOST_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "HostSim.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+inline void pinMode(uint8_t pin, uint8_t mode) { HostSim::onPinMode(pin, mode); }
+inline void digitalWrite(uint8_t pin, uint8_t level) { HostSim::onDigitalWrite(pin, level); }
+inline int digitalRead(uint8_t pin) { return HostSim::onDigitalRead(pin); }
+inline void analogWrite(uint8_t pin, int value) { HostSim::onAnalogWrite(pin, value); }
+
+inline unsigned long micros() { return (unsigned long)(HostSim::nowNs() / 1000); }
+inline unsigned long millis() { return (unsigned long)(HostSim::nowNs() / 1000000); }
+inline void delayMicroseconds(unsigned int us) { HostSim::advanceNs((uint64_t)us * 1000); }
+inline void delay(unsigned long ms) { HostSim::advanceNs((uint64_t)ms * 1000000); }
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+template <typename T>
+inline T constrain(T x, T low, T high) {
+    return x < low ? low : (x > high ? high : x);
+}
+
+/**
+ * @class Print
+ * @brief Minimal stand-in for the Arduino Print class.
+ */
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t print(const char* str) { return write(reinterpret_cast<const uint8_t*>(str), strlen(str)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned long value, int base = DEC) { return printNumber(value, base); }
+    size_t print(long value, int base = DEC) {
+        if (value < 0 && base == DEC) {
+            return print('-') + printNumber((unsigned long)(-value), base);
+        }
+        return printNumber((unsigned long)value, base);
+    }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(unsigned long long value, int base = DEC) { return printNumber(value, base); }
+    size_t print(double value, int digits = 2) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+        return print(buffer);
+    }
+
+    size_t println() { return print("\r\n"); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+
+private:
+    size_t printNumber(unsigned long long value, int base) {
+        char buffer[66];
+        char* p = &buffer[sizeof(buffer) - 1];
+        *p = '\0';
+        do {
+            int digit = (int)(value % base);
+            *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+            value /= base;
+        } while (value);
+        return print(p);
+    }
+};
+
+/**
+ * @class HostSerial
+ * @brief Stand-in for the Arduino `Serial` object, writing to standard output.
+ */
+class HostSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    explicit operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+
+extern HostSerial Serial;
+
+#endif // XDUINORAILS_HOST_ARDUINO_H
@@ -0,0 +1,23 @@
+/**
+ * @file HostDrivers.cpp
+ * @brief Compiles every driver and HAL in `src/` against the host stand-ins.
+ *
+ * Header-only code is only checked by the compiler once it is instantiated, so the
+ * class templates are explicitly instantiated here with a representative layout.
+ */
+#include <ArduinoLedDriverHAL.h>
+#include <LedEffects.h>
+#include <LedHAL_Max7219.h>
+#include <LedHAL_ShiftMatrix.h>
+#include <PovRefresh_Rp2040.h>
+#include <StaticLedDriverHAL.h>
+#include <StaticLedHAL.h>
+#include <StripTransport_Rp2040.h>
+#include <StripTransport_Spi.h>
+
+template class StaticLedDriverHAL<8, 1024>;
+
+template class StaticLedHAL<StaticLed::Single<13>,
+                            StaticLed::Multi<StaticLed::Pins<2, 3, 4>, 1>,
+                            StaticLed::Rgb<9, 10, 11, 1>,
+                            StaticLed::NeoPixel<6, 30, 2>>;
@@ -0,0 +1,30 @@
+/**
+ * @file HostDriversCxx11.cpp
+ * @brief Compiles the drivers and HALs as C++11 (gnu++11).
+ *
+ * The SAMD core and ESP32 cores before 3.0 build sketches with `-std=gnu++11`, while
+ * the rest of the host build uses C++14. Built as a separate object library so that
+ * constructs newer than C++11 in the headers fail the host build.
+ */
+#include <ArduinoLedDriverHAL.h>
+#include <LedEffects.h>
+#include <LedHAL_Max7219.h>
+#include <LedHAL_ShiftMatrix.h>
+#include <PovRefresh.h>
+#include <StaticLedDriverHAL.h>
+#include <StaticLedHAL.h>
+#include <StripTransport_Spi.h>
+
+template class StaticLedDriverHAL<8, 1024>;
+
+template class StaticLedHAL<StaticLed::Single<13>,
+                            StaticLed::Multi<StaticLed::Pins<2, 3, 4>, 1>,
+                            StaticLed::Rgb<9, 10, 11, 1>,
+                            StaticLed::NeoPixel<6, 30, 2>>;
+
+// Member templates are not instantiated with the class.
+template void StaticLedHAL<StaticLed::Single<13>, StaticLed::NeoPixel<6, 30, 2>>::setGroupColor<2>(const RgbColor&);
+template void StaticLedHAL<StaticLed::Single<13>, StaticLed::NeoPixel<6, 30, 2>>::setGroupBrightness<2>(uint8_t);
+
+static constexpr GammaTable kGamma22(220);
+static_assert(kGamma22[255] == 255 && kGamma22[0] == 0, "GammaTable must be a constant expression");
@@ -0,0 +1,49 @@
+/**
+ * @file HostDriversPortIo.cpp
+ * @brief Compiles the port register paths of the drivers against SAMD-style port macros.
+ *
+ * The host core has no port macros, so `XDUINORAILS_CHARLIEPLEX_PORT_IO` is off in the
+ * rest of the host build. This file defines stand-ins shaped like the SAMD core, where
+ * `digitalPinToPort()` yields a `PortGroup*` rather than the port number of AVR, and
+ * compiles as C++11 like that core. Built as a separate object library, because the
+ * macros change the layout of the driver classes.
+ */
+#include <Arduino.h>
+
+// The register path is only chosen automatically on the AVR and SAMD cores.
+#define ARDUINO_ARCH_SAMD
+
+namespace HostPortIo {
+
+/// Stand-in for a SAMD register with its `reg` member.
+struct Register {
+    volatile uint32_t reg;
+};
+
+/// Stand-in for a SAMD `PortGroup`.
+struct PortGroup {
+    Register DIR;
+    Register OUT;
+};
+
+extern PortGroup groups[2];
+
+}  // namespace HostPortIo
+
+#define digitalPinToPort(P) (&HostPortIo::groups[(P) >> 5])
+#define digitalPinToBitMask(P) (1ul << ((P) & 31))
+#define portOutputRegister(port) (&(port)->OUT.reg)
+#define portModeRegister(port) (&(port)->DIR.reg)
+
+#include <LedHAL_CharliePlex.h>
+
+static_assert(XDUINORAILS_CHARLIEPLEX_PORT_IO, "The port macros must enable the port register path");
+
+HostPortIo::PortGroup HostPortIo::groups[2];
+
+void hostPortIoCharliePlex() {
+    const uint8_t pins[] = {2, 3, 35};
+    LedCharliePlex matrix(pins, 3);
+    matrix.setPixelColor(0, {255, 255, 255});
+    matrix.show();
+}
@@ -0,0 +1,14 @@
+/**
+ * @file HostDriversStats.cpp
+ * @brief Compiles the drivers and HALs with instrumentation enabled.
+ *
+ * Built as a separate object library, because enabling the counters changes the
+ * layout of the driver classes.
+ */
+#define XDUINORAILS_LED_STATS 1
+#include <ArduinoLedDriverHAL.h>
+#include <LedHAL_Max7219.h>
+#include <LedHAL_ShiftMatrix.h>
+#include <StaticLedDriverHAL.h>
+
+template class StaticLedDriverHAL<8, 1024>;
@@ -0,0 +1,72 @@
+/**
+ * @file HostPovRefresh.cpp
+ * @brief Implementation of the thread-backed stand-in for a background POV refresh.
+ */
+#include "HostPovRefresh.h"
+
+namespace {
+
+// Wake-up interval while no driver is registered.
+const uint32_t kIdleMicros = 10000;
+
+} // namespace
+
+HostPovRefresh::HostPovRefresh(uint16_t refreshHz) : PovRefresh(refreshHz), _epoch(Clock::now()) {}
+
+HostPovRefresh::~HostPovRefresh() {
+    end();
+}
+
+void HostPovRefresh::begin() {
+    if (_worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = false;
+    }
+    _worker = std::thread(&HostPovRefresh::run, this);
+}
+
+void HostPovRefresh::end() {
+    if (!_worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _worker.join();
+    blankAll();
+}
+
+void HostPovRefresh::enterCommit() {
+    _frameMutex.lock();
+}
+
+void HostPovRefresh::exitCommit() {
+    _frameMutex.unlock();
+}
+
+void HostPovRefresh::enterScan() {
+    _frameMutex.lock();
+}
+
+void HostPovRefresh::exitScan() {
+    _frameMutex.unlock();
+}
+
+void HostPovRefresh::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+        lock.unlock();
+        Clock::time_point start = Clock::now();
+        uint32_t now = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(start - _epoch).count();
+        uint32_t wait = service(now);
+        lock.lock();
+        // Sleep until the next event, measured from the time `service()` was called with.
+        Clock::time_point due = start + std::chrono::microseconds(wait == kIdle ? kIdleMicros : wait);
+        _cv.wait_until(lock, due, [this]() { return _stop; });
+    }
+}
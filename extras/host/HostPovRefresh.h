@@ -0,0 +1,68 @@
+/**
+ * @file HostPovRefresh.h
+ * @brief Thread-backed stand-in for a background POV refresh.
+ *
+ * Plays the role of the timer interrupt or the second core: a worker thread calls
+ * `service()` at the scheduled times in real time, so the refresh rate and jitter
+ * reported by PovRefresh are those of the host scheduler.
+ */
+#ifndef XDUINORAILS_HOST_POV_REFRESH_H
+#define XDUINORAILS_HOST_POV_REFRESH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <PovRefresh.h>
+
+/**
+ * @class HostPovRefresh
+ * @brief PovRefresh that scans from a worker thread.
+ *
+ * The frame handover is guarded by a mutex. The scan records its GPIO calls with
+ * HostSim from the worker thread; HostSim itself is not synchronized, so inspect pin
+ * states and counters only after `end()`.
+ */
+class HostPovRefresh : public PovRefresh {
+public:
+    /**
+     * @brief Constructor. The worker thread is started by `begin()`.
+     * @param refreshHz The target number of frames per second.
+     */
+    explicit HostPovRefresh(uint16_t refreshHz = 100);
+
+    /**
+     * @brief Destructor that stops the worker thread.
+     */
+    ~HostPovRefresh() override;
+
+    /**
+     * @brief Starts the worker thread.
+     */
+    void begin();
+
+    /**
+     * @brief Stops the worker thread and turns all drivers off.
+     */
+    void end();
+
+protected:
+    void enterCommit() override;
+    void exitCommit() override;
+    void enterScan() override;
+    void exitScan() override;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+
+    Clock::time_point _epoch;       ///< Real time that `micros` 0 corresponds to.
+    std::mutex _frameMutex;         ///< Serializes `service()` and the foreground.
+    std::mutex _mutex;              ///< Guards `_stop`.
+    std::condition_variable _cv;    ///< Wakes the worker thread early to stop.
+    bool _stop = false;             ///< True when the worker thread should exit.
+    std::thread _worker;            ///< The worker thread, while started.
+};
+
+#endif // XDUINORAILS_HOST_POV_REFRESH_H
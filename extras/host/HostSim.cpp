@@ -0,0 +1,200 @@
+/**
+ * @file HostSim.cpp
+ * @brief Implementation of the host recorder and the stand-in serial port.
+ */
+#include "HostSim.h"
+#include "Arduino.h"
+#include "SPI.h"
+
+#include <stdio.h>
+#include <string.h>
+
+HostSerial Serial;
+SPIClass SPI;
+
+namespace HostSim {
+
+namespace {
+
+const size_t kPinCount = 256;
+
+/**
+ * @struct State
+ * @brief Everything the recorder keeps between calls.
+ */
+struct State {
+    Counters counters;
+    std::vector<PinEvent> pinEvents;
+    std::vector<StripFrame> stripFrames;
+    std::vector<SpiTransfer> spiTransfers;
+    std::vector<LatchedWord> latchedWords;
+    std::vector<uint8_t> chain;         ///< Bytes shifted into the chain, oldest first.
+    std::vector<uint8_t> chainOutputs;  ///< The chain contents at the last latch edge.
+    uint8_t latchPin = 0;
+    uint8_t pinModes[kPinCount] = {};
+    uint16_t pinValues[kPinCount] = {};
+    uint64_t nowNs = 0;
+    uint32_t gpioCostNs = 0;
+    bool recording = false;
+};
+
+State& state() {
+    static State instance;
+    return instance;
+}
+
+void recordPinEvent(uint8_t pin, PinEventType type, uint16_t value) {
+    State& s = state();
+    if (s.recording) {
+        s.pinEvents.push_back({s.nowNs, pin, type, value});
+    }
+    s.nowNs += s.gpioCostNs;
+}
+
+} // namespace
+
+void reset() {
+    State& s = state();
+    s.counters = Counters();
+    s.pinEvents.clear();
+    s.stripFrames.clear();
+    s.spiTransfers.clear();
+    s.latchedWords.clear();
+    s.chain.assign(s.chain.size(), 0);
+    s.chainOutputs.assign(s.chainOutputs.size(), 0);
+    for (size_t i = 0; i < kPinCount; i++) {
+        s.pinModes[i] = INPUT;
+        s.pinValues[i] = 0;
+    }
+    s.nowNs = 0;
+}
+
+void resetCounters() {
+    state().counters = Counters();
+}
+
+void setRecording(bool enabled) {
+    state().recording = enabled;
+}
+
+void setGpioCostNs(uint32_t costNs) {
+    state().gpioCostNs = costNs;
+}
+
+const Counters& counters() {
+    return state().counters;
+}
+
+const std::vector<PinEvent>& pinEvents() {
+    return state().pinEvents;
+}
+
+const std::vector<StripFrame>& stripFrames() {
+    return state().stripFrames;
+}
+
+const std::vector<SpiTransfer>& spiTransfers() {
+    return state().spiTransfers;
+}
+
+void attachShiftChain(uint8_t latchPin, size_t length) {
+    State& s = state();
+    s.latchPin = latchPin;
+    s.chain.assign(length, 0);
+    s.chainOutputs.assign(length, 0);
+}
+
+const std::vector<uint8_t>& shiftChainOutputs() {
+    return state().chainOutputs;
+}
+
+const std::vector<LatchedWord>& latchedWords() {
+    return state().latchedWords;
+}
+
+uint8_t getPinMode(uint8_t pin) {
+    return state().pinModes[pin];
+}
+
+uint16_t getPinValue(uint8_t pin) {
+    return state().pinValues[pin];
+}
+
+uint64_t nowNs() {
+    return state().nowNs;
+}
+
+void advanceNs(uint64_t ns) {
+    state().nowNs += ns;
+}
+
+void onPinMode(uint8_t pin, uint8_t mode) {
+    State& s = state();
+    s.counters.pinModeCalls++;
+    s.pinModes[pin] = mode;
+    recordPinEvent(pin, PIN_MODE, mode);
+}
+
+void onDigitalWrite(uint8_t pin, uint8_t level) {
+    State& s = state();
+    s.counters.digitalWriteCalls++;
+    if (pin == s.latchPin && !s.chain.empty() && level && !s.pinValues[pin]) {
+        s.counters.latches++;
+        s.chainOutputs = s.chain;
+        if (s.recording) {
+            s.latchedWords.push_back({s.nowNs, s.chain});
+        }
+    }
+    s.pinValues[pin] = level ? HIGH : LOW;
+    recordPinEvent(pin, DIGITAL_WRITE, s.pinValues[pin]);
+}
+
+void onAnalogWrite(uint8_t pin, int value) {
+    State& s = state();
+    s.counters.analogWriteCalls++;
+    s.pinValues[pin] = (uint16_t)value;
+    recordPinEvent(pin, ANALOG_WRITE, s.pinValues[pin]);
+}
+
+int onDigitalRead(uint8_t pin) {
+    State& s = state();
+    s.counters.digitalReadCalls++;
+    s.nowNs += s.gpioCostNs;
+    return s.pinValues[pin] ? HIGH : LOW;
+}
+
+void onStripShow(int16_t pin, const uint8_t* data, size_t length, uint32_t durationNs, bool blocking) {
+    State& s = state();
+    s.counters.stripShows++;
+    s.counters.stripBytes += length;
+    if (s.recording) {
+        s.stripFrames.push_back({s.nowNs, durationNs, pin, std::vector<uint8_t>(data, data + length)});
+    }
+    if (blocking) {
+        s.nowNs += durationNs;
+    }
+}
+
+void onSpiTransfer(const uint8_t* data, size_t length, uint32_t clockHz) {
+    State& s = state();
+    s.counters.spiTransfers++;
+    s.counters.spiBytes += length;
+    uint32_t durationNs = clockHz ? (uint32_t)((uint64_t)length * 8 * 1000000000ULL / clockHz) : 0;
+    if (s.recording) {
+        s.spiTransfers.push_back({s.nowNs, durationNs, clockHz, std::vector<uint8_t>(data, data + length)});
+    }
+    size_t chainLength = s.chain.size();
+    if (chainLength) {
+        // Keep the last bytes shifted in; earlier ones have dropped out of the end of the chain.
+        size_t shifted = length < chainLength ? length : chainLength;
+        memmove(s.chain.data(), s.chain.data() + shifted, chainLength - shifted);
+        memcpy(s.chain.data() + chainLength - shifted, data + length - shifted, shifted);
+    }
+    s.nowNs += durationNs;
+}
+
+} // namespace HostSim
+
+size_t HostSerial::write(uint8_t c) {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+}
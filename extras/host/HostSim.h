@@ -0,0 +1,221 @@
+/**
+ * @file HostSim.h
+ * @brief Recorder behind the host stand-ins for the Arduino API.
+ *
+ * When the drivers are built for a desktop machine, every GPIO call made through
+ * the stand-in `Arduino.h` and every strip transmission made through the stand-in
+ * `Adafruit_NeoPixel.h` and `SPI.h` ends up here. The recorder keeps per-call counters, the
+ * current state of each pin, a virtual clock, and optionally a complete log of pin
+ * transitions and strip frames with virtual timestamps. A simulated shift register
+ * chain can be attached to the SPI bus to capture the words latched into it.
+ *
+ * Time only advances when the simulated code waits (`delay()`,
+ * `delayMicroseconds()`), when a strip is transmitted, when the per-call GPIO cost
+ * is non-zero, or when `advanceMicros()` is called. This makes timings
+ * deterministic and independent of the speed of the host.
+ */
+#ifndef XDUINORAILS_HOST_SIM_H
+#define XDUINORAILS_HOST_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace HostSim {
+
+/**
+ * @enum PinEventType
+ * @brief The kind of GPIO call a PinEvent was recorded for.
+ */
+enum PinEventType : uint8_t {
+    PIN_MODE,       ///< `pinMode()`; the value is the mode.
+    DIGITAL_WRITE,  ///< `digitalWrite()`; the value is the level.
+    ANALOG_WRITE    ///< `analogWrite()`; the value is the duty cycle.
+};
+
+/**
+ * @struct PinEvent
+ * @brief A single recorded GPIO call.
+ */
+struct PinEvent {
+    uint64_t timeNs;    ///< Virtual time of the call in nanoseconds.
+    uint8_t pin;        ///< The pin number.
+    PinEventType type;  ///< The kind of call.
+    uint16_t value;     ///< The mode, level or duty cycle.
+};
+
+/**
+ * @struct StripFrame
+ * @brief A single recorded strip transmission.
+ */
+struct StripFrame {
+    uint64_t timeNs;            ///< Virtual time at which the transmission started.
+    uint32_t durationNs;        ///< Virtual duration of the transmission on the wire.
+    int16_t pin;                ///< The data pin.
+    std::vector<uint8_t> data;  ///< The bytes in the order they were sent.
+};
+
+/**
+ * @struct SpiTransfer
+ * @brief A single recorded SPI transfer.
+ */
+struct SpiTransfer {
+    uint64_t timeNs;            ///< Virtual time at which the transfer started.
+    uint32_t durationNs;        ///< Virtual duration of the transfer at the SPI clock.
+    uint32_t clockHz;           ///< The SPI clock of the transaction.
+    std::vector<uint8_t> data;  ///< The bytes sent on MOSI.
+};
+
+/**
+ * @struct LatchedWord
+ * @brief The contents of the shift register chain at one rising edge of its latch pin.
+ */
+struct LatchedWord {
+    uint64_t timeNs;            ///< Virtual time of the latch edge.
+    std::vector<uint8_t> data;  ///< The chain contents, in the order the bytes were shifted in.
+};
+
+/**
+ * @struct Counters
+ * @brief Totals of all calls since the last reset. Always maintained.
+ */
+struct Counters {
+    uint32_t pinModeCalls = 0;      ///< Number of `pinMode()` calls.
+    uint32_t digitalWriteCalls = 0; ///< Number of `digitalWrite()` calls.
+    uint32_t analogWriteCalls = 0;  ///< Number of `analogWrite()` calls.
+    uint32_t digitalReadCalls = 0;  ///< Number of `digitalRead()` calls.
+    uint32_t stripShows = 0;        ///< Number of strip transmissions.
+    uint64_t stripBytes = 0;        ///< Number of bytes sent to strips.
+    uint32_t spiTransfers = 0;      ///< Number of SPI transfers.
+    uint64_t spiBytes = 0;          ///< Number of bytes sent through SPI.
+    uint32_t latches = 0;           ///< Number of latch edges of the shift register chain.
+
+    /**
+     * @brief Gets the total number of GPIO calls of all kinds.
+     * @return The number of GPIO calls.
+     */
+    uint32_t gpioCalls() const {
+        return pinModeCalls + digitalWriteCalls + analogWriteCalls + digitalReadCalls;
+    }
+};
+
+/**
+ * @brief Clears counters, logs, pin states and the virtual clock.
+ * Recording and cost settings are kept.
+ */
+void reset();
+
+/**
+ * @brief Clears only the counters, keeping logs, pin states and the clock.
+ */
+void resetCounters();
+
+/**
+ * @brief Enables or disables the event and frame logs. Counters are always kept.
+ * Recording is disabled by default so that long benchmark runs do not grow memory.
+ * @param enabled True to record every pin event and strip frame.
+ */
+void setRecording(bool enabled);
+
+/**
+ * @brief Sets the virtual time charged for every GPIO call.
+ * @param costNs The cost in nanoseconds (default 0).
+ */
+void setGpioCostNs(uint32_t costNs);
+
+/**
+ * @brief Gets the call counters.
+ * @return The counters since the last reset.
+ */
+const Counters& counters();
+
+/**
+ * @brief Gets the recorded pin events, if recording is enabled.
+ * @return The pin events in call order.
+ */
+const std::vector<PinEvent>& pinEvents();
+
+/**
+ * @brief Gets the recorded strip frames, if recording is enabled.
+ * @return The strip frames in transmission order.
+ */
+const std::vector<StripFrame>& stripFrames();
+
+/**
+ * @brief Gets the recorded SPI transfers, if recording is enabled.
+ * @return The SPI transfers in call order.
+ */
+const std::vector<SpiTransfer>& spiTransfers();
+
+/**
+ * @brief Attaches a simulated shift register chain, e.g. 74HC595s or MAX7219s, to the SPI bus.
+ * Every byte sent through SPI is shifted into the chain, and a rising edge on the latch
+ * pin copies the chain to its outputs. The chain is kept by `reset()`, which clears it.
+ * @param latchPin The pin connected to the latch (RCLK) or load (CS) input.
+ * @param length The length of the chain in bytes, or 0 to detach it.
+ */
+void attachShiftChain(uint8_t latchPin, size_t length);
+
+/**
+ * @brief Gets the outputs of the shift register chain, as of its last latch edge.
+ * @return The chain contents, in the order the bytes were shifted in; the register
+ *         nearest to MOSI is last.
+ */
+const std::vector<uint8_t>& shiftChainOutputs();
+
+/**
+ * @brief Gets the words latched into the shift register chain, if recording is enabled.
+ * @return The latched words in latch order.
+ */
+const std::vector<LatchedWord>& latchedWords();
+
+/**
+ * @brief Gets the last mode set on a pin.
+ * @param pin The pin number.
+ * @return The mode (`INPUT` after reset).
+ */
+uint8_t getPinMode(uint8_t pin);
+
+/**
+ * @brief Gets the last value written to a pin.
+ * @param pin The pin number.
+ * @return The level or duty cycle (0 after reset).
+ */
+uint16_t getPinValue(uint8_t pin);
+
+/**
+ * @brief Gets the virtual time.
+ * @return The time since the last reset in nanoseconds.
+ */
+uint64_t nowNs();
+
+/**
+ * @brief Advances the virtual clock.
+ * @param ns The number of nanoseconds to advance.
+ */
+void advanceNs(uint64_t ns);
+
+/**
+ * @brief Advances the virtual clock.
+ * @param us The number of microseconds to advance.
+ */
+inline void advanceMicros(uint32_t us) { advanceNs((uint64_t)us * 1000); }
+
+/** @name Hooks for the stand-ins
+ * Called by the stand-in Arduino API; not meant to be used by sketches. A strip
+ * show with `blocking == false` is recorded without advancing the virtual clock,
+ * as the transmission runs in the background. An SPI transfer advances the clock
+ * by its duration at the SPI clock.
+ */
+///@{
+void onPinMode(uint8_t pin, uint8_t mode);
+void onDigitalWrite(uint8_t pin, uint8_t level);
+void onAnalogWrite(uint8_t pin, int value);
+int onDigitalRead(uint8_t pin);
+void onStripShow(int16_t pin, const uint8_t* data, size_t length, uint32_t durationNs, bool blocking = true);
+void onSpiTransfer(const uint8_t* data, size_t length, uint32_t clockHz);
+///@}
+
+} // namespace HostSim
+
+#endif // XDUINORAILS_HOST_SIM_H
@@ -0,0 +1,96 @@
+/**
+ * @file HostStripTransport.cpp
+ * @brief Implementation of the thread-backed stand-in for an asynchronous strip transport.
+ */
+#include "HostStripTransport.h"
+
+#include <chrono>
+#include "HostSim.h"
+
+namespace {
+
+// WS2812 timing at 800 kHz: 1.25 us per bit, followed by the latch interval.
+const uint32_t kNsPerBit = 1250;
+const uint32_t kLatchNs = 300000;
+
+} // namespace
+
+HostStripTransport::HostStripTransport(int16_t pin, double timeScale, uint8_t laneCount)
+    : _pin(pin), _laneCount(laneCount < 1 ? 1 : (laneCount > 8 ? 8 : laneCount)), _timeScale(timeScale), _worker(&HostStripTransport::run, this) {}
+
+HostStripTransport::~HostStripTransport() {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return !_busy; });
+        _stop = true;
+    }
+    _cv.notify_all();
+    _worker.join();
+}
+
+void HostStripTransport::transmit(const uint8_t* data, size_t length) {
+    uint32_t durationNs;
+    if (_laneCount == 1) {
+        durationNs = (uint32_t)(length * 8 * kNsPerBit);
+        HostSim::onStripShow(_pin, data, length, durationNs, false);
+    } else {
+        // Each byte is one bit slot of all chains; gather the bits of each lane, MSB first.
+        durationNs = (uint32_t)(length * kNsPerBit);
+        _laneData.assign(length / 8, 0);
+        for (uint8_t lane = 0; lane < _laneCount; lane++) {
+            for (size_t slot = 0; slot < _laneData.size() * 8; slot++) {
+                uint8_t& byte = _laneData[slot / 8];
+                byte = (uint8_t)((byte << 1) | ((data[slot] >> lane) & 1));
+            }
+            HostSim::onStripShow(_pin + lane, _laneData.data(), _laneData.size(), durationNs, false);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _busy = true;
+        _busyNs = (uint64_t)((durationNs + kLatchNs) * _timeScale);
+    }
+    _cv.notify_all();
+}
+
+bool HostStripTransport::isBusy() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _busy;
+}
+
+void HostStripTransport::waitIdle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this]() { return !_busy; });
+}
+
+void HostStripTransport::setTimeScale(double timeScale) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _timeScale = timeScale;
+}
+
+uint32_t HostStripTransport::framesSent() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _framesSent;
+}
+
+void HostStripTransport::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this]() { return _busy || _stop; });
+        if (_stop) {
+            return;
+        }
+        uint64_t busyNs = _busyNs;
+        lock.unlock();
+        if (busyNs > 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(busyNs));
+        }
+        lock.lock();
+        _busy = false;
+        _framesSent++;
+        lock.unlock();
+        _cv.notify_all();
+        notifyComplete();
+        lock.lock();
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @file HostStripTransport.h
+ * @brief Thread-backed stand-in for an asynchronous strip transport.
+ *
+ * Plays the role that PIO and DMA play on the RP2040: each frame is recorded with
+ * HostSim when it is handed over, without advancing the virtual clock, and a worker
+ * thread keeps the transport busy for the time the transmission would take.
+ */
+#ifndef XDUINORAILS_HOST_STRIP_TRANSPORT_H
+#define XDUINORAILS_HOST_STRIP_TRANSPORT_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <StripTransport.h>
+
+/**
+ * @class HostStripTransport
+ * @brief StripTransport that completes frames on a worker thread.
+ *
+ * The busy time of a frame is its wire time at 800 kHz plus the latch interval,
+ * multiplied by the time scale. A scale of 1 runs in real time, a scale of 0
+ * completes each frame as soon as the worker thread picks it up. The completion
+ * callback is called on the worker thread, like an interrupt handler would be.
+ *
+ * With several lanes, frames are bit planes as for Rp2040PioStripTransport: each
+ * byte is one bit slot of all chains, and the chain of lane `k` is recorded on pin
+ * `pin + k`.
+ */
+class HostStripTransport : public StripTransport {
+public:
+    /**
+     * @brief Constructor that starts the worker thread.
+     * @param pin The data pin recorded with each frame (of the first chain).
+     * @param timeScale Real time per simulated transmission time.
+     * @param laneCount The number of chains on consecutive pins, 1 to 8.
+     */
+    explicit HostStripTransport(int16_t pin, double timeScale = 1.0, uint8_t laneCount = 1);
+
+    /**
+     * @brief Destructor that waits for the current frame and stops the worker thread.
+     */
+    ~HostStripTransport() override;
+
+    HostStripTransport(const HostStripTransport&) = delete;
+    HostStripTransport& operator=(const HostStripTransport&) = delete;
+
+    void transmit(const uint8_t* data, size_t length) override;
+    bool isBusy() override;
+    void waitIdle() override;
+
+    /**
+     * @brief Sets the real time per simulated transmission time for later frames.
+     * @param timeScale The scale; 0 completes frames immediately.
+     */
+    void setTimeScale(double timeScale);
+
+    /**
+     * @brief Gets the number of frames completed so far.
+     * @return The number of frames.
+     */
+    uint32_t framesSent();
+
+private:
+    void run();
+
+    int16_t _pin;                   ///< The data pin recorded with each frame.
+    uint8_t _laneCount;             ///< The number of chains driven in parallel.
+    double _timeScale;              ///< Real time per simulated transmission time.
+    std::mutex _mutex;              ///< Guards the members below.
+    std::condition_variable _cv;    ///< Signals frame start, completion and stop.
+    bool _busy = false;             ///< True while a frame is in progress.
+    bool _stop = false;             ///< True when the worker thread should exit.
+    uint64_t _busyNs = 0;           ///< Real time the current frame keeps the transport busy.
+    uint32_t _framesSent = 0;       ///< Number of frames completed.
+    std::vector<uint8_t> _laneData; ///< Scratch buffer for the data of one chain.
+    std::thread _worker;            ///< The worker thread; started last.
+};
+
+#endif // XDUINORAILS_HOST_STRIP_TRANSPORT_H
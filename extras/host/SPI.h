@@ -0,0 +1,72 @@
+/**
+ * @file SPI.h
+ * @brief Host stand-in for the Arduino SPI library.
+ *
+ * Provides the transaction API of `SPIClass`. Every transfer is forwarded to the
+ * HostSim recorder (@see HostSim.h) together with the clock of the current
+ * transaction; received bytes are always 0.
+ */
+#ifndef XDUINORAILS_HOST_SPI_H
+#define XDUINORAILS_HOST_SPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "HostSim.h"
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+/**
+ * @class SPISettings
+ * @brief Clock, bit order and data mode of an SPI transaction.
+ */
+class SPISettings {
+public:
+    SPISettings() : clockHz(4000000), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+    SPISettings(uint32_t clock, uint8_t order, uint8_t mode) : clockHz(clock), bitOrder(order), dataMode(mode) {}
+
+    uint32_t clockHz;   ///< The SPI clock in Hz.
+    uint8_t bitOrder;   ///< `MSBFIRST` or `LSBFIRST`.
+    uint8_t dataMode;   ///< One of the `SPI_MODE` constants.
+};
+
+/**
+ * @class SPIClass
+ * @brief Stand-in for an SPI port.
+ */
+class SPIClass {
+public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(const SPISettings& settings) { _settings = settings; }
+    void endTransaction() {}
+
+    uint8_t transfer(uint8_t data) {
+        HostSim::onSpiTransfer(&data, 1, _settings.clockHz);
+        return 0;
+    }
+
+    uint16_t transfer16(uint16_t data) {
+        uint8_t bytes[2] = {(uint8_t)(data >> 8), (uint8_t)data};
+        HostSim::onSpiTransfer(bytes, 2, _settings.clockHz);
+        return 0;
+    }
+
+    void transfer(void* buffer, size_t count) {
+        HostSim::onSpiTransfer(static_cast<const uint8_t*>(buffer), count, _settings.clockHz);
+        memset(buffer, 0, count);
+    }
+
+private:
+    SPISettings _settings;  ///< The settings of the current transaction.
+};
+
+extern SPIClass SPI;
+
+#endif // XDUINORAILS_HOST_SPI_H
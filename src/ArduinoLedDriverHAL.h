@@ -3,21 +3,19 @@
  * @brief Concrete implementation of the LedDriverHAL for the Arduino framework.
  *
  * This file provides the Arduino-specific implementation of the hardware abstraction
- * layer. It manages the lifecycle of all created Led objects and uses a switch
- * statement to instantiate the correct concrete driver based on the LedType enum.
+ * layer. It manages the lifecycle of all created Led objects and uses the shared
+ * factory (@see LedFactory.h) to instantiate the correct concrete driver based on
+ * the LedType enum.
+ * Group membership is indexed as LEDs are added, so group operations only touch
+ * the members of the addressed group.
  */
 #ifndef ARDUINO_LED_DRIVER_HAL_H
 #define ARDUINO_LED_DRIVER_HAL_H
 
 #include <vector>
+#include <algorithm>
 #include "xDuinoRails_LED-Drivers.h"
-#include "LedHAL_Single.h"
-#include "LedHAL_Multi.h"
-#include "LedHAL_Rgb.h"
-#include "LedHAL_NeoPixel.h"
-#include "LedHAL_Ws2811_3x1.h"
-#include "LedHAL_CharliePlex.h"
-#include "LedHAL_Matrix.h"
+#include "LedFactory.h"
 
 /**
  * @class ArduinoLedDriverHAL
@@ -25,7 +23,9 @@
  *
  * This class implements the factory pattern to create and manage various types of
  * LED drivers. It maintains a vector of pointers to all created Led objects and
- * is responsible for their proper deallocation to prevent memory leaks.
+ * is responsible for their proper deallocation to prevent memory leaks. In addition,
+ * it keeps a per-group index of member lists so that group operations scale with
+ * the size of the group rather than with the total number of LEDs.
  */
 class ArduinoLedDriverHAL : public LedDriverHAL {
 public:
@@ -40,6 +40,7 @@ public:
             delete led;
         }
         _leds.clear();
+        _groups.clear();
     }
 
     /**
@@ -47,7 +48,8 @@ public:
      *
      * This method instantiates the appropriate concrete Led class based on the
      * `type` parameter and adds the new object to its internal management list.
-     * It also calculates the `indexInGroup` for the new LED.
+     * The `indexInGroup` for the new LED is taken from the group index, and the
+     * new LED is appended to its group's member list.
      *
      * @param type The type of LED driver to create (@see LedType).
      * @param pins An array of pin numbers. The required pins vary by driver.
@@ -58,60 +60,24 @@ public:
      *         Returns `nullptr` if the parameters are invalid for the requested type.
      */
     Led* addLeds(LedType type, const uint8_t* pins, uint8_t pinCount, uint16_t numLeds = 0, uint8_t groupId = 0) override {
-        uint16_t indexInGroup = 0;
-        for (const auto& led : _leds) {
-            if (led->getGroupId() == groupId) {
-                indexInGroup++;
-            }
-        }
+        LedGroup* group = findGroup(groupId);
+        uint16_t indexInGroup = group ? group->members.size() : 0;
 
-        Led* newLed = nullptr;
-        switch (type) {
-            case SINGLE_LED:
-                if (pinCount >= 1) {
-                    newLed = new LedSingle(pins[0], groupId, indexInGroup);
-                }
-                break;
-            case MULTI_LED:
-                if (pinCount > 1) {
-                    newLed = new LedMulti(pins, pinCount, groupId, indexInGroup);
-                }
-                break;
-            case RGB_LED:
-                if (pinCount >= 3) {
-                    newLed = new LedRgb(pins[0], pins[1], pins[2], groupId, indexInGroup);
-                }
-                break;
-            case NEOPIXEL:
-                if (pinCount >= 1 && numLeds > 0) {
-                    newLed = new LedNeoPixel(pins[0], numLeds, groupId, indexInGroup);
-                }
-                break;
-            case WS2811_3x1:
-                if (pinCount >= 1 && numLeds > 0) {
-                    newLed = new LedWs2811_3x1(pins[0], numLeds, groupId, indexInGroup);
-                }
-                break;
-            case CHARLIEPLEX:
-                if (pinCount > 1) {
-                    newLed = new LedCharliePlex(pins, pinCount, groupId, indexInGroup);
-                }
-                break;
-            case MATRIX:
-                if (numLeds > 0 && pinCount >= numLeds) {
-                    uint8_t rowCount = numLeds;
-                    uint8_t colCount = pinCount - rowCount;
-                    if (colCount > 0) {
-                        const uint8_t* rowPins = pins;
-                        const uint8_t* colPins = pins + rowCount;
-                        newLed = new LedMatrix(rowPins, rowCount, colPins, colCount, groupId, indexInGroup);
-                    }
-                }
-                break;
-        }
+        LedHeapBuilder builder;
+        Led* newLed = createLed(builder, type, pins, pinCount, numLeds, groupId, indexInGroup);
 
         if (newLed) {
             _leds.push_back(newLed);
+            if (!group) {
+                group = insertGroup(groupId);
+            }
+            group->members.push_back(newLed);
+            if (_frameDepth > 0) {
+                newLed->beginFrame();
+            }
+            if (_correction) {
+                newLed->setColorCorrection(_correction);
+            }
         }
         return newLed;
     }
@@ -134,8 +100,9 @@ public:
      * @param color The RgbColor to set.
      */
     void setGroupColor(uint8_t groupId, const RgbColor& color) override {
-        for (Led* led : _leds) {
-            if (led->getGroupId() == groupId) {
+        LedGroup* group = findGroup(groupId);
+        if (group) {
+            for (Led* led : group->members) {
                 led->setColor(color);
             }
         }
@@ -147,15 +114,174 @@ public:
      * @param brightness The brightness level (0-255).
      */
     void setGroupBrightness(uint8_t groupId, uint8_t brightness) override {
-        for (Led* led : _leds) {
-            if (led->getGroupId() == groupId) {
+        LedGroup* group = findGroup(groupId);
+        if (group) {
+            for (Led* led : group->members) {
                 led->setBrightness(brightness);
             }
         }
     }
 
+    /**
+     * @brief Sets the output correction of all LED drivers, including ones added later.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        _correction = correction;
+        for (Led* led : _leds) {
+            led->setColorCorrection(correction);
+        }
+    }
+
+    /**
+     * @brief Sets the output correction for all LED drivers within a specified group.
+     * @param groupId The ID of the group to configure.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     */
+    void setGroupColorCorrection(uint8_t groupId, const ColorCorrection* correction) override {
+        LedGroup* group = findGroup(groupId);
+        if (group) {
+            for (Led* led : group->members) {
+                led->setColorCorrection(correction);
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of LED drivers in a group.
+     * @param groupId The ID of the group to query.
+     * @return The number of Led objects in the group, or 0 if the group is unknown.
+     */
+    uint16_t getGroupSize(uint8_t groupId) override {
+        LedGroup* group = findGroup(groupId);
+        return group ? group->members.size() : 0;
+    }
+
+    /**
+     * @brief Retrieves a pointer to a member of a group by its index within that group.
+     * @param groupId The ID of the group.
+     * @param indexInGroup The zero-based index of the LED driver within the group.
+     * @return A pointer to the Led object, or `nullptr` if the group or index is invalid.
+     */
+    Led* getGroupLed(uint8_t groupId, uint16_t indexInGroup) override {
+        LedGroup* group = findGroup(groupId);
+        if (group && indexInGroup < group->members.size()) {
+            return group->members[indexInGroup];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Opens a frame transaction across all LED drivers.
+     * Nested calls are counted; only the outermost frame is forwarded to the drivers.
+     */
+    void beginFrame() override {
+        if (_frameDepth++ == 0) {
+            for (Led* led : _leds) {
+                led->beginFrame();
+            }
+        }
+    }
+
+    /**
+     * @brief Closes a frame transaction, flushing each driver with deferred output once.
+     */
+    void commitFrame() override {
+        if (_frameDepth > 0 && --_frameDepth == 0) {
+            for (Led* led : _leds) {
+                led->commitFrame();
+            }
+        }
+    }
+
+#if XDUINORAILS_LED_STATS
+    /**
+     * @brief Sums the instrumentation counters of all LED drivers.
+     * Only available when `XDUINORAILS_LED_STATS` is enabled (@see LedStats.h).
+     * @return The aggregate counters; `showMicrosMax` is the maximum over all drivers.
+     */
+    LedStats getStats() const {
+        LedStats total;
+        for (size_t i = 0; i < _leds.size(); i++) {
+            total.add(_leds[i]->getStats());
+        }
+        return total;
+    }
+
+    /**
+     * @brief Clears the instrumentation counters of all LED drivers.
+     */
+    void resetStats() {
+        for (size_t i = 0; i < _leds.size(); i++) {
+            _leds[i]->resetStats();
+        }
+    }
+
+    /**
+     * @brief Prints the counters of each LED driver and the aggregate, e.g. to `Serial`.
+     * @param out The stream to print to.
+     */
+    void printStats(Print& out) const {
+        for (size_t i = 0; i < _leds.size(); i++) {
+            out.print("led ");
+            out.print((unsigned long)i);
+            out.print(" group ");
+            out.print(_leds[i]->getGroupId());
+            out.print(": ");
+            _leds[i]->getStats().printTo(out);
+        }
+        out.print("total: ");
+        getStats().printTo(out);
+    }
+#endif
+
 private:
-    std::vector<Led*> _leds; ///< A vector to store pointers to all managed Led objects.
+    /**
+     * @struct LedGroup
+     * @brief Index entry holding the members of a single group.
+     */
+    struct LedGroup {
+        uint8_t id;                 ///< The group ID.
+        std::vector<Led*> members;  ///< Members of the group, ordered by their indexInGroup.
+    };
+
+    /**
+     * @brief Looks up the index entry for a group.
+     * The entries are kept sorted by ID, so this is a binary search over the
+     * number of groups.
+     * @param groupId The ID of the group to find.
+     * @return A pointer to the group entry, or `nullptr` if no LED uses this group yet.
+     */
+    LedGroup* findGroup(uint8_t groupId) {
+        auto it = lowerBound(groupId);
+        if (it != _groups.end() && it->id == groupId) {
+            return &*it;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Inserts an empty index entry for a group, keeping the entries sorted.
+     * @param groupId The ID of the new group. Must not already be present.
+     * @return A pointer to the new group entry.
+     */
+    LedGroup* insertGroup(uint8_t groupId) {
+        auto it = _groups.insert(lowerBound(groupId), LedGroup{groupId, {}});
+        return &*it;
+    }
+
+    /**
+     * @brief Finds the first group entry whose ID is not less than `groupId`.
+     */
+    std::vector<LedGroup>::iterator lowerBound(uint8_t groupId) {
+        return std::lower_bound(_groups.begin(), _groups.end(), groupId,
+                                [](const LedGroup& group, uint8_t id) { return group.id < id; });
+    }
+
+    std::vector<Led*> _leds;        ///< A vector to store pointers to all managed Led objects.
+    std::vector<LedGroup> _groups;  ///< Per-group member lists, sorted by group ID.
+    uint8_t _frameDepth = 0;        ///< Nesting depth of open frame transactions.
+    const ColorCorrection* _correction = nullptr;   ///< Correction for drivers added later.
 };
 
 #endif // ARDUINO_LED_DRIVER_HAL_H
@@ -0,0 +1,345 @@
+/**
+ * @file ColorCorrection.h
+ * @brief Output correction (gamma, master brightness, color temperature) shared by all drivers.
+ *
+ * LEDs respond linearly to their duty cycle, but the eye does not, so linear fades
+ * look too bright at the low end. A ColorCorrection combines a gamma curve, a
+ * master brightness and a white point into one lookup table per channel, which
+ * the drivers apply in their output path. All math happens when the correction is
+ * configured; the output path only performs table lookups.
+ */
+#ifndef XDUINORAILS_COLOR_CORRECTION_H
+#define XDUINORAILS_COLOR_CORRECTION_H
+
+#include <stdint.h>
+#include "Led.h"
+
+/**
+ * @brief Compile-time index lists, as `std::index_sequence` which needs C++14.
+ */
+namespace GammaDetail {
+template <unsigned... I>
+struct Indices {};
+
+template <typename A, typename B>
+struct Concat;
+
+template <unsigned... A, unsigned... B>
+struct Concat<Indices<A...>, Indices<B...>> {
+    typedef Indices<A..., (unsigned)(sizeof...(A) + B)...> type;
+};
+
+/// `Indices<0, 1, ..., N - 1>`, built by halving so the template depth stays logarithmic.
+template <unsigned N>
+struct MakeIndices {
+    typedef typename Concat<typename MakeIndices<N / 2>::type, typename MakeIndices<N - N / 2>::type>::type type;
+};
+
+template <>
+struct MakeIndices<0> {
+    typedef Indices<> type;
+};
+
+template <>
+struct MakeIndices<1> {
+    typedef Indices<0> type;
+};
+} // namespace GammaDetail
+
+/**
+ * @class GammaTable
+ * @brief 256-entry gamma curve computed by the compiler.
+ *
+ * The constructor is `constexpr`, so a table declared `constexpr` is computed at
+ * compile time and placed in read-only memory:
+ *
+ * @code
+ * static constexpr GammaTable gamma22(220);
+ * @endcode
+ *
+ * The math is written as single-return recursive functions, so that it is a
+ * constant expression under C++11, the default standard of several Arduino cores.
+ */
+class GammaTable {
+public:
+    /**
+     * @brief Computes `round(255 * (value / 255) ^ gamma)` for every value.
+     * @param gammaTimes100 The exponent multiplied by 100, e.g. 260 for gamma 2.6.
+     */
+    constexpr explicit GammaTable(uint16_t gammaTimes100)
+        : GammaTable(gammaTimes100, GammaDetail::MakeIndices<256>::type()) {}
+
+    /**
+     * @brief Looks up the corrected value.
+     * @param value The linear input value.
+     * @return The output value.
+     */
+    constexpr uint8_t operator[](uint8_t value) const {
+        return _values[value];
+    }
+
+private:
+    /**
+     * @brief Fills the table with one entry per index.
+     */
+    template <unsigned... Values>
+    constexpr GammaTable(uint16_t gammaTimes100, GammaDetail::Indices<Values...>)
+        : _values{entry(Values, gammaTimes100)...} {}
+
+    /**
+     * @brief Computes one table entry.
+     */
+    static constexpr uint8_t entry(unsigned value, uint16_t gammaTimes100) {
+        return (uint8_t)(255.0 * power(value / 255.0, gammaTimes100 / 100.0) + 0.5);
+    }
+
+    /**
+     * @brief Computes `x ^ y` for `0 <= x <= 1`, usable in constant expressions.
+     */
+    static constexpr double power(double x, double y) {
+        return x <= 0.0 ? 0.0 : exponential(y * logarithm(x, 0));
+    }
+
+    /**
+     * @brief Computes the natural logarithm of `x * 2 ^ exponent` for `x > 0`.
+     * `x` is first brought into [0.5, 1), then a series around 1 is summed.
+     */
+    static constexpr double logarithm(double x, int exponent) {
+        return x < 0.5 ? logarithm(x * 2.0, exponent - 1)
+             : x >= 1.0 ? logarithm(x / 2.0, exponent + 1)
+             // ln(x) = 2 * atanh(z) with z = (x - 1) / (x + 1), |z| <= 1/3
+             : 2.0 * atanhSeries(0.0, (x - 1.0) / (x + 1.0), ((x - 1.0) / (x + 1.0)) * ((x - 1.0) / (x + 1.0)), 1)
+               + exponent * 0.69314718055994531;
+    }
+
+    /**
+     * @brief Adds the terms `z ^ k / k` for odd `k` below 40 to `sum`.
+     * @param term `z ^ k`.
+     * @param zSquared `z * z`.
+     */
+    static constexpr double atanhSeries(double sum, double term, double zSquared, int k) {
+        return k >= 40 ? sum : atanhSeries(sum + term / k, term * zSquared, zSquared, k + 2);
+    }
+
+    /**
+     * @brief Computes `e ^ y` by halving the argument, a Taylor series and squaring.
+     */
+    static constexpr double exponential(double y, int halvings = 0) {
+        return y < -0.5 || y > 0.5 ? exponential(y / 2.0, halvings + 1)
+                                   : square(taylorSeries(y, 1.0, 1.0, 1), halvings);
+    }
+
+    /**
+     * @brief Adds the terms `y ^ k / k!` for `k` below 20 to `sum`.
+     * @param term `y ^ (k - 1) / (k - 1)!`.
+     */
+    static constexpr double taylorSeries(double y, double term, double sum, int k) {
+        return k >= 20 ? sum : taylorSeries(y, term * (y / k), sum + term * (y / k), k + 1);
+    }
+
+    /**
+     * @brief Squares `x` repeatedly.
+     */
+    static constexpr double square(double x, int times) {
+        return times <= 0 ? x : square(x * x, times - 1);
+    }
+
+    uint8_t _values[256];   ///< Corrected value for every input value.
+};
+
+/**
+ * @brief Common white points, as the channel scale of a white LED under that light.
+ * Passed to `ColorCorrection::setColorTemperature()`.
+ */
+namespace ColorTemperature {
+constexpr RgbColor Candle = {255, 147, 41};             ///< 1900 K
+constexpr RgbColor Tungsten40W = {255, 197, 143};       ///< 2600 K
+constexpr RgbColor Tungsten100W = {255, 214, 170};      ///< 2850 K
+constexpr RgbColor Halogen = {255, 241, 224};           ///< 3200 K
+constexpr RgbColor DirectSunlight = {255, 255, 255};    ///< 6000 K, no correction
+constexpr RgbColor OvercastSky = {201, 226, 255};       ///< 7000 K
+constexpr RgbColor ClearBlueSky = {64, 156, 255};       ///< 20000 K
+} // namespace ColorTemperature
+
+/**
+ * @class ColorCorrection
+ * @brief Per-channel output tables combining gamma, master brightness and color temperature.
+ *
+ * For each channel `c`, the table maps a value `v` to
+ * `gamma[v] * (brightness + 1) / 256 * (temperature.c + 1) / 256 * (calibration.c + 1) / 256`.
+ * A fourth table without the color temperature and calibration serves single-color LEDs.
+ *
+ * The calibration compensates LEDs of different batches or types that render the
+ * same color differently. Each batch gets its own correction, derived from a shared
+ * one with the constructor that takes a calibration, and the drivers of that batch
+ * (or a segment of a strip, @see LedStrip::setSegmentCorrections()) use it. The
+ * coefficients are folded into the tables, so a calibrated LED costs no more at
+ * output than an uncalibrated one.
+ *
+ * A correction is attached to drivers by pointer (@see Led::setColorCorrection(),
+ * LedDriverHAL::setColorCorrection()), so one object can serve many drivers. It
+ * must outlive them. After changing a correction that is in use, attach it again
+ * so that the drivers re-render their outputs.
+ */
+class ColorCorrection {
+public:
+    /// Index of the single-color table in `table()`.
+    static const uint8_t LEVEL = 3;
+
+    /**
+     * @brief Constructor.
+     * @param gamma The gamma curve, or `nullptr` for a linear response.
+     *              Defaults to `standardGamma()`.
+     * @param brightness The master brightness (0-255).
+     * @param temperature The white point (@see ColorTemperature).
+     */
+    explicit ColorCorrection(const GammaTable* gamma = &standardGamma(), uint8_t brightness = 255,
+                             const RgbColor& temperature = ColorTemperature::DirectSunlight)
+        : _gamma(gamma), _brightness(brightness), _temperature(temperature), _calibration({255, 255, 255}) {
+        rebuild();
+    }
+
+    /**
+     * @brief Constructs a calibrated copy of a correction.
+     * The copy does not follow later changes of `base`.
+     * @param base The correction whose gamma, brightness and color temperature are used.
+     * @param calibration The scale of each channel for the LED batch, e.g. `{255, 230, 210}`
+     *                    for LEDs that look too cold next to others.
+     */
+    ColorCorrection(const ColorCorrection& base, const RgbColor& calibration)
+        : _gamma(base._gamma), _brightness(base._brightness), _temperature(base._temperature),
+          _calibration(calibration) {
+        rebuild();
+    }
+
+    /**
+     * @brief Gets the built-in gamma curve (2.6, as used by the Adafruit NeoPixel library).
+     * @return The gamma table, computed at compile time.
+     */
+    static const GammaTable& standardGamma() {
+        static constexpr GammaTable table(260);
+        return table;
+    }
+
+    /**
+     * @brief Sets the gamma curve.
+     * @param gamma The gamma table, or `nullptr` for a linear response. Must outlive the correction.
+     */
+    void setGamma(const GammaTable* gamma) {
+        _gamma = gamma;
+        rebuild();
+    }
+
+    /**
+     * @brief Sets the master brightness, applied on top of each driver's own brightness.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) {
+        _brightness = brightness;
+        rebuild();
+    }
+
+    /**
+     * @brief Sets the white point.
+     * @param temperature The scale of each channel (@see ColorTemperature).
+     */
+    void setColorTemperature(const RgbColor& temperature) {
+        _temperature = temperature;
+        rebuild();
+    }
+
+    /**
+     * @brief Sets the calibration of the LED batch.
+     * @param calibration The scale of each channel; `{255, 255, 255}` for none.
+     */
+    void setCalibration(const RgbColor& calibration) {
+        _calibration = calibration;
+        rebuild();
+    }
+
+    /**
+     * @brief Gets the gamma curve.
+     * @return The gamma table, or `nullptr` for a linear response.
+     */
+    const GammaTable* getGamma() const { return _gamma; }
+
+    /**
+     * @brief Gets the master brightness.
+     * @return The brightness level (0-255).
+     */
+    uint8_t getBrightness() const { return _brightness; }
+
+    /**
+     * @brief Gets the white point.
+     * @return The scale of each channel.
+     */
+    RgbColor getColorTemperature() const { return _temperature; }
+
+    /**
+     * @brief Gets the calibration of the LED batch.
+     * @return The scale of each channel.
+     */
+    RgbColor getCalibration() const { return _calibration; }
+
+    /**
+     * @brief Gets a table for use in tight loops.
+     * @param channel 0 for red, 1 for green, 2 for blue, `LEVEL` for single-color LEDs.
+     * @return A pointer to the 256 table entries.
+     */
+    const uint8_t* table(uint8_t channel) const {
+        return _tables[channel];
+    }
+
+    /**
+     * @brief Corrects a color.
+     * @param color The linear color.
+     * @return The output color.
+     */
+    RgbColor apply(const RgbColor& color) const {
+        return {_tables[0][color.r], _tables[1][color.g], _tables[2][color.b]};
+    }
+
+    /**
+     * @brief Corrects the level of a single-color LED.
+     * @param value The linear level.
+     * @return The output level.
+     */
+    uint8_t level(uint8_t value) const {
+        return _tables[LEVEL][value];
+    }
+
+private:
+    /**
+     * @brief Recomputes the tables with integer math.
+     */
+    void rebuild() {
+        uint16_t brightnessFactor = (uint16_t)_brightness + 1;
+        uint16_t channelFactors[3] = {channelFactor(_temperature.r, _calibration.r),
+                                      channelFactor(_temperature.g, _calibration.g),
+                                      channelFactor(_temperature.b, _calibration.b)};
+        for (uint16_t value = 0; value < 256; value++) {
+            uint8_t curved = _gamma ? (*_gamma)[(uint8_t)value] : (uint8_t)value;
+            uint8_t level = (uint8_t)((curved * brightnessFactor) >> 8);
+            _tables[LEVEL][value] = level;
+            for (uint8_t channel = 0; channel < 3; channel++) {
+                _tables[channel][value] = (uint8_t)((level * channelFactors[channel]) >> 8);
+            }
+        }
+    }
+
+    /**
+     * @brief Combines the color temperature and calibration of a channel.
+     * @return The factor, 0 to 256 (256 leaves the channel unchanged).
+     */
+    static uint16_t channelFactor(uint8_t temperature, uint8_t calibration) {
+        return (uint16_t)(((uint32_t)(temperature + 1) * (calibration + 1)) >> 8);
+    }
+
+    const GammaTable* _gamma;   ///< The gamma curve, or `nullptr` for a linear response.
+    uint8_t _brightness;        ///< The master brightness.
+    RgbColor _temperature;      ///< The white point.
+    RgbColor _calibration;      ///< The channel scale of the LED batch.
+    uint8_t _tables[4][256];    ///< Output tables for red, green, blue and single-color LEDs.
+};
+
+#endif // XDUINORAILS_COLOR_CORRECTION_H
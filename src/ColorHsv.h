@@ -0,0 +1,183 @@
+/**
+ * @file ColorHsv.h
+ * @brief Fixed-point HSV to RGB conversion for rainbows and gradients.
+ *
+ * The hue circle is split into six sectors of 256 steps. In each sector one channel
+ * is full, one is off and one ramps up or down, so converting a hue needs a shift,
+ * a lookup of the channel roles and no division. Saturation and value are applied
+ * like `Adafruit_NeoPixel::ColorHSV()`. The fill functions step the hue from pixel
+ * to pixel and apply saturation and value to the full and off channels once per
+ * call, so a pixel costs one scaled channel.
+ *
+ * The colors are linear; attach a ColorCorrection to the strip for gamma instead of
+ * calling `gamma32()` per pixel.
+ */
+#ifndef XDUINORAILS_COLOR_HSV_H
+#define XDUINORAILS_COLOR_HSV_H
+
+#include <stdint.h>
+#include "Led.h"
+
+/**
+ * @struct HsvColor
+ * @brief A color given by hue, saturation and value.
+ */
+struct HsvColor {
+    uint16_t hue;   ///< The hue, 0 to 65535 around the circle starting at red.
+    uint8_t sat;    ///< The saturation; 0 is white, 255 the pure hue.
+    uint8_t val;    ///< The value (brightness); 0 is black.
+};
+
+namespace ColorMath {
+
+/// Channel indices of the full, ramping and off channel in each sixth of the hue circle.
+static constexpr uint8_t kHueSectors[6][3] = {
+    {0, 1, 2},  // red to yellow: green rises
+    {1, 0, 2},  // yellow to green: red falls
+    {1, 2, 0},  // green to cyan: blue rises
+    {2, 1, 0},  // cyan to blue: green falls
+    {2, 0, 1},  // blue to magenta: red rises
+    {0, 2, 1},  // magenta to red: blue falls
+};
+
+/**
+ * @brief Applies saturation and value to a channel of the pure hue.
+ * @param level The channel of the pure hue at full value.
+ * @param sat The saturation.
+ * @param val The value.
+ * @return The output channel.
+ */
+inline uint8_t hsvLevel(uint8_t level, uint8_t sat, uint8_t val) {
+    uint16_t saturated = (uint16_t)((((uint16_t)level * ((uint16_t)sat + 1)) >> 8) + (255 - sat));
+    return (uint8_t)((saturated * ((uint16_t)val + 1)) >> 8);
+}
+
+/**
+ * @brief Writes the channels of a hue whose full and off channels are already known.
+ * @param pixel Receives the color.
+ * @param hue The hue.
+ * @param full The full channel after saturation and value, `hsvLevel(255, sat, val)`.
+ * @param off The off channel after saturation and value, `hsvLevel(0, sat, val)`.
+ * @param sat The saturation.
+ * @param val The value.
+ */
+inline void writeHue(RgbColor& pixel, uint16_t hue, uint8_t full, uint8_t off, uint8_t sat, uint8_t val) {
+    // 65536 hues onto 6 * 256 steps.
+    uint16_t position = (uint16_t)(((uint32_t)hue * 3) >> 7);
+    uint8_t sector = (uint8_t)(position >> 8);
+    uint8_t ramp = (sector & 1) ? (uint8_t)(255 - (uint8_t)position) : (uint8_t)position;
+    const uint8_t* roles = kHueSectors[sector];
+    uint8_t* channels = reinterpret_cast<uint8_t*>(&pixel);
+    channels[roles[0]] = full;
+    channels[roles[1]] = hsvLevel(ramp, sat, val);
+    channels[roles[2]] = off;
+}
+
+/**
+ * @brief Converts a color from HSV to RGB.
+ * @param hue The hue, 0 to 65535 around the circle starting at red.
+ * @param sat The saturation; 0 is white, 255 the pure hue.
+ * @param val The value; 0 is black.
+ * @return The RGB color.
+ */
+inline RgbColor hsv(uint16_t hue, uint8_t sat = 255, uint8_t val = 255) {
+    RgbColor color;
+    writeHue(color, hue, hsvLevel(255, sat, val), hsvLevel(0, sat, val), sat, val);
+    return color;
+}
+
+/**
+ * @brief Converts a color from HSV to RGB.
+ * @param color The HSV color.
+ * @return The RGB color.
+ */
+inline RgbColor hsv(const HsvColor& color) {
+    return hsv(color.hue, color.sat, color.val);
+}
+
+/**
+ * @brief Fills a buffer with hues that advance by a fixed step.
+ * @param colors The colors to write.
+ * @param count The number of colors.
+ * @param hueStart The hue of the first color.
+ * @param hueStep The hue difference between neighbors, e.g. `65536 / count` for one full circle.
+ * @param sat The saturation of all colors.
+ * @param val The value of all colors.
+ */
+inline void fillRainbow(RgbColor* colors, uint16_t count, uint16_t hueStart, uint16_t hueStep,
+                        uint8_t sat = 255, uint8_t val = 255) {
+    uint8_t full = hsvLevel(255, sat, val);
+    uint8_t off = hsvLevel(0, sat, val);
+    uint16_t hue = hueStart;
+    for (uint16_t i = 0; i < count; i++) {
+        writeHue(colors[i], hue, full, off, sat, val);
+        hue += hueStep;
+    }
+}
+
+} // namespace ColorMath
+
+/**
+ * @class HsvGradient
+ * @brief Steps linearly from one HSV color to another, one pixel at a time.
+ *
+ * Hue, saturation and value are kept as 16.16 fixed-point accumulators. The hue takes
+ * the shorter way around the circle.
+ */
+class HsvGradient {
+public:
+    /**
+     * @brief Constructor.
+     * @param from The color of the first pixel.
+     * @param to The color of the last pixel.
+     * @param count The number of pixels, including the first and the last.
+     */
+    HsvGradient(const HsvColor& from, const HsvColor& to, uint16_t count)
+        : _hue(((uint32_t)from.hue << 16) + kHalf), _sat(((uint32_t)from.sat << 16) + kHalf),
+          _val(((uint32_t)from.val << 16) + kHalf) {
+        int32_t steps = count > 1 ? count - 1 : 1;
+        _hueStep = (int32_t)(int16_t)(uint16_t)(to.hue - from.hue) * 65536 / steps;
+        _satStep = (int32_t)(to.sat - from.sat) * 65536 / steps;
+        _valStep = (int32_t)(to.val - from.val) * 65536 / steps;
+    }
+
+    /**
+     * @brief Gets the color of the next pixel.
+     * @return The RGB color.
+     */
+    RgbColor next() {
+        uint8_t sat = (uint8_t)(_sat >> 16);
+        uint8_t val = (uint8_t)(_val >> 16);
+        RgbColor color;
+        ColorMath::writeHue(color, (uint16_t)(_hue >> 16), ColorMath::hsvLevel(255, sat, val),
+                            ColorMath::hsvLevel(0, sat, val), sat, val);
+        _hue += (uint32_t)_hueStep;
+        _sat += (uint32_t)_satStep;
+        _val += (uint32_t)_valStep;
+        return color;
+    }
+
+    /**
+     * @brief Fills a buffer with the next colors.
+     * @param colors The colors to write.
+     * @param count The number of colors.
+     */
+    void fill(RgbColor* colors, uint16_t count) {
+        for (uint16_t i = 0; i < count; i++) {
+            colors[i] = next();
+        }
+    }
+
+private:
+    /// Offset of the accumulators, so that taking the integer part rounds to the nearest step.
+    static const uint32_t kHalf = 0x8000;
+
+    uint32_t _hue;      ///< The hue of the next pixel, 16.16 fixed point; wraps around.
+    uint32_t _sat;      ///< The saturation of the next pixel, 16.16 fixed point.
+    uint32_t _val;      ///< The value of the next pixel, 16.16 fixed point.
+    int32_t _hueStep;   ///< The hue difference between neighbors.
+    int32_t _satStep;   ///< The saturation difference between neighbors.
+    int32_t _valStep;   ///< The value difference between neighbors.
+};
+
+#endif // XDUINORAILS_COLOR_HSV_H
@@ -0,0 +1,216 @@
+/**
+ * @file ColorMath.h
+ * @brief Fixed-point kernels for scaling, adding and blending 8-bit color channels.
+ *
+ * Channels are scaled as `value * (scale + 1) / 256`, the formula of ScaleTable and
+ * the Adafruit NeoPixel library, which needs one multiplication and a shift instead
+ * of the 32-bit multiplication and division of Arduino's `map()`. The buffer kernels
+ * load four channels into a 32-bit word and process them together (SIMD within a
+ * register): two multiplications scale four channels, and saturating addition needs
+ * no multiplication at all. Pixel buffers of RgbColor are processed as plain bytes.
+ */
+#ifndef XDUINORAILS_COLOR_MATH_H
+#define XDUINORAILS_COLOR_MATH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "Led.h"
+
+static_assert(sizeof(RgbColor) == 3, "RgbColor buffers are processed as plain bytes");
+
+namespace ColorMath {
+
+/// Selects the even bytes of a word, leaving room for a 16-bit product per channel.
+static const uint32_t kEvenBytes = 0x00FF00FF;
+/// Selects the high bit of every byte.
+static const uint32_t kHighBits = 0x80808080;
+
+/**
+ * @brief Scales a channel value.
+ * @param value The value to scale.
+ * @param scale The scale factor; 255 leaves the value unchanged, 0 yields 0.
+ * @return `value * (scale + 1) / 256`.
+ */
+inline uint8_t scale8(uint8_t value, uint8_t scale) {
+    return (uint8_t)(((uint16_t)value * ((uint16_t)scale + 1)) >> 8);
+}
+
+/**
+ * @brief Scales a color.
+ * @param color The color to scale.
+ * @param scale The scale factor; 255 leaves the color unchanged.
+ * @return The scaled color.
+ */
+inline RgbColor scale8(const RgbColor& color, uint8_t scale) {
+    return {scale8(color.r, scale), scale8(color.g, scale), scale8(color.b, scale)};
+}
+
+/**
+ * @brief Adds two channel values, saturating at 255.
+ */
+inline uint8_t qadd8(uint8_t a, uint8_t b) {
+    uint16_t sum = (uint16_t)a + b;
+    return sum > 255 ? 255 : (uint8_t)sum;
+}
+
+/**
+ * @brief Interpolates between two channel values.
+ * @param a The value at amount 0.
+ * @param b The value approached as the amount grows.
+ * @param amount The weight of `b` in 1/256 steps.
+ * @return `(a * (256 - amount) + b * amount) / 256`.
+ */
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amount) {
+    return (uint8_t)(((uint16_t)a * (256 - amount) + (uint16_t)b * amount) >> 8);
+}
+
+/**
+ * @brief Scales the four channels of a word.
+ * @param word Four channel values.
+ * @param scale The scale factor; 255 leaves the values unchanged.
+ * @return The four scaled values, as `scale8()` computes them.
+ */
+inline uint32_t scale8x4(uint32_t word, uint8_t scale) {
+    uint32_t factor = (uint32_t)scale + 1;
+    // Each product is at most 255 * 256 and stays within its 16-bit lane.
+    uint32_t even = (((word & kEvenBytes) * factor) >> 8) & kEvenBytes;
+    uint32_t odd = ((word >> 8) & kEvenBytes) * factor & ~kEvenBytes;
+    return even | odd;
+}
+
+/**
+ * @brief Adds the four channels of two words, saturating each at 255.
+ */
+inline uint32_t qadd8x4(uint32_t a, uint32_t b) {
+    // Adding the low seven bits cannot carry into the next byte.
+    uint32_t sum = (a & ~kHighBits) + (b & ~kHighBits);
+    uint32_t overflow = ((a & b) | ((a ^ b) & sum)) & kHighBits;
+    sum ^= (a ^ b) & kHighBits;
+    return sum | (overflow >> 7) * 0xFF;
+}
+
+/**
+ * @brief Interpolates the four channels of two words.
+ * @return The four interpolated values, as `blend8()` computes them.
+ */
+inline uint32_t blend8x4(uint32_t a, uint32_t b, uint8_t amount) {
+    uint32_t weightA = 256 - (uint32_t)amount;
+    uint32_t weightB = amount;
+    // The weights add up to 256, so each sum is at most 255 * 256.
+    uint32_t even = (((a & kEvenBytes) * weightA + (b & kEvenBytes) * weightB) >> 8) & kEvenBytes;
+    uint32_t odd = (((a >> 8) & kEvenBytes) * weightA + ((b >> 8) & kEvenBytes) * weightB) & ~kEvenBytes;
+    return even | odd;
+}
+
+/**
+ * @brief Loads four bytes from any address.
+ */
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/**
+ * @brief Stores four bytes to any address.
+ */
+inline void store32(uint8_t* p, uint32_t word) {
+    memcpy(p, &word, sizeof(word));
+}
+
+/**
+ * @brief Scales a buffer of channel values in place.
+ * @param data The values.
+ * @param length The number of values.
+ * @param scale The scale factor; 255 leaves the values unchanged.
+ */
+inline void nscale8(uint8_t* data, size_t length, uint8_t scale) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        store32(data + i, scale8x4(load32(data + i), scale));
+    }
+    for (; i < length; i++) {
+        data[i] = scale8(data[i], scale);
+    }
+}
+
+/**
+ * @brief Scales a buffer of colors in place.
+ * @param colors The colors.
+ * @param count The number of colors.
+ * @param scale The scale factor; 255 leaves the colors unchanged.
+ */
+inline void nscale8(RgbColor* colors, uint16_t count, uint8_t scale) {
+    nscale8(reinterpret_cast<uint8_t*>(colors), (size_t)count * sizeof(RgbColor), scale);
+}
+
+/**
+ * @brief Dims a buffer of colors in place, e.g. for trails that fade out.
+ * @param colors The colors.
+ * @param count The number of colors.
+ * @param fadeBy The amount to dim by; 0 leaves the colors unchanged, 255 turns them black.
+ */
+inline void fadeToBlack(RgbColor* colors, uint16_t count, uint8_t fadeBy) {
+    nscale8(colors, count, (uint8_t)(255 - fadeBy));
+}
+
+/**
+ * @brief Adds a buffer of channel values to another, saturating each at 255.
+ * @param data The values to add to; updated.
+ * @param other The values to add.
+ * @param length The number of values.
+ */
+inline void qadd8(uint8_t* data, const uint8_t* other, size_t length) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        store32(data + i, qadd8x4(load32(data + i), load32(other + i)));
+    }
+    for (; i < length; i++) {
+        data[i] = qadd8(data[i], other[i]);
+    }
+}
+
+/**
+ * @brief Adds a buffer of colors to another, saturating each channel at 255.
+ * @param colors The colors to add to; updated.
+ * @param other The colors to add.
+ * @param count The number of colors.
+ */
+inline void qadd8(RgbColor* colors, const RgbColor* other, uint16_t count) {
+    qadd8(reinterpret_cast<uint8_t*>(colors), reinterpret_cast<const uint8_t*>(other),
+          (size_t)count * sizeof(RgbColor));
+}
+
+/**
+ * @brief Moves a buffer of channel values towards another.
+ * @param data The values at amount 0; updated.
+ * @param other The values approached as the amount grows.
+ * @param length The number of values.
+ * @param amount The weight of `other` in 1/256 steps.
+ */
+inline void blend8(uint8_t* data, const uint8_t* other, size_t length, uint8_t amount) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        store32(data + i, blend8x4(load32(data + i), load32(other + i), amount));
+    }
+    for (; i < length; i++) {
+        data[i] = blend8(data[i], other[i], amount);
+    }
+}
+
+/**
+ * @brief Moves a buffer of colors towards another, e.g. for cross-fades.
+ * @param colors The colors at amount 0; updated.
+ * @param other The colors approached as the amount grows.
+ * @param count The number of colors.
+ * @param amount The weight of `other` in 1/256 steps.
+ */
+inline void blend8(RgbColor* colors, const RgbColor* other, uint16_t count, uint8_t amount) {
+    blend8(reinterpret_cast<uint8_t*>(colors), reinterpret_cast<const uint8_t*>(other),
+           (size_t)count * sizeof(RgbColor), amount);
+}
+
+} // namespace ColorMath
+
+#endif // XDUINORAILS_COLOR_MATH_H
@@ -10,6 +10,9 @@
 #define XDUINORAILS_LED_H
 
 #include <stdint.h>
+#include "LedStats.h"
+
+class ColorCorrection;
 
 /**
  * @struct RgbColor
@@ -24,6 +27,20 @@ struct RgbColor {
     uint8_t b;  ///< Blue component (0-255).
 };
 
+/**
+ * @struct RgbColor16
+ * @brief Represents a color with 16 bits per component.
+ *
+ * Used by drivers that keep more precision than the 8 bits sent to the LEDs
+ * (@see LedNeoPixelDithered). Components are 8.8 fixed point: the value `c << 8`
+ * corresponds to the 8-bit value `c`, and the low byte adds fractional steps.
+ */
+struct RgbColor16 {
+    uint16_t r;  ///< Red component (0-65280 for full on).
+    uint16_t g;  ///< Green component (0-65280 for full on).
+    uint16_t b;  ///< Blue component (0-65280 for full on).
+};
+
 /**
  * @class Led
  * @brief Abstract base class for all LED drivers.
@@ -41,7 +58,7 @@ public:
      * @param indexInGroup An optional index within the group.
      */
     Led(uint8_t groupId = 0, uint16_t indexInGroup = 0)
-        : _groupId(groupId), _indexInGroup(indexInGroup), _brightness(255) {}
+        : _groupId(groupId), _indexInGroup(indexInGroup), _brightness(255), _correction(nullptr) {}
 
     /**
      * @brief Virtual destructor.
@@ -73,6 +90,36 @@ public:
      */
     virtual void setBrightness(uint8_t brightness) = 0;
 
+    /**
+     * @brief Opens a frame transaction.
+     * While a frame is open, drivers that normally push their data to the hardware
+     * after every change only update their internal buffers. The default does
+     * nothing, which is correct for drivers that write their outputs directly.
+     */
+    virtual void beginFrame() {}
+
+    /**
+     * @brief Closes a frame transaction.
+     * Drivers flush any output that was deferred since `beginFrame()`, at most once.
+     */
+    virtual void commitFrame() {}
+
+    /**
+     * @brief Sets the output correction (gamma, master brightness, color temperature).
+     * Drivers re-render their outputs with the new correction.
+     * @param correction The correction, or `nullptr` to output linear values. Must
+     *                   outlive the driver or be removed before it is destroyed.
+     */
+    virtual void setColorCorrection(const ColorCorrection* correction) {
+        _correction = correction;
+    }
+
+    /**
+     * @brief Gets the output correction.
+     * @return The correction, or `nullptr` if values are output linearly.
+     */
+    const ColorCorrection* getColorCorrection() const { return _correction; }
+
     /**
      * @brief Gets the group ID of the LED.
      * @return The group ID.
@@ -85,10 +132,28 @@ public:
      */
     uint16_t getIndexInGroup() const { return _indexInGroup; }
 
+#if XDUINORAILS_LED_STATS
+    /**
+     * @brief Gets the instrumentation counters of this driver.
+     * Only available when `XDUINORAILS_LED_STATS` is enabled (@see LedStats.h).
+     * @return The counters since construction or the last `resetStats()`.
+     */
+    const LedStats& getStats() const { return _stats; }
+
+    /**
+     * @brief Clears the instrumentation counters of this driver.
+     */
+    void resetStats() { _stats = LedStats(); }
+#endif
+
 protected:
     uint8_t _groupId;         ///< Identifier for grouping LEDs.
     uint16_t _indexInGroup;   ///< Index of this LED within its group.
     uint8_t _brightness;      ///< Current brightness level (0-255).
+    const ColorCorrection* _correction; ///< Output correction, or `nullptr` for linear output.
+#if XDUINORAILS_LED_STATS
+    LedStats _stats;    ///< Instrumentation counters.
+#endif
 };
 
 #endif // XDUINORAILS_LED_H
@@ -0,0 +1,97 @@
+/**
+ * @file LedArena.h
+ * @brief Fixed-capacity bump allocator for heap-free driver construction.
+ *
+ * This file provides a minimal arena that hands out memory from a caller-provided
+ * buffer. Memory is never returned individually; the whole arena is released
+ * together with its buffer. Drivers that own pin or pixel buffers offer a
+ * constructor taking a LedArena so they can be placed without using the heap.
+ */
+#ifndef XDUINORAILS_LED_ARENA_H
+#define XDUINORAILS_LED_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class LedArena
+ * @brief Bump allocator over a fixed block of memory.
+ *
+ * Allocations are served in order from the start of the buffer, honoring the
+ * requested alignment. When the buffer is exhausted, `allocate()` returns
+ * `nullptr` and the arena is left unchanged.
+ */
+class LedArena {
+public:
+    /**
+     * @brief Constructor for the arena.
+     * @param buffer The memory block to allocate from. Must outlive the arena.
+     * @param capacity The size of the memory block in bytes.
+     */
+    LedArena(uint8_t* buffer, size_t capacity)
+        : _buffer(buffer), _capacity(capacity), _used(0) {}
+
+    /**
+     * @brief Allocates a block of memory from the arena.
+     * @param size The number of bytes to allocate.
+     * @param alignment The required alignment in bytes. Must be a power of two.
+     * @return A pointer to the allocated block, or `nullptr` if the arena is full.
+     */
+    void* allocate(size_t size, size_t alignment = 1) {
+        size_t offset = alignedOffset(alignment);
+        if (offset > _capacity || size > _capacity - offset) {
+            return nullptr;
+        }
+        _used = offset + size;
+        return _buffer + offset;
+    }
+
+    /**
+     * @brief Allocates an uninitialized array of `count` elements of type `T`.
+     * @param count The number of elements.
+     * @return A pointer to the first element, or `nullptr` if the arena is full.
+     */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief Checks whether an allocation would succeed without performing it.
+     * @param size The number of bytes.
+     * @param alignment The required alignment in bytes.
+     * @return True if `allocate(size, alignment)` would return a valid pointer.
+     */
+    bool canAllocate(size_t size, size_t alignment = 1) const {
+        size_t offset = alignedOffset(alignment);
+        return offset <= _capacity && size <= _capacity - offset;
+    }
+
+    /**
+     * @brief Gets the number of bytes used so far, including alignment padding.
+     * @return The number of bytes used.
+     */
+    size_t used() const { return _used; }
+
+    /**
+     * @brief Gets the total size of the arena.
+     * @return The capacity in bytes.
+     */
+    size_t capacity() const { return _capacity; }
+
+private:
+    /**
+     * @brief Computes the offset of the next allocation for the given alignment.
+     */
+    size_t alignedOffset(size_t alignment) const {
+        uintptr_t address = reinterpret_cast<uintptr_t>(_buffer) + _used;
+        uintptr_t aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        return _used + (aligned - address);
+    }
+
+    uint8_t* _buffer;   ///< The memory block allocations are served from.
+    size_t _capacity;   ///< The size of the memory block in bytes.
+    size_t _used;       ///< The number of bytes handed out so far.
+};
+
+#endif // XDUINORAILS_LED_ARENA_H
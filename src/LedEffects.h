@@ -0,0 +1,480 @@
+/**
+ * @file LedEffects.h
+ * @brief Non-blocking animations advanced by a single `tick()` call per loop iteration.
+ *
+ * Animations written with `delay()` block the loop, so a multiplexed matrix stops
+ * refreshing and DCC packets are missed while they run. An LedEffect instead computes
+ * one step when its deadline has passed and tells the engine when it needs the next
+ * one. The EffectEngine keeps a list of effects and calls only those that are due,
+ * within a configurable time budget per tick; effects that do not fit into the budget
+ * are updated first on the next tick.
+ *
+ * @code
+ * EffectEngine effects(&ledHal);
+ * BreatheEffect breathe(*ledHal.getLed(0), {255, 180, 60}, 3000);
+ *
+ * void setup() {
+ *   effects.add(breathe, millis());
+ * }
+ *
+ * void loop() {
+ *   effects.tick(millis());
+ *   matrix->show();   // Still called every iteration
+ * }
+ * @endcode
+ */
+#ifndef XDUINORAILS_LED_EFFECTS_H
+#define XDUINORAILS_LED_EFFECTS_H
+
+#include <Arduino.h>
+#include "xDuinoRails_LED-Drivers.h"
+#include "LedStrip.h"
+#include "ColorHsv.h"
+#include "ColorMath.h"
+
+/**
+ * @class LedEffect
+ * @brief Base class of an animation of one LED driver or one group of a HAL.
+ *
+ * Subclasses implement `update()`, which renders the state at a point in time and
+ * returns the number of milliseconds until the next step. Effects are owned by the
+ * caller and linked into an EffectEngine without any allocation.
+ */
+class LedEffect {
+public:
+    /// Returned by `update()` when the effect has finished; the engine then removes it.
+    static const uint32_t kDone = 0xFFFFFFFF;
+
+    /**
+     * @brief Constructs an effect that animates one driver.
+     * @param led The driver to animate.
+     */
+    explicit LedEffect(Led& led)
+        : _led(&led), _hal(nullptr), _groupId(0), _start(0), _due(0), _next(nullptr), _running(false) {}
+
+    /**
+     * @brief Constructs an effect that animates all drivers of a group.
+     * @param hal The HAL that owns the group.
+     * @param groupId The ID of the group.
+     */
+    LedEffect(LedDriverHAL& hal, uint8_t groupId)
+        : _led(nullptr), _hal(&hal), _groupId(groupId), _start(0), _due(0), _next(nullptr), _running(false) {}
+
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~LedEffect() {}
+
+    LedEffect(const LedEffect&) = delete;
+    LedEffect& operator=(const LedEffect&) = delete;
+
+    /**
+     * @brief Renders the effect.
+     * @param elapsed The milliseconds since the effect was started.
+     * @return The milliseconds until the next update, or `kDone` if the effect has finished.
+     */
+    virtual uint32_t update(uint32_t elapsed) = 0;
+
+    /**
+     * @brief Checks whether the effect is attached to an engine.
+     * @return True until the effect is removed or has finished.
+     */
+    bool isRunning() const {
+        return _running;
+    }
+
+protected:
+    /**
+     * @brief Sets the color of the target driver or of all drivers of the target group.
+     * @param color The color to set.
+     */
+    void setColor(const RgbColor& color) {
+        if (_hal) {
+            _hal->setGroupColor(_groupId, color);
+        } else {
+            _led->setColor(color);
+        }
+    }
+
+private:
+    friend class EffectEngine;
+
+    Led* _led;              ///< The target driver, or `nullptr` for a group.
+    LedDriverHAL* _hal;     ///< The HAL of the target group, or `nullptr` for a single driver.
+    uint8_t _groupId;       ///< The target group.
+    uint32_t _start;        ///< `millis()` time at which the effect was started.
+    uint32_t _due;          ///< `millis()` time of the next update.
+    LedEffect* _next;       ///< The next effect of the engine.
+    bool _running;          ///< True while the effect is attached to an engine.
+};
+
+/**
+ * @class EffectEngine
+ * @brief Schedules LedEffects by deadline within a time budget per tick.
+ *
+ * Call `tick()` once per loop iteration. It updates every effect whose deadline has
+ * passed, so an iteration without due effects costs one comparison per effect. With a
+ * budget set, the engine stops once the budget is used up and continues with the next
+ * due effect on the following tick, so no effect starves. All changes of one tick are
+ * wrapped in a frame transaction of the HAL, if one is given, so each strip is sent at
+ * most once per tick. Sending the strips at the end of the tick counts against the
+ * budget; its time is taken from the previous tick.
+ */
+class EffectEngine {
+public:
+    /// Returned by `tick()` when no effect is attached.
+    static const uint32_t kIdle = 0xFFFFFFFF;
+
+    /**
+     * @brief Constructor.
+     * @param hal The HAL whose frame transaction brackets each tick, or `nullptr`.
+     */
+    explicit EffectEngine(LedDriverHAL* hal = nullptr)
+        : _hal(hal), _first(nullptr), _resume(nullptr), _count(0), _budgetMicros(0), _flushMicros(0), _deferred(0) {}
+
+    /**
+     * @brief Attaches and starts an effect; it is first updated on the next tick.
+     * An effect that is already running is restarted.
+     * @param effect The effect. Must stay valid until it is removed or has finished.
+     * @param now The current `millis()` time.
+     */
+    void add(LedEffect& effect, uint32_t now) {
+        if (!effect._running) {
+            effect._next = _first;
+            _first = &effect;
+            effect._running = true;
+            _count++;
+        }
+        effect._start = now;
+        effect._due = now;
+    }
+
+    /**
+     * @brief Detaches an effect. The LEDs keep their last state.
+     * @param effect The effect.
+     */
+    void remove(LedEffect& effect) {
+        for (LedEffect** link = &_first; *link; link = &(*link)->_next) {
+            if (*link == &effect) {
+                *link = effect._next;
+                _count--;
+                break;
+            }
+        }
+        if (_resume == &effect) {
+            _resume = nullptr;
+        }
+        effect._next = nullptr;
+        effect._running = false;
+    }
+
+    /**
+     * @brief Limits the time spent in `tick()`.
+     * The budget covers the effect updates and the transmission of the changed strips
+     * when the frame is committed, as measured on the previous tick. At least one due
+     * effect is updated per tick, whatever the budget, so a tick whose transmission
+     * alone takes longer than the budget still exceeds it.
+     * @param micros The budget in microseconds, or 0 for no limit.
+     */
+    void setBudget(uint32_t micros) {
+        _budgetMicros = micros;
+    }
+
+    /**
+     * @brief Updates the effects whose deadline has passed.
+     * @param now The current `millis()` time.
+     * @return The milliseconds until the next deadline, 0 if updates were deferred, or
+     *         `kIdle` if no effect is attached.
+     */
+    uint32_t tick(uint32_t now) {
+        if (!_first) {
+            return kIdle;
+        }
+        uint32_t began = _budgetMicros ? micros() : 0;
+        bool updated = false;
+        // Start where the previous tick ran out of budget, then wrap around.
+        LedEffect* effect = _resume ? _resume : _first;
+        _resume = nullptr;
+        for (uint16_t remaining = _count; remaining > 0; remaining--) {
+            LedEffect* next = effect->_next ? effect->_next : _first;
+            if ((int32_t)(now - effect->_due) >= 0) {
+                if (_resume || (updated && _budgetMicros && micros() - began + _flushMicros >= _budgetMicros)) {
+                    // Out of budget: the rest waits for the next tick.
+                    if (!_resume) {
+                        _resume = effect;
+                    }
+                    _deferred++;
+                } else {
+                    if (!updated && _hal) {
+                        _hal->beginFrame();
+                    }
+                    updated = true;
+                    uint32_t interval = effect->update(now - effect->_start);
+                    if (interval == LedEffect::kDone) {
+                        remove(*effect);
+                    } else {
+                        schedule(*effect, now, interval);
+                    }
+                }
+            }
+            effect = next;
+        }
+        if (updated && _hal) {
+            uint32_t flushBegan = _budgetMicros ? micros() : 0;
+            _hal->commitFrame();
+            if (_budgetMicros) {
+                _flushMicros = micros() - flushBegan;
+            }
+        }
+        return _resume ? 0 : untilNextDeadline(now);
+    }
+
+    /**
+     * @brief Gets the number of effect updates that were postponed to a later tick.
+     * @return The count since construction.
+     */
+    uint32_t getDeferredCount() const {
+        return _deferred;
+    }
+
+private:
+    /**
+     * @brief Sets the next deadline of an effect, without drift while the engine keeps up.
+     */
+    static void schedule(LedEffect& effect, uint32_t now, uint32_t interval) {
+        uint32_t due = effect._due + interval;
+        // After falling behind by a whole interval, skip the missed steps.
+        effect._due = ((int32_t)(now - due) >= 0) ? now + interval : due;
+    }
+
+    /**
+     * @brief Gets the time until the earliest deadline.
+     */
+    uint32_t untilNextDeadline(uint32_t now) const {
+        uint32_t earliest = kIdle;
+        for (LedEffect* e = _first; e; e = e->_next) {
+            int32_t remaining = (int32_t)(e->_due - now);
+            uint32_t wait = remaining > 0 ? (uint32_t)remaining : 0;
+            if (wait < earliest) {
+                earliest = wait;
+            }
+        }
+        return earliest;
+    }
+
+    LedDriverHAL* _hal;         ///< The HAL whose frame brackets each tick, or `nullptr`.
+    LedEffect* _first;          ///< The attached effects, most recently added first.
+    LedEffect* _resume;         ///< The effect to start the next tick with, or `nullptr`.
+    uint16_t _count;            ///< The number of attached effects.
+    uint32_t _budgetMicros;     ///< The time budget per tick, or 0 for no limit.
+    uint32_t _flushMicros;      ///< The time the last frame commit took, reserved from the budget.
+    uint32_t _deferred;         ///< The number of postponed updates.
+};
+
+/**
+ * @class BlinkEffect
+ * @brief Switches between a color and black.
+ */
+class BlinkEffect : public LedEffect {
+public:
+    /**
+     * @brief Constructs a blink of one driver.
+     * @param led The driver to animate.
+     * @param color The color while on.
+     * @param onMs The time on.
+     * @param offMs The time off. If both times are 0, the off time is 1.
+     */
+    BlinkEffect(Led& led, const RgbColor& color, uint32_t onMs, uint32_t offMs)
+        : LedEffect(led), _color(color), _onMs(onMs), _offMs(onMs || offMs ? offMs : 1), _on(false) {}
+
+    /**
+     * @brief Constructs a blink of a group.
+     * @param hal The HAL that owns the group.
+     * @param groupId The ID of the group.
+     * @param color The color while on.
+     * @param onMs The time on.
+     * @param offMs The time off. If both times are 0, the off time is 1.
+     */
+    BlinkEffect(LedDriverHAL& hal, uint8_t groupId, const RgbColor& color, uint32_t onMs, uint32_t offMs)
+        : LedEffect(hal, groupId), _color(color), _onMs(onMs), _offMs(onMs || offMs ? offMs : 1), _on(false) {}
+
+    uint32_t update(uint32_t elapsed) override {
+        bool on = elapsed % (_onMs + _offMs) < _onMs;
+        if (on != _on || elapsed == 0) {
+            _on = on;
+            setColor(on ? _color : RgbColor{0, 0, 0});
+        }
+        uint32_t phase = elapsed % (_onMs + _offMs);
+        return on ? _onMs - phase : _onMs + _offMs - phase;
+    }
+
+private:
+    RgbColor _color;    ///< The color while on.
+    uint32_t _onMs;     ///< The time on.
+    uint32_t _offMs;    ///< The time off.
+    bool _on;           ///< The last state set.
+};
+
+/**
+ * @class FadeEffect
+ * @brief Cross-fades from one color to another once, then finishes.
+ */
+class FadeEffect : public LedEffect {
+public:
+    /**
+     * @brief Constructs a fade of one driver.
+     * @param led The driver to animate.
+     * @param from The color at the start.
+     * @param to The color at the end.
+     * @param durationMs The length of the fade.
+     * @param stepMs The time between two steps.
+     */
+    FadeEffect(Led& led, const RgbColor& from, const RgbColor& to, uint32_t durationMs, uint16_t stepMs = 20)
+        : LedEffect(led), _from(from), _to(to), _durationMs(durationMs), _stepMs(stepMs) {}
+
+    /**
+     * @brief Constructs a fade of a group.
+     * @param hal The HAL that owns the group.
+     * @param groupId The ID of the group.
+     * @param from The color at the start.
+     * @param to The color at the end.
+     * @param durationMs The length of the fade.
+     * @param stepMs The time between two steps.
+     */
+    FadeEffect(LedDriverHAL& hal, uint8_t groupId, const RgbColor& from, const RgbColor& to, uint32_t durationMs,
+               uint16_t stepMs = 20)
+        : LedEffect(hal, groupId), _from(from), _to(to), _durationMs(durationMs), _stepMs(stepMs) {}
+
+    uint32_t update(uint32_t elapsed) override {
+        if (elapsed >= _durationMs) {
+            setColor(_to);
+            return kDone;
+        }
+        uint8_t amount = (uint8_t)(((uint64_t)elapsed << 8) / _durationMs);
+        setColor({ColorMath::blend8(_from.r, _to.r, amount), ColorMath::blend8(_from.g, _to.g, amount),
+                  ColorMath::blend8(_from.b, _to.b, amount)});
+        return _stepMs;
+    }
+
+private:
+    RgbColor _from;         ///< The color at the start.
+    RgbColor _to;           ///< The color at the end.
+    uint32_t _durationMs;   ///< The length of the fade.
+    uint16_t _stepMs;       ///< The time between two steps.
+};
+
+/**
+ * @class BreatheEffect
+ * @brief Fades a color in and out continuously.
+ */
+class BreatheEffect : public LedEffect {
+public:
+    /**
+     * @brief Constructs a breathing driver.
+     * @param led The driver to animate.
+     * @param color The color at the peak.
+     * @param periodMs The time of one full in-and-out cycle, at least 1.
+     * @param stepMs The time between two steps.
+     */
+    BreatheEffect(Led& led, const RgbColor& color, uint32_t periodMs, uint16_t stepMs = 20)
+        : LedEffect(led), _color(color), _periodMs(periodMs ? periodMs : 1), _stepMs(stepMs) {}
+
+    /**
+     * @brief Constructs a breathing group.
+     * @param hal The HAL that owns the group.
+     * @param groupId The ID of the group.
+     * @param color The color at the peak.
+     * @param periodMs The time of one full in-and-out cycle, at least 1.
+     * @param stepMs The time between two steps.
+     */
+    BreatheEffect(LedDriverHAL& hal, uint8_t groupId, const RgbColor& color, uint32_t periodMs, uint16_t stepMs = 20)
+        : LedEffect(hal, groupId), _color(color), _periodMs(periodMs ? periodMs : 1), _stepMs(stepMs) {}
+
+    uint32_t update(uint32_t elapsed) override {
+        // Triangle wave: 0 to 510 over one period, folded at 255.
+        uint16_t phase = (uint16_t)(((uint64_t)(elapsed % _periodMs) * 510) / _periodMs);
+        uint8_t level = phase > 255 ? (uint8_t)(510 - phase) : (uint8_t)phase;
+        setColor(ColorMath::scale8(_color, level));
+        return _stepMs;
+    }
+
+private:
+    RgbColor _color;        ///< The color at the peak.
+    uint32_t _periodMs;     ///< The time of one cycle.
+    uint16_t _stepMs;       ///< The time between two steps.
+};
+
+/**
+ * @class ColorCycleEffect
+ * @brief Steps through a list of colors, holding each for a fixed time.
+ */
+class ColorCycleEffect : public LedEffect {
+public:
+    /**
+     * @brief Constructs a color cycle of one driver.
+     * @param led The driver to animate.
+     * @param colors The colors. The array is not copied and must outlive the effect.
+     * @param count The number of colors. With none, the effect finishes at once.
+     * @param holdMs The time each color is shown, at least 1.
+     */
+    ColorCycleEffect(Led& led, const RgbColor* colors, uint8_t count, uint32_t holdMs)
+        : LedEffect(led), _colors(colors), _count(count), _holdMs(holdMs ? holdMs : 1) {}
+
+    /**
+     * @brief Constructs a color cycle of a group.
+     * @param hal The HAL that owns the group.
+     * @param groupId The ID of the group.
+     * @param colors The colors. The array is not copied and must outlive the effect.
+     * @param count The number of colors. With none, the effect finishes at once.
+     * @param holdMs The time each color is shown, at least 1.
+     */
+    ColorCycleEffect(LedDriverHAL& hal, uint8_t groupId, const RgbColor* colors, uint8_t count, uint32_t holdMs)
+        : LedEffect(hal, groupId), _colors(colors), _count(count), _holdMs(holdMs ? holdMs : 1) {}
+
+    uint32_t update(uint32_t elapsed) override {
+        if (!_count) {
+            return kDone;
+        }
+        uint32_t step = elapsed / _holdMs;
+        setColor(_colors[step % _count]);
+        return (step + 1) * _holdMs - elapsed;
+    }
+
+private:
+    const RgbColor* _colors;    ///< The colors.
+    uint8_t _count;             ///< The number of colors.
+    uint32_t _holdMs;           ///< The time each color is shown.
+};
+
+/**
+ * @class RainbowEffect
+ * @brief Scrolls a rainbow along a strip.
+ */
+class RainbowEffect : public LedEffect {
+public:
+    /**
+     * @brief Constructor.
+     * @param strip The strip to animate.
+     * @param hueStep The hue difference between neighboring pixels, e.g. `65536 / numPixels()`.
+     * @param cycleMs The time in which the rainbow scrolls through all hues once, at least 1.
+     * @param stepMs The time between two frames.
+     */
+    RainbowEffect(LedStrip& strip, uint16_t hueStep, uint32_t cycleMs, uint16_t stepMs = 20)
+        : LedEffect(strip), _strip(strip), _hueStep(hueStep), _cycleMs(cycleMs ? cycleMs : 1), _stepMs(stepMs) {}
+
+    uint32_t update(uint32_t elapsed) override {
+        uint16_t hue = (uint16_t)(((uint64_t)(elapsed % _cycleMs) << 16) / _cycleMs);
+        _strip.fillRainbow(0, _strip.numPixels(), hue, _hueStep);
+        // Sent at the end of the engine's frame, together with other changes to the strip.
+        _strip.requestShow();
+        return _stepMs;
+    }
+
+private:
+    LedStrip& _strip;       ///< The strip to animate.
+    uint16_t _hueStep;      ///< The hue difference between neighboring pixels.
+    uint32_t _cycleMs;      ///< The time of one hue cycle.
+    uint16_t _stepMs;       ///< The time between two frames.
+};
+
+#endif // XDUINORAILS_LED_EFFECTS_H
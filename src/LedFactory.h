@@ -0,0 +1,177 @@
+/**
+ * @file LedFactory.h
+ * @brief Driver construction shared by the HAL implementations.
+ *
+ * This file maps a LedType and the `addLeds()` parameters to the matching concrete
+ * driver. Where the driver and its buffers are placed is decided by a builder:
+ * LedHeapBuilder allocates them with `new`, LedArenaBuilder places them in a
+ * fixed-size LedArena.
+ */
+#ifndef XDUINORAILS_LED_FACTORY_H
+#define XDUINORAILS_LED_FACTORY_H
+
+#include <new>
+#include <utility>
+#include "xDuinoRails_LED-Drivers.h"
+#include "LedArena.h"
+#include "LedHAL_Single.h"
+#include "LedHAL_Multi.h"
+#include "LedHAL_Rgb.h"
+#include "LedHAL_NeoPixel.h"
+#include "LedHAL_Ws2811_3x1.h"
+#include "LedHAL_CharliePlex.h"
+#include "LedHAL_Matrix.h"
+#include "LedHAL_ParallelStrip.h"
+#include "LedHAL_NeoPixelDithered.h"
+
+/**
+ * @class LedHeapBuilder
+ * @brief Builder that allocates drivers and their buffers on the heap.
+ */
+class LedHeapBuilder {
+public:
+    /**
+     * @brief Creates a driver that has no buffers of its own.
+     * @param args The driver's constructor arguments.
+     * @return A pointer to the new driver.
+     */
+    template <typename T, typename... Args>
+    Led* create(Args&&... args) {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Creates a driver that allocates buffers in its constructor.
+     * @param storageSize The number of buffer bytes the driver will allocate (unused).
+     * @param args The driver's constructor arguments.
+     * @return A pointer to the new driver.
+     */
+    template <typename T, typename... Args>
+    Led* createWithStorage(size_t storageSize, Args&&... args) {
+        (void)storageSize;
+        return new T(std::forward<Args>(args)...);
+    }
+};
+
+/**
+ * @class LedArenaBuilder
+ * @brief Builder that places drivers and their buffers in a LedArena.
+ *
+ * The space needed for the driver object and its buffers is checked before anything
+ * is allocated, so a failed creation leaves the arena unchanged.
+ */
+class LedArenaBuilder {
+public:
+    /**
+     * @brief Constructor for the builder.
+     * @param arena The arena to allocate from.
+     */
+    explicit LedArenaBuilder(LedArena& arena) : _arena(arena) {}
+
+    /**
+     * @brief Creates a driver that has no buffers of its own.
+     * @param args The driver's constructor arguments.
+     * @return A pointer to the new driver, or `nullptr` if the arena is full.
+     */
+    template <typename T, typename... Args>
+    Led* create(Args&&... args) {
+        void* memory = _arena.allocate(sizeof(T), alignof(T));
+        if (!memory) {
+            return nullptr;
+        }
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Creates a driver whose buffers are taken from the arena as well.
+     * @param storageSize The number of buffer bytes the driver will allocate.
+     * @param args The driver's constructor arguments, without the leading arena.
+     * @return A pointer to the new driver, or `nullptr` if the arena is full.
+     */
+    template <typename T, typename... Args>
+    Led* createWithStorage(size_t storageSize, Args&&... args) {
+        // Driver buffers are byte-aligned and follow the object directly.
+        if (!_arena.canAllocate(sizeof(T) + storageSize, alignof(T))) {
+            return nullptr;
+        }
+        void* memory = _arena.allocate(sizeof(T), alignof(T));
+        return new (memory) T(_arena, std::forward<Args>(args)...);
+    }
+
+private:
+    LedArena& _arena;   ///< The arena drivers are placed in.
+};
+
+/**
+ * @brief Creates the driver for a LedType through the given builder.
+ *
+ * @param builder The builder that decides where the driver is placed.
+ * @param type The type of LED driver to create (@see LedType).
+ * @param pins An array of pin numbers. The required pins vary by driver.
+ * @param pinCount The number of elements in the `pins` array.
+ * @param numLeds The number of LEDs for strip or matrix drivers.
+ * @param groupId An ID for grouping LEDs for simultaneous control.
+ * @param indexInGroup The index of the new LED within its group.
+ * @return A pointer to the new Led object, or `nullptr` if the parameters are invalid
+ *         for the requested type or the builder could not place the driver.
+ */
+template <typename Builder>
+Led* createLed(Builder& builder, LedType type, const uint8_t* pins, uint8_t pinCount, uint16_t numLeds, uint8_t groupId, uint16_t indexInGroup) {
+    switch (type) {
+        case SINGLE_LED:
+            if (pinCount >= 1) {
+                return builder.template create<LedSingle>(pins[0], groupId, indexInGroup);
+            }
+            break;
+        case MULTI_LED:
+            if (pinCount > 1) {
+                return builder.template createWithStorage<LedMulti>(LedMulti::storageSize(pinCount), pins, pinCount, groupId, indexInGroup);
+            }
+            break;
+        case RGB_LED:
+            if (pinCount >= 3) {
+                return builder.template create<LedRgb>(pins[0], pins[1], pins[2], groupId, indexInGroup);
+            }
+            break;
+        case NEOPIXEL:
+            if (pinCount >= 1 && numLeds > 0) {
+                return builder.template createWithStorage<LedNeoPixel>(LedNeoPixel::storageSize(numLeds), pins[0], numLeds, groupId, indexInGroup);
+            }
+            break;
+        case WS2811_3x1:
+            if (pinCount >= 1 && numLeds > 0) {
+                return builder.template createWithStorage<LedWs2811_3x1>(LedWs2811_3x1::storageSize(numLeds), pins[0], numLeds, groupId, indexInGroup);
+            }
+            break;
+        case CHARLIEPLEX:
+            if (pinCount > 1) {
+                return builder.template createWithStorage<LedCharliePlex>(LedCharliePlex::storageSize(pinCount), pins, pinCount, groupId, indexInGroup);
+            }
+            break;
+        case MATRIX:
+            if (numLeds > 0 && pinCount >= numLeds) {
+                uint8_t rowCount = numLeds;
+                uint8_t colCount = pinCount - rowCount;
+                if (colCount > 0) {
+                    const uint8_t* rowPins = pins;
+                    const uint8_t* colPins = pins + rowCount;
+                    return builder.template createWithStorage<LedMatrix>(LedMatrix::storageSize(rowCount, colCount),
+                                                                         rowPins, rowCount, colPins, colCount, groupId, indexInGroup);
+                }
+            }
+            break;
+        case PARALLEL_NEOPIXEL:
+            if (pinCount >= 1 && pinCount <= LedParallelStrip::kMaxLanes && numLeds > 0 && (uint32_t)pinCount * numLeds <= 0xFFFF) {
+                return builder.template createWithStorage<LedParallelStrip>(LedParallelStrip::storageSize(pinCount, numLeds), pins, pinCount, numLeds, groupId, indexInGroup);
+            }
+            break;
+        case NEOPIXEL_DITHERED:
+            if (pinCount >= 1 && numLeds > 0) {
+                return builder.template createWithStorage<LedNeoPixelDithered>(LedNeoPixelDithered::storageSize(numLeds), pins[0], numLeds, groupId, indexInGroup);
+            }
+            break;
+    }
+    return nullptr;
+}
+
+#endif // XDUINORAILS_LED_FACTORY_H
@@ -11,7 +11,32 @@
 #define XDUINORAILS_LED_DRIVERS_CHARLIEPLEX_H
 
 #include "LedStrip.h"
+#include "ColorCorrection.h"
+#include "LedArena.h"
+#include "PovRefresh.h"
 #include <Arduino.h>
+#include <string.h>
+
+/**
+ * @def XDUINORAILS_CHARLIEPLEX_PORT_IO
+ * @brief Set to 1 to drive charlieplex pins through cached port registers.
+ *
+ * Enabled automatically on the AVR and SAMD cores, which provide the AVR-style port
+ * macros (`digitalPinToPort()`, `digitalPinToBitMask()`, `portOutputRegister()`,
+ * `portModeRegister()`). The pins are updated by read-modify-write with interrupts
+ * disabled, which is only safe on a single core. Other cores that define the macros,
+ * such as the dual-core RP2040, use `pinMode()` and `digitalWrite()`; define it as 1
+ * before including the library to use the registers anyway, or as 0 to force the
+ * portable path.
+ */
+#ifndef XDUINORAILS_CHARLIEPLEX_PORT_IO
+#if (defined(__AVR__) || defined(ARDUINO_ARCH_SAMD)) && defined(digitalPinToPort) && defined(digitalPinToBitMask) && \
+    defined(portOutputRegister) && defined(portModeRegister)
+#define XDUINORAILS_CHARLIEPLEX_PORT_IO 1
+#else
+#define XDUINORAILS_CHARLIEPLEX_PORT_IO 0
+#endif
+#endif
 
 /**
  * @class LedCharliePlex
@@ -22,9 +47,35 @@
  * are on simultaneously. The `show()` method must be called continuously in a loop
  * for the display to work correctly. Brightness is simulated by adjusting the
  * duration each LED is turned on.
+ *
+ * The anode and cathode of every LED are looked up in a table built at construction,
+ * and stepping from one LED to the next only releases the previous pair and drives
+ * the new one, so each step costs the same whatever the number of pins. With
+ * `XDUINORAILS_CHARLIEPLEX_PORT_IO`, pins are switched with read-modify-write register
+ * accesses instead of calls into the Arduino core.
+ *
+ * In `SCAN_ROW` mode, each step drives one anode and sinks the cathodes of all its lit
+ * LEDs at once, so a frame takes `pinCount` steps instead of one per lit LED and each
+ * LED stays on up to `pinCount - 1` times longer. The anode pin sources the current of
+ * the whole row; `setMaxLedsPerStep()` splits rows to keep it within the pin's rating.
+ *
+ * When scanned in the background by a PovRefresh, each LED (or each row) gets one step
+ * of the refresh and the brightness sets the part of the step it stays lit. In
+ * `SCAN_ROW` mode, rows are then split by position into steps of at most
+ * `setMaxLedsPerStep()` LEDs. The brightness and scan settings are committed together
+ * with the colors by `show()`, so they change at a frame boundary.
  */
-class LedCharliePlex : public LedStrip {
+class LedCharliePlex : public LedStrip, public PovScanner {
 public:
+    /**
+     * @enum ScanMode
+     * @brief How LEDs are multiplexed during `show()`.
+     */
+    enum ScanMode {
+        SCAN_LED, ///< One LED at a time.
+        SCAN_ROW  ///< All lit LEDs sharing an anode at a time.
+    };
+
     /**
      * @brief Constructor for the LedCharliePlex driver.
      * @param pins A pointer to an array of Arduino pin numbers used for the matrix.
@@ -33,24 +84,37 @@ public:
      * @param indexInGroup An optional index within the group.
      */
     LedCharliePlex(const uint8_t* pins, uint8_t pinCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
-        : LedStrip(groupId, indexInGroup), _pinCount(pinCount), _numLeds(pinCount * (pinCount - 1)) {
-        _pins = new uint8_t[pinCount];
-        for (uint8_t i = 0; i < pinCount; i++) {
-            _pins[i] = pins[i];
-        }
-        _ledColors = new RgbColor[_numLeds];
-        for (uint16_t i = 0; i < _numLeds; i++) {
-            _ledColors[i] = {0, 0, 0};
-        }
-        off();
-    }
+        : LedCharliePlex(new uint8_t[storageSize(pinCount)], true, pins, pinCount, groupId, indexInGroup) {}
+
+    /**
+     * @brief Constructor that places the pin, color and pair buffers in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(pinCount)` bytes available.
+     * @param pins A pointer to an array of Arduino pin numbers used for the matrix.
+     * @param pinCount The number of pins in the array.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedCharliePlex(LedArena& arena, const uint8_t* pins, uint8_t pinCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedCharliePlex(static_cast<uint8_t*>(arena.allocate(storageSize(pinCount), kStorageAlignment)), false, pins,
+                         pinCount, groupId, indexInGroup) {}
 
     /**
      * @brief Destructor that cleans up dynamically allocated memory.
      */
     ~LedCharliePlex() override {
-        delete[] _pins;
-        delete[] _ledColors;
+        if (_ownsStorage) {
+            delete[] _storage;
+        }
+    }
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * @param pinCount The number of pins.
+     * @return The storage size in bytes.
+     */
+    static size_t storageSize(uint8_t pinCount) {
+        size_t numLeds = (size_t)pinCount * (pinCount - 1);
+        return portsSize(pinCount) + pinCount + numLeds * sizeof(RgbColor) + numLeds * 2;
     }
 
     /**
@@ -58,20 +122,23 @@ public:
      */
     void on() override {
         setColor({255, 255, 255});
-        show();
     }
 
     /**
      * @brief Turns all LEDs off.
      */
     void off() override {
-        for (uint8_t i = 0; i < _pinCount; i++) {
-            pinMode(_pins[i], INPUT);
+        // While scanned in the background, the pins belong to the scan until the next commit.
+        if (!isBackgroundScanned()) {
+            for (uint8_t i = 0; i < _pinCount; i++) {
+                pinMode(_pins[i], INPUT);
+            }
+            LED_STATS_GPIO(_pinCount);
         }
         for (uint16_t i = 0; i < _numLeds; i++) {
             _ledColors[i] = {0, 0, 0};
         }
-        show();
+        requestShow();
     }
 
     /**
@@ -82,7 +149,7 @@ public:
         for (uint16_t i = 0; i < _numLeds; i++) {
             _ledColors[i] = color;
         }
-        show();
+        requestShow();
     }
 
     /**
@@ -97,6 +164,65 @@ public:
         }
     }
 
+    /**
+     * @brief Gets the color of a single LED.
+     * @param pixelIndex The index of the LED.
+     * @return The stored color, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < _numLeds) {
+            return _ledColors[pixelIndex];
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Gets the number of addressable LEDs, `pinCount * (pinCount - 1)`.
+     * @return The number of LEDs.
+     */
+    uint16_t numPixels() const override {
+        return _numLeds;
+    }
+
+    /**
+     * @brief Sets the colors of a range of LEDs from an array.
+     * @param start The index of the first LED to set.
+     * @param colors The colors to set, one per LED.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        memcpy(_ledColors + start, colors, (size_t)(end - start) * sizeof(RgbColor));
+    }
+
+    /**
+     * @brief Sets a range of LEDs to one color.
+     * @param start The index of the first LED to set.
+     * @param count The number of LEDs to set.
+     * @param color The color to set.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        for (uint16_t i = start; i < end; i++) {
+            _ledColors[i] = color;
+        }
+    }
+
+    /**
+     * @brief Gets direct access to a range of the color buffer.
+     * Changes are picked up by the next scan.
+     * @param start The index of the first LED.
+     * @param count The number of LEDs. Clamped to the number of LEDs.
+     * @return The span of stored colors.
+     */
+    LedSpan<RgbColor> getPixelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        return {_ledColors + start, (uint16_t)(end - start)};
+    }
+
     /**
      * @brief Sets the overall brightness for the matrix.
      * @param brightness The brightness level (0-255).
@@ -105,72 +231,364 @@ public:
         LedStrip::setBrightness(brightness);
     }
 
+    /**
+     * @brief Sets how LEDs are multiplexed.
+     * While scanned in the background, the mode applies from the next committed frame.
+     * @param mode `SCAN_LED` (the default) or `SCAN_ROW`.
+     */
+    void setScanMode(ScanMode mode) {
+        _scanMode = mode;
+    }
+
+    /**
+     * @brief Gets how LEDs are multiplexed.
+     * @return The scan mode.
+     */
+    ScanMode getScanMode() const {
+        return _scanMode;
+    }
+
+    /**
+     * @brief Limits the number of LEDs lit at once in `SCAN_ROW` mode.
+     * All of them draw their current through the same anode pin, so choose the limit as
+     * the pin's safe current divided by the current of one LED. Rows with more lit LEDs
+     * are lit in several steps. While scanned in the background, the limit applies from
+     * the next committed frame.
+     * @param maxLeds The maximum number of LEDs per step; 0 for no limit (the default).
+     */
+    void setMaxLedsPerStep(uint8_t maxLeds) {
+        _maxLedsPerStep = maxLeds;
+    }
+
+    /**
+     * @brief Gets the limit set with `setMaxLedsPerStep()`.
+     * @return The maximum number of LEDs per step, or 0 for no limit.
+     */
+    uint8_t getMaxLedsPerStep() const {
+        return _maxLedsPerStep;
+    }
+
     /**
      * @brief Refreshes the display. Call this method in a loop.
      * This method iterates through all the LEDs, quickly lighting each one that is
-     * not off. The `_brightness` member controls the `delayMicroseconds` duration,
-     * creating a dimming effect.
+     * not off, either one by one or row by row depending on the scan mode. The
+     * `_brightness` member, passed through the output correction, controls the
+     * `delayMicroseconds` duration of each step, creating a dimming effect.
      */
     void show() override {
+        if (isBackgroundScanned()) {
+            commitScanFrame();
+            return;
+        }
+        LED_STATS_SCAN();
+        uint8_t level = _correction ? _correction->level(_brightness) : _brightness;
+        if (_scanMode == SCAN_ROW) {
+            showRows(level);
+            return;
+        }
+        const uint8_t* lit = nullptr;
         for (uint16_t i = 0; i < _numLeds; i++) {
             const auto& color = _ledColors[i];
             // For single-color charlieplexing, we just care if it's on or off.
-            if (color.r > 0 || color.g > 0 || color.b > 0) {
-                lightLed(i);
+            if (isLit(color)) {
+                // All other pins are already high-impedance; only the previous pair is released.
+                if (lit) {
+                    releasePin(lit[1]);
+                    releasePin(lit[0]);
+                }
+                lit = &_pairs[2 * i];
+                drivePin(lit[0], HIGH);
+                drivePin(lit[1], LOW);
                 // Adjust delay based on brightness to control perceived intensity
-                delayMicroseconds(_brightness * 10);
+                delayMicroseconds(level * 10);
             }
         }
-        // Set all pins to INPUT to turn off all LEDs after the cycle
-        for (uint8_t i = 0; i < _pinCount; i++) {
-            pinMode(_pins[i], INPUT);
+        // Turn the last LED off after the cycle
+        if (lit) {
+            releasePin(lit[1]);
+            releasePin(lit[0]);
         }
     }
 
+    /**
+     * @brief Gets the size of the color buffer.
+     * @return `numPixels() * 3` bytes.
+     */
+    size_t scanFrameBytes() const override {
+        return (size_t)_numLeds * sizeof(RgbColor);
+    }
+
+    /**
+     * @brief Gets the number of background scan steps.
+     * @return One step per LED, or in `SCAN_ROW` mode one per row and group of
+     *         `getMaxLedsPerStep()` LEDs.
+     */
+    uint16_t scanStepCount() const override {
+        if (_scanMode == SCAN_ROW) {
+            return (uint16_t)_pinCount * rowChunks(_maxLedsPerStep);
+        }
+        return _numLeds;
+    }
+
+protected:
+    const uint8_t* scanSource() const override {
+        return reinterpret_cast<const uint8_t*>(_ledColors);
+    }
+
+    void prepareScanFrame() override {
+        _committed.mode = _scanMode;
+        _committed.maxLedsPerStep = _maxLedsPerStep;
+        _committed.level = _correction ? _correction->level(_brightness) : _brightness;
+    }
+
+    void takeScanFrame() override {
+        _scan = _committed;
+    }
+
+    uint8_t scanStep(const uint8_t* frame, uint16_t step) override {
+        LED_STATS_SCAN();
+        scanBlank();
+        if (_scan.level == 0) {
+            return 0;
+        }
+        const RgbColor* colors = reinterpret_cast<const RgbColor*>(frame);
+        uint8_t rowLength = _pinCount - 1;
+        uint8_t anode;
+        uint8_t first;
+        uint8_t count;
+        if (_scan.mode == SCAN_ROW) {
+            uint8_t chunks = rowChunks(_scan.maxLedsPerStep);
+            uint8_t limit = (uint8_t)((rowLength + chunks - 1) / chunks);
+            anode = (uint8_t)(step / chunks);
+            first = (uint8_t)((step % chunks) * limit);
+            count = (uint8_t)(rowLength - first < limit ? rowLength - first : limit);
+        } else {
+            anode = (uint8_t)(step / rowLength);
+            first = (uint8_t)(step % rowLength);
+            count = 1;
+        }
+        const uint16_t rowStart = (uint16_t)anode * rowLength;
+        for (uint8_t k = first; k < first + count; k++) {
+            if (isLit(colors[rowStart + k])) {
+                if (!_scanCount) {
+                    drivePin(anode, HIGH);
+                    _scanAnode = anode;
+                    _scanFirst = k;
+                }
+                drivePin(_pairs[2 * (rowStart + k) + 1], LOW);
+                _scanCount = (uint8_t)(k - _scanFirst + 1);
+            }
+        }
+        return _scanCount ? _scan.level : 0;
+    }
+
+    void scanBlank() override {
+        if (!_scanCount) {
+            return;
+        }
+        // Releasing an undriven cathode is harmless and saves remembering which were lit.
+        const uint16_t rowStart = (uint16_t)_scanAnode * (_pinCount - 1);
+        for (uint8_t k = _scanFirst; k < _scanFirst + _scanCount; k++) {
+            releasePin(_pairs[2 * (rowStart + k) + 1]);
+        }
+        releasePin(_scanAnode);
+        _scanCount = 0;
+    }
+
 private:
+#if XDUINORAILS_CHARLIEPLEX_PORT_IO
+    // The port is a number on AVR but a `PortGroup*` on SAMD, so none of the types are spelled out.
+    typedef decltype(digitalPinToPort(0)) PortId;
+    typedef decltype(portOutputRegister(digitalPinToPort(0))) PortRegister;
+    typedef decltype(digitalPinToBitMask(0)) PortMask;
+
     /**
-     * @brief Configures pins to light a single specified LED.
-     * It determines the correct anode and cathode pins for the given `ledIndex`,
-     * sets all other pins to high-impedance (INPUT), and drives the anode HIGH
-     * and the cathode LOW.
-     * @param ledIndex The index of the single LED to illuminate.
-     */
-    void lightLed(uint16_t ledIndex) {
-        uint8_t anodePinIndex = 0;
-        uint8_t cathodePinIndex = 0;
-        uint16_t currentIndex = 0;
-
-        // Set all pins to high-impedance state first
-        for (uint8_t i = 0; i < _pinCount; i++) {
-            pinMode(_pins[i], INPUT);
-        }
-
-        // Find the anode/cathode pair for the requested LED index
-        for (uint8_t i = 0; i < _pinCount; i++) {
-            for (uint8_t j = 0; j < _pinCount; j++) {
-                if (i == j) continue; // Skip same-pin pairs
-
-                if (currentIndex == ledIndex) {
-                    anodePinIndex = i;
-                    cathodePinIndex = j;
-
-                    // Drive the anode HIGH
-                    pinMode(_pins[anodePinIndex], OUTPUT);
-                    digitalWrite(_pins[anodePinIndex], HIGH);
-                    // Drive the cathode LOW
-                    pinMode(_pins[cathodePinIndex], OUTPUT);
-                    digitalWrite(_pins[cathodePinIndex], LOW);
-                    return; // Exit once the correct LED is lit
+     * @struct PinPort
+     * @brief The registers and bit of one pin, looked up once at construction.
+     */
+    struct PinPort {
+        PortRegister output;    ///< The output (level) register.
+        PortRegister mode;      ///< The direction register.
+        PortMask mask;          ///< The bit of the pin in both registers.
+    };
+
+    /// Alignment of the storage block, whose port table comes first.
+    static const size_t kStorageAlignment = alignof(PinPort);
+#else
+    /// Alignment of the storage block.
+    static const size_t kStorageAlignment = 1;
+#endif
+
+    /**
+     * @brief Gets the size of the port table at the start of the storage block.
+     */
+    static size_t portsSize(uint8_t pinCount) {
+#if XDUINORAILS_CHARLIEPLEX_PORT_IO
+        return (size_t)pinCount * sizeof(PinPort);
+#else
+        (void)pinCount;
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Common constructor taking one block of storage for the port table, pins, colors and pairs.
+     */
+    LedCharliePlex(uint8_t* storage, bool ownsStorage, const uint8_t* pins, uint8_t pinCount, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _storage(storage), _pins(storage + portsSize(pinCount)), _pinCount(pinCount),
+          _numLeds(pinCount * (pinCount - 1)), _ledColors(reinterpret_cast<RgbColor*>(_pins + pinCount)),
+          _pairs(reinterpret_cast<uint8_t*>(_ledColors + _numLeds)), _ownsStorage(ownsStorage) {
+        for (uint8_t i = 0; i < pinCount; i++) {
+            _pins[i] = pins[i];
+        }
+#if XDUINORAILS_CHARLIEPLEX_PORT_IO
+        PinPort* ports = reinterpret_cast<PinPort*>(storage);
+        for (uint8_t i = 0; i < pinCount; i++) {
+            PortId port = digitalPinToPort(pins[i]);
+            ports[i] = {portOutputRegister(port), portModeRegister(port), digitalPinToBitMask(pins[i])};
+        }
+#endif
+        // LED index order: for each anode, every other pin as cathode.
+        uint8_t* pair = _pairs;
+        for (uint8_t anode = 0; anode < pinCount; anode++) {
+            for (uint8_t cathode = 0; cathode < pinCount; cathode++) {
+                if (anode != cathode) {
+                    *pair++ = anode;
+                    *pair++ = cathode;
                 }
-                currentIndex++;
             }
         }
+        for (uint16_t i = 0; i < _numLeds; i++) {
+            _ledColors[i] = {0, 0, 0};
+        }
+        off();
     }
 
+    /**
+     * @brief Checks whether an LED is on. Single-color LEDs are on if any channel is set.
+     */
+    static bool isLit(const RgbColor& color) {
+        return color.r > 0 || color.g > 0 || color.b > 0;
+    }
+
+    /**
+     * @brief Gets the number of background scan steps per row in `SCAN_ROW` mode.
+     * @param maxLeds The maximum number of LEDs per step, 0 for no limit.
+     */
+    uint8_t rowChunks(uint8_t maxLeds) const {
+        uint8_t rowLength = _pinCount - 1;
+        if (maxLeds == 0 || maxLeds >= rowLength) {
+            return 1;
+        }
+        return (uint8_t)((rowLength + maxLeds - 1) / maxLeds);
+    }
+
+    /**
+     * @brief Scans row by row: one anode at a time with the cathodes of all its lit LEDs.
+     * @param level The on-time level of each step.
+     */
+    void showRows(uint8_t level) {
+        uint8_t rowLength = _pinCount - 1;
+        uint8_t limit = (_maxLedsPerStep == 0 || _maxLedsPerStep > rowLength) ? rowLength : _maxLedsPerStep;
+        // The LEDs of one anode are stored next to each other, in cathode order.
+        for (uint8_t anode = 0; anode < _pinCount; anode++) {
+            const uint16_t rowStart = (uint16_t)anode * rowLength;
+            uint8_t next = 0;
+            bool anodeDriven = false;
+            while (next < rowLength) {
+                uint8_t sinking = 0;
+                uint8_t i = next;
+                for (; i < rowLength && sinking < limit; i++) {
+                    if (isLit(_ledColors[rowStart + i])) {
+                        if (!anodeDriven) {
+                            drivePin(anode, HIGH);
+                            anodeDriven = true;
+                        }
+                        drivePin(_pairs[2 * (rowStart + i) + 1], LOW);
+                        sinking++;
+                    }
+                }
+                if (sinking > 0) {
+                    delayMicroseconds(level * 10);
+                    for (uint8_t k = next; k < i; k++) {
+                        if (isLit(_ledColors[rowStart + k])) {
+                            releasePin(_pairs[2 * (rowStart + k) + 1]);
+                        }
+                    }
+                }
+                next = i;
+            }
+            if (anodeDriven) {
+                releasePin(anode);
+            }
+        }
+    }
+
+    /**
+     * @brief Drives a pin as an output.
+     * @param pin The index of the pin.
+     * @param level HIGH for an anode, LOW for a cathode.
+     */
+    void drivePin(uint8_t pin, uint8_t level) {
+#if XDUINORAILS_CHARLIEPLEX_PORT_IO
+        const PinPort& port = reinterpret_cast<const PinPort*>(_storage)[pin];
+        // The registers are shared with other pins, so the updates must not be interrupted.
+        noInterrupts();
+        if (level == HIGH) {
+            *port.output |= port.mask;
+        } else {
+            *port.output &= (PortMask)~port.mask;
+        }
+        *port.mode |= port.mask;
+        interrupts();
+#else
+        pinMode(_pins[pin], OUTPUT);
+        digitalWrite(_pins[pin], level);
+#endif
+        LED_STATS_GPIO(2);
+    }
+
+    /**
+     * @brief Returns a pin to high-impedance.
+     * @param pin The index of the pin.
+     */
+    void releasePin(uint8_t pin) {
+#if XDUINORAILS_CHARLIEPLEX_PORT_IO
+        const PinPort& port = reinterpret_cast<const PinPort*>(_storage)[pin];
+        noInterrupts();
+        *port.mode &= (PortMask)~port.mask;
+        *port.output &= (PortMask)~port.mask;   // No pull-up on a released anode
+        interrupts();
+#else
+        pinMode(_pins[pin], INPUT);
+#endif
+        LED_STATS_GPIO(1);
+    }
+
+    /**
+     * @struct ScanSettings
+     * @brief The settings a background scan frame is committed with.
+     */
+    struct ScanSettings {
+        ScanMode mode;              ///< How LEDs are multiplexed.
+        uint8_t maxLedsPerStep;     ///< The maximum number of LEDs per step in `SCAN_ROW` mode, 0 for no limit.
+        uint8_t level;              ///< The corrected brightness, used as the duty of each step.
+    };
+
+    uint8_t* _storage;      ///< The storage block: port table (with port I/O), pins, colors, pairs.
     uint8_t* _pins;         ///< Pointer to the array of GPIO pins.
     uint8_t _pinCount;      ///< The number of pins used for the matrix.
     uint16_t _numLeds;      ///< The total number of addressable LEDs.
     RgbColor* _ledColors;   ///< Pointer to the array storing the color of each LED.
+    uint8_t* _pairs;        ///< Anode and cathode pin index of each LED.
+    bool _ownsStorage;      ///< True if the buffers were allocated with `new[]` and must be freed.
+    ScanMode _scanMode = SCAN_LED;  ///< How LEDs are multiplexed.
+    uint8_t _maxLedsPerStep = 0;    ///< The maximum number of LEDs per step in `SCAN_ROW` mode, 0 for no limit.
+    uint8_t _scanAnode = 0;         ///< The anode driven by the background scan.
+    uint8_t _scanFirst = 0;         ///< The first row position whose cathode the background scan drives.
+    uint8_t _scanCount = 0;         ///< The number of row positions from `_scanFirst` to release, 0 if dark.
+    ScanSettings _committed = {SCAN_LED, 0, 0}; ///< Settings staged with the committed frame.
+    ScanSettings _scan = {SCAN_LED, 0, 0};      ///< Settings of the frame being scanned.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_CHARLIEPLEX_H
@@ -11,6 +11,10 @@
 #define XDUINORAILS_LED_DRIVERS_MATRIX_H
 
 #include "LedStrip.h"
+#include "ColorCorrection.h"
+#include "ColorMath.h"
+#include "LedArena.h"
+#include "PovRefresh.h"
 #include <Arduino.h>
 #include <string.h>
 
@@ -22,9 +26,17 @@
  * The `show()` method drives the display by activating one row at a time and
  * setting the brightness of each LED in that row using `analogWrite` on the
  * column pins. For the matrix to be visible, `show()` must be called
- * continuously.
+ * continuously, unless the matrix is scanned in the background by a PovRefresh.
+ *
+ * With bit angle modulation enabled, the columns are switched with `digitalWrite`
+ * instead. The levels are converted into one column mask per row and bit, with
+ * brightness and correction applied, whenever they changed. Each row is then lit once
+ * per bit for a time slot proportional to the bit's weight, and only columns whose
+ * state differs from the previous slot are written. When scanned in the background,
+ * each row and bit is one step of the refresh, weighted by the bit's significance, so
+ * a frame at full scale is as bright as with column PWM.
  */
-class LedMatrix : public LedStrip {
+class LedMatrix : public LedStrip, public PovScanner {
 public:
     /**
      * @brief Constructor for the LedMatrix driver.
@@ -36,33 +48,40 @@ public:
      * @param indexInGroup An optional index within the group.
      */
     LedMatrix(const uint8_t* rowPins, uint8_t rowCount, const uint8_t* colPins, uint8_t colCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
-        : LedStrip(groupId, indexInGroup), _rows(rowCount), _cols(colCount), _rowPins(nullptr), _colPins(nullptr), _buffer(nullptr), _currentRow(0) {
+        : LedMatrix(new uint8_t[storageSize(rowCount, colCount)], true, rowPins, rowCount, colPins, colCount, groupId, indexInGroup) {}
 
-        _rowPins = new uint8_t[_rows];
-        _colPins = new uint8_t[_cols];
-        memcpy(_rowPins, rowPins, _rows * sizeof(uint8_t));
-        memcpy(_colPins, colPins, _cols * sizeof(uint8_t));
-
-        _buffer = new uint8_t[_rows * _cols];
-        memset(_buffer, 0, _rows * _cols * sizeof(uint8_t));
+    /**
+     * @brief Constructor that places the pin arrays and buffer in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(rowCount, colCount)` bytes available.
+     * @param rowPins A pointer to an array of pins connected to the matrix rows.
+     * @param rowCount The number of rows.
+     * @param colPins A pointer to an array of pins connected to the matrix columns.
+     * @param colCount The number of columns.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedMatrix(LedArena& arena, const uint8_t* rowPins, uint8_t rowCount, const uint8_t* colPins, uint8_t colCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedMatrix(arena.allocateArray<uint8_t>(storageSize(rowCount, colCount)), false, rowPins, rowCount, colPins, colCount, groupId, indexInGroup) {}
 
-        for (uint8_t i = 0; i < _rows; i++) {
-            pinMode(_rowPins[i], OUTPUT);
-            digitalWrite(_rowPins[i], HIGH); // Deactivate all rows
-        }
-        for (uint8_t i = 0; i < _cols; i++) {
-            pinMode(_colPins[i], OUTPUT);
-            digitalWrite(_colPins[i], LOW); // Set all columns off
+    /**
+     * @brief Destructor that cleans up dynamically allocated memory.
+     */
+    ~LedMatrix() {
+        if (_ownsStorage) {
+            delete[] _rowPins; // Start of the shared storage block
         }
     }
 
     /**
-     * @brief Destructor that cleans up dynamically allocated memory.
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * The row pins, column pins, pixel buffer and bit planes share one contiguous block.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @return The storage size in bytes.
      */
-    ~LedMatrix() {
-        delete[] _rowPins;
-        delete[] _colPins;
-        delete[] _buffer;
+    static size_t storageSize(uint8_t rowCount, uint8_t colCount) {
+        size_t maskBytes = ((size_t)colCount + 7) / 8;
+        return rowCount + colCount + (size_t)rowCount * colCount + ((size_t)rowCount * kMaxBamBits + 1) * maskBytes;
     }
 
     /**
@@ -70,6 +89,7 @@ public:
      */
     void on() override {
         memset(_buffer, _brightness, _rows * _cols * sizeof(uint8_t));
+        _planesDirty = true;
     }
 
     /**
@@ -77,6 +97,11 @@ public:
      */
     void off() override {
         memset(_buffer, 0, _rows * _cols * sizeof(uint8_t));
+        _planesDirty = true;
+        // While scanned in the background, the pins belong to the scan until the next commit.
+        if (isBackgroundScanned()) {
+            return;
+        }
         // Explicitly turn off hardware to prevent ghosting
         for (uint8_t i = 0; i < _rows; i++) {
             digitalWrite(_rowPins[i], HIGH);
@@ -84,6 +109,10 @@ public:
         for (uint8_t i = 0; i < _cols; i++) {
             digitalWrite(_colPins[i], LOW);
         }
+        memset(_columnState, 0, _maskBytes);
+        _columnsKnown = true;
+        _rowActive = false;
+        LED_STATS_GPIO(_rows + _cols);
     }
 
     /**
@@ -109,6 +138,7 @@ public:
     void setColor(uint8_t col, uint8_t row, const RgbColor& color) {
         if (row < _rows && col < _cols) {
             _buffer[row * _cols + col] = (color.r + color.g + color.b) / 3;
+            _planesDirty = true;
         }
     }
 
@@ -120,7 +150,74 @@ public:
     void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
         if (pixelIndex < _rows * _cols) {
             _buffer[pixelIndex] = (color.r + color.g + color.b) / 3;
+            _planesDirty = true;
+        }
+    }
+
+    /**
+     * @brief Gets the brightness of a single LED by its linear index.
+     * @param pixelIndex The linear index of the pixel (row * _cols + col).
+     * @return The brightness in all three channels, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < _rows * _cols) {
+            uint8_t level = _buffer[pixelIndex];
+            return {level, level, level};
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Gets the number of LEDs in the matrix, `rows * cols`.
+     * @return The number of LEDs.
+     */
+    uint16_t numPixels() const override {
+        return _rows * _cols;
+    }
+
+    /**
+     * @brief Sets the brightness of a range of LEDs from the luminance of an array of colors.
+     * @param start The linear index of the first LED to set.
+     * @param colors The colors to use, one per LED.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            const RgbColor& color = colors[i - start];
+            _buffer[i] = (color.r + color.g + color.b) / 3;
         }
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Sets a range of LEDs to the luminance of one color.
+     * @param start The linear index of the first LED to set.
+     * @param count The number of LEDs to set.
+     * @param color The color to use.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        memset(_buffer + start, (color.r + color.g + color.b) / 3, end - start);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Gets direct access to a range of the brightness buffer, in row-major order.
+     * This driver stores one level per LED, so `getPixelSpan()` returns an empty span.
+     * Changes are picked up by the next scan. With bit angle modulation, the bit planes
+     * are rebuilt on the next scan after each call.
+     * @param start The linear index of the first LED.
+     * @param count The number of LEDs. Clamped to the number of LEDs.
+     * @return The span of stored levels.
+     */
+    LedSpan<uint8_t> getLevelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        _planesDirty = true;
+        return {_buffer + start, (uint16_t)(end - start)};
     }
 
     /**
@@ -129,41 +226,306 @@ public:
      */
     void setBrightness(uint8_t brightness) override {
         LedStrip::setBrightness(brightness);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Sets the correction applied to the levels on output.
+     * @param correction The correction, or `nullptr` for linear output.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        LedStrip::setColorCorrection(correction);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Switches between column PWM and bit angle modulation.
+     * With `bits` set, each `show()` lights the next row for `(2^bits - 1)` slots of
+     * `slotMicros`, e.g. 1020 µs at 8 bits and 4 µs, and then turns it off again.
+     * While scanned in the background, the depth applies from the next committed frame,
+     * and the slots divide the frame period instead: the least significant one lasts
+     * `1 / (rows * (2^bits - 1))` of it, e.g. 4.9 µs for 8 rows at 8 bits and 100 Hz.
+     * Choose the depth so that this exceeds the time a step takes.
+     * @param bits The grayscale depth, 1 to 8, or 0 for `analogWrite` on the columns (the default).
+     * @param slotMicros The on-time of the least significant bit.
+     */
+    void setBitAngleModulation(uint8_t bits, uint16_t slotMicros = 4) {
+        _bamBits = bits > kMaxBamBits ? kMaxBamBits : bits;
+        _bamSlotMicros = slotMicros ? slotMicros : 1;
+        _planesDirty = true;
+        if (!isBackgroundScanned()) {
+            _columnsKnown = false;
+        }
+    }
+
+    /**
+     * @brief Gets the grayscale depth of bit angle modulation.
+     * @return The number of bits, or 0 if the columns are driven with `analogWrite`.
+     */
+    uint8_t getBitAngleModulation() const {
+        return _bamBits;
     }
 
     /**
      * @brief Refreshes the display by scanning one row. Call this in a loop.
      * Deactivates the previous row, advances to the next row, sets the column
      * PWM values for that row from the buffer, and then activates the current row.
+     * While the matrix is scanned by a PovRefresh, commits the buffer as the next frame instead.
      */
     void show() override {
-        // Deactivate the currently active row
+        if (isBackgroundScanned()) {
+            commitScanFrame();
+            return;
+        }
+        uint8_t row = _currentRow + 1;
+        row = row < _rows ? row : 0;
+        if (_bamBits) {
+            showBamRow(row);
+        } else {
+            scanRow(_buffer, row, _brightness, _correction);
+        }
+    }
+
+    /**
+     * @brief Gets the size of a background scan frame: the brightness buffer followed by
+     * the bit planes built from it.
+     * @return `rows * cols` bytes plus `kMaxBamBits` column masks per row.
+     */
+    size_t scanFrameBytes() const override {
+        return (size_t)_rows * _cols + (size_t)_rows * kMaxBamBits * _maskBytes;
+    }
+
+    /**
+     * @brief Gets the number of background scan steps.
+     * @return One step per row, or with bit angle modulation one per row and bit.
+     */
+    uint16_t scanStepCount() const override {
+        return _bamBits ? (uint16_t)_rows * _bamBits : _rows;
+    }
+
+protected:
+    const uint8_t* scanSource() const override {
+        // The bit planes follow the brightness buffer in the storage block.
+        return _buffer;
+    }
+
+    void prepareScanFrame() override {
+        if (_bamBits && _planesDirty) {
+            buildPlanes();
+        }
+        _committed.bits = _bamBits;
+        _committed.brightness = _brightness;
+        _committed.correction = _correction;
+    }
+
+    void takeScanFrame() override {
+        _scan = _committed;
+    }
+
+    uint8_t scanStep(const uint8_t* frame, uint16_t step) override {
+        if (!_scan.bits) {
+            scanRow(frame, (uint8_t)step, _scan.brightness, _scan.correction);
+            // Brightness is applied through the column PWM, so the row stays on for the whole step.
+            return 255;
+        }
+        LED_STATS_SCAN();
+        uint8_t row = (uint8_t)(step / _scan.bits);
+        uint8_t bit = (uint8_t)(_scan.bits - 1 - step % _scan.bits);
+        if (row != _currentRow) {
+            setRowActive(false);
+            _currentRow = row;
+        }
+        // The planes were built when the frame was committed.
+        writeColumns(frame + (size_t)_rows * _cols + planeOffset(row, bit));
+        setRowActive(true);
+        // The bit's weight is the length of the step, so the row stays on for all of it.
+        return 255;
+    }
+
+    uint16_t scanStepWeight(uint16_t step) const override {
+        if (!_scan.bits) {
+            return 1;
+        }
+        return (uint16_t)(1 << (_scan.bits - 1 - step % _scan.bits));
+    }
+
+    void scanBlank() override {
+        if (_scan.bits) {
+            setRowActive(false);
+            return;
+        }
         digitalWrite(_rowPins[_currentRow], HIGH);
+        LED_STATS_GPIO(1);
+    }
+
+private:
+    /// The largest grayscale depth of bit angle modulation.
+    static const uint8_t kMaxBamBits = 8;
+
+    /**
+     * @struct ScanSettings
+     * @brief The settings a background scan frame is committed with.
+     */
+    struct ScanSettings {
+        uint8_t bits;                           ///< Grayscale depth of bit angle modulation, 0 for column PWM.
+        uint8_t brightness;                     ///< The brightness applied through the column PWM.
+        const ColorCorrection* correction;      ///< The correction applied through the column PWM, or `nullptr`.
+    };
+
+    /**
+     * @brief Lights one row with bit angle modulation, most significant bit first.
+     * @param row The row to light.
+     */
+    void showBamRow(uint8_t row) {
+        LED_STATS_SCAN();
+        if (_planesDirty) {
+            buildPlanes();
+        }
+        setRowActive(false);
+        _currentRow = row;
+        for (int8_t bit = _bamBits - 1; bit >= 0; bit--) {
+            writeColumns(_planes + planeOffset(row, (uint8_t)bit));
+            setRowActive(true);
+            delayMicroseconds((unsigned int)_bamSlotMicros << bit);
+        }
+        // The last slot ends here, not at the next call, so that its weight is exact.
+        setRowActive(false);
+    }
+
+    /**
+     * @brief Gets the offset of the column mask of a row for one bit of the level in the bit planes.
+     */
+    size_t planeOffset(uint8_t row, uint8_t bit) const {
+        return ((size_t)row * kMaxBamBits + bit) * _maskBytes;
+    }
+
+    /**
+     * @brief Converts the brightness buffer into column masks, with brightness and correction applied.
+     */
+    void buildPlanes() {
+        _planesDirty = false;
+        memset(_planes, 0, (size_t)_rows * kMaxBamBits * _maskBytes);
+        uint8_t shift = kMaxBamBits - _bamBits;
+        for (uint8_t row = 0; row < _rows; row++) {
+            for (uint8_t c = 0; c < _cols; c++) {
+                uint8_t level = _buffer[row * _cols + c];
+                if (_correction) {
+                    level = _correction->level(level);
+                }
+                uint8_t value = ColorMath::scale8(level, _brightness) >> shift;
+                uint8_t mask = (uint8_t)(1 << (c & 7));
+                for (uint8_t bit = 0; value; bit++, value >>= 1) {
+                    if (value & 1) {
+                        _planes[planeOffset(row, bit) + (c >> 3)] |= mask;
+                    }
+                }
+            }
+        }
+    }
 
-        // Move to the next row
-        _currentRow++;
-        if (_currentRow >= _rows) {
-            _currentRow = 0;
+    /**
+     * @brief Drives the columns from a mask, writing only those that change.
+     * @param mask One bit per column, set for HIGH.
+     */
+    void writeColumns(const uint8_t* mask) {
+        for (uint8_t i = 0; i < _maskBytes; i++) {
+            uint8_t changed = _columnsKnown ? (uint8_t)(mask[i] ^ _columnState[i]) : 0xFF;
+            for (uint8_t c = i * 8; changed && c < _cols; c++, changed >>= 1) {
+                if (changed & 1) {
+                    digitalWrite(_colPins[c], (mask[i] >> (c & 7)) & 1 ? HIGH : LOW);
+                    LED_STATS_GPIO(1);
+                }
+            }
+            _columnState[i] = mask[i];
         }
+        _columnsKnown = true;
+    }
+
+    /**
+     * @brief Activates or deactivates the current row, if it is not already in that state.
+     */
+    void setRowActive(bool active) {
+        if (active != _rowActive) {
+            digitalWrite(_rowPins[_currentRow], active ? LOW : HIGH);
+            _rowActive = active;
+            LED_STATS_GPIO(1);
+        }
+    }
+
+    /**
+     * @brief Deactivates the current row and activates another one.
+     * @param frame The brightness buffer to output.
+     * @param row The row to activate.
+     * @param brightness The brightness to scale the levels with.
+     * @param correction The correction of the levels, or `nullptr`.
+     */
+    void scanRow(const uint8_t* frame, uint8_t row, uint8_t brightness, const ColorCorrection* correction) {
+        LED_STATS_SCAN();
+        // Deactivate the currently active row
+        digitalWrite(_rowPins[_currentRow], HIGH);
+        _currentRow = row;
+        _columnsKnown = false;  // The columns are left to PWM
 
         // Set column values for the new row
         for (uint8_t c = 0; c < _cols; c++) {
             // Brightness is applied by scaling the buffer value
-            uint8_t val = map(_buffer[_currentRow * _cols + c], 0, 255, 0, _brightness);
+            uint8_t level = frame[_currentRow * _cols + c];
+            if (correction) {
+                level = correction->level(level);
+            }
+            uint8_t val = ColorMath::scale8(level, brightness);
             analogWrite(_colPins[c], val);
         }
 
         // Activate the new current row
         digitalWrite(_rowPins[_currentRow], LOW);
+        _rowActive = true;
+        LED_STATS_GPIO(_cols + 2);
+    }
+
+    /**
+     * @brief Common constructor taking one block of storage for the pins and the buffer.
+     */
+    LedMatrix(uint8_t* storage, bool ownsStorage, const uint8_t* rowPins, uint8_t rowCount, const uint8_t* colPins, uint8_t colCount, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _rows(rowCount), _cols(colCount), _rowPins(storage), _colPins(storage + rowCount),
+          _buffer(storage + rowCount + colCount), _currentRow(0), _ownsStorage(ownsStorage),
+          _maskBytes((uint8_t)((colCount + 7) / 8)), _planes(_buffer + (size_t)rowCount * colCount),
+          _columnState(_planes + (size_t)rowCount * kMaxBamBits * _maskBytes) {
+
+        memcpy(_rowPins, rowPins, _rows * sizeof(uint8_t));
+        memcpy(_colPins, colPins, _cols * sizeof(uint8_t));
+        memset(_buffer, 0, _rows * _cols * sizeof(uint8_t));
+
+        for (uint8_t i = 0; i < _rows; i++) {
+            pinMode(_rowPins[i], OUTPUT);
+            digitalWrite(_rowPins[i], HIGH); // Deactivate all rows
+        }
+        for (uint8_t i = 0; i < _cols; i++) {
+            pinMode(_colPins[i], OUTPUT);
+            digitalWrite(_colPins[i], LOW); // Set all columns off
+        }
+        memset(_columnState, 0, _maskBytes);
+        _columnsKnown = true;
+        LED_STATS_GPIO(2 * (_rows + _cols));
     }
 
-private:
     uint8_t _rows;          ///< Number of rows in the matrix.
     uint8_t _cols;          ///< Number of columns in the matrix.
     uint8_t* _rowPins;      ///< Pointer to the array of row pins.
     uint8_t* _colPins;      ///< Pointer to the array of column pins.
     uint8_t* _buffer;       ///< Internal buffer storing the brightness of each LED.
     uint8_t _currentRow;    ///< The row currently being scanned.
+    bool _ownsStorage;      ///< True if the storage block was allocated with `new[]` and must be freed.
+    uint8_t _maskBytes;     ///< Bytes per column mask.
+    uint8_t* _planes;       ///< Column masks for bit angle modulation, `kMaxBamBits` per row.
+    uint8_t* _columnState;  ///< The column mask last written.
+    uint8_t _bamBits = 0;           ///< Grayscale depth of bit angle modulation, 0 for column PWM.
+    uint16_t _bamSlotMicros = 4;    ///< On-time of the least significant bit.
+    bool _planesDirty = true;       ///< True when the bit planes are out of date.
+    bool _columnsKnown = false;     ///< True when `_columnState` matches the column pins.
+    bool _rowActive = false;        ///< True while the current row is driven.
+    ScanSettings _committed = {0, 255, nullptr};    ///< Settings staged with the committed frame.
+    ScanSettings _scan = {0, 255, nullptr};         ///< Settings of the frame being scanned.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_MATRIX_H
@@ -0,0 +1,363 @@
+/**
+ * @file LedHAL_Max7219.h
+ * @brief Driver for LED matrices built from daisy-chained MAX7219 8x8 controllers.
+ *
+ * The MAX7219 multiplexes its 8x8 LEDs itself, so unlike LedMatrix and LedShiftMatrix
+ * the display does not need to be refreshed by the sketch. `show()` only sends the
+ * rows that changed since the last call.
+ */
+#ifndef XDUINORAILS_LED_DRIVERS_MAX7219_H
+#define XDUINORAILS_LED_DRIVERS_MAX7219_H
+
+#include "LedStrip.h"
+#include "ColorCorrection.h"
+#include "LedArena.h"
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+
+/**
+ * @class LedMax7219Matrix
+ * @brief Concrete class for a matrix of MAX7219 modules sharing one SPI chain.
+ *
+ * The matrix is tiled with 8x8 modules in row-major order, and module 0 (the top-left
+ * one) is the first in the chain, at MOSI. Within a module, row `r` is digit
+ * register `r + 1` and column `c` is data bit `7 - c`. Each chip has one intensity
+ * for all of its LEDs, so an LED is either off or lit at the brightness of the matrix:
+ * it is lit when its level is at least 128. The brightness, after color correction,
+ * sets the intensity register in 16 steps; at 0 the chips are shut down.
+ *
+ * `show()` compares each digit row of all chips with what was sent last and sends
+ * only the changed ones, as one word with a register and data byte per chip.
+ *
+ * @code
+ * LedMax7219Matrix panel(10, 16, 32);   // Load (CS) on pin 10, 16 rows, 32 columns
+ *
+ * void setup() {
+ *   panel.begin();
+ * }
+ * @endcode
+ */
+class LedMax7219Matrix : public LedStrip {
+public:
+    /// Default SPI clock. The MAX7219 shifts at up to 10 MHz.
+    static const uint32_t kDefaultClockHz = 8000000;
+
+    /**
+     * @brief Constructor for the LedMax7219Matrix driver.
+     * @param loadPin The pin connected to the LOAD (CS) inputs of all chips.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedMax7219Matrix(uint8_t loadPin, uint8_t rowCount, uint8_t colCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedMax7219Matrix(new uint8_t[storageSize(rowCount, colCount)], true, loadPin, rowCount, colCount, groupId, indexInGroup) {}
+
+    /**
+     * @brief Constructor that places the buffers in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(rowCount, colCount)` bytes available.
+     * @param loadPin The pin connected to the LOAD (CS) inputs of all chips.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedMax7219Matrix(LedArena& arena, uint8_t loadPin, uint8_t rowCount, uint8_t colCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedMax7219Matrix(arena.allocateArray<uint8_t>(storageSize(rowCount, colCount)), false, loadPin, rowCount, colCount, groupId, indexInGroup) {}
+
+    /**
+     * @brief Destructor that cleans up dynamically allocated memory.
+     */
+    ~LedMax7219Matrix() {
+        if (_ownsStorage) {
+            delete[] _buffer; // Start of the shared storage block
+        }
+    }
+
+    LedMax7219Matrix(const LedMax7219Matrix&) = delete;
+    LedMax7219Matrix& operator=(const LedMax7219Matrix&) = delete;
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * The pixel buffer, the digit rows last sent and the SPI buffer share one contiguous block.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @return The storage size in bytes.
+     */
+    static size_t storageSize(uint8_t rowCount, uint8_t colCount) {
+        size_t chips = (((size_t)rowCount + 7) / 8) * (((size_t)colCount + 7) / 8);
+        return (size_t)rowCount * colCount + chips * 8 + chips * 2;
+    }
+
+    /**
+     * @brief Initializes the SPI port and the chips, and sends the whole matrix.
+     * Call this from `setup()`; until then, nothing is sent.
+     * @param spi The SPI port whose MOSI and SCK pins drive the chain.
+     * @param clockHz The SPI clock.
+     */
+    void begin(SPIClass& spi = SPI, uint32_t clockHz = kDefaultClockHz) {
+        _spi = &spi;
+        _settings = SPISettings(clockHz, MSBFIRST, SPI_MODE0);
+        _spi->begin();
+        _begun = true;
+        sendAll(kRegDisplayTest, 0);
+        sendAll(kRegScanLimit, 7);
+        sendAll(kRegDecodeMode, 0);
+        _sentValid = false;
+        _intensity = kIntensityUnknown;
+        _dirty = true;
+        show();
+    }
+
+    /**
+     * @brief Turns all LEDs in the matrix on, at the current brightness, and sends them.
+     */
+    void on() override {
+        memset(_buffer, 255, (size_t)_rows * _cols);
+        _dirty = true;
+        requestShow();
+    }
+
+    /**
+     * @brief Turns all LEDs in the matrix off and sends them.
+     */
+    void off() override {
+        memset(_buffer, 0, (size_t)_rows * _cols);
+        _dirty = true;
+        requestShow();
+    }
+
+    /**
+     * @brief Sets the brightness of the entire matrix based on a color.
+     * @param color The RgbColor whose luminance will be used to set the brightness.
+     */
+    void setColor(const RgbColor& color) override {
+        uint8_t brightness = (color.r + color.g + color.b) / 3;
+        setBrightness(brightness);
+        if (brightness > 0) {
+            on();
+        } else {
+            off();
+        }
+    }
+
+    /**
+     * @brief Sets a single LED in the matrix by row and column.
+     * @param col The column of the LED.
+     * @param row The row of the LED.
+     * @param color The RgbColor whose luminance decides whether the LED is lit.
+     */
+    void setColor(uint8_t col, uint8_t row, const RgbColor& color) {
+        if (row < _rows && col < _cols) {
+            _buffer[row * _cols + col] = (color.r + color.g + color.b) / 3;
+            _dirty = true;
+        }
+    }
+
+    /**
+     * @brief Sets a single LED by its linear index.
+     * @param pixelIndex The linear index of the pixel (row * cols + col).
+     * @param color The RgbColor whose luminance decides whether the LED is lit.
+     */
+    void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
+        if (pixelIndex < numPixels()) {
+            _buffer[pixelIndex] = (color.r + color.g + color.b) / 3;
+            _dirty = true;
+        }
+    }
+
+    /**
+     * @brief Gets the level of a single LED by its linear index.
+     * @param pixelIndex The linear index of the pixel (row * cols + col).
+     * @return The level in all three channels, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < numPixels()) {
+            uint8_t level = _buffer[pixelIndex];
+            return {level, level, level};
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Gets the number of LEDs in the matrix, `rows * cols`.
+     * @return The number of LEDs.
+     */
+    uint16_t numPixels() const override {
+        return (uint16_t)_rows * _cols;
+    }
+
+    /**
+     * @brief Sets a range of LEDs from the luminance of an array of colors.
+     * @param start The linear index of the first LED to set.
+     * @param colors The colors to use, one per LED.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            const RgbColor& color = colors[i - start];
+            _buffer[i] = (color.r + color.g + color.b) / 3;
+        }
+        _dirty = true;
+    }
+
+    /**
+     * @brief Sets a range of LEDs to the luminance of one color.
+     * @param start The linear index of the first LED to set.
+     * @param count The number of LEDs to set.
+     * @param color The color to use.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        memset(_buffer + start, (color.r + color.g + color.b) / 3, end - start);
+        _dirty = true;
+    }
+
+    /**
+     * @brief Gets direct access to a range of the level buffer, in row-major order.
+     * This driver stores one level per LED, so `getPixelSpan()` returns an empty span.
+     * The next `show()` after each call compares all rows.
+     * @param start The linear index of the first LED.
+     * @param count The number of LEDs. Clamped to the number of LEDs.
+     * @return The span of stored levels.
+     */
+    LedSpan<uint8_t> getLevelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        _dirty = true;
+        return {_buffer + start, (uint16_t)(end - start)};
+    }
+
+    /**
+     * @brief Sends the intensity and the digit rows that changed since the last call.
+     */
+    void show() override {
+        if (!_begun) {
+            return;
+        }
+        uint8_t level = _correction ? _correction->level(_brightness) : _brightness;
+        // Brightness 1-255 maps to the 16 intensity steps; 0 shuts the chips down.
+        uint8_t intensity = level ? (uint8_t)((level - 1) >> 4) : (uint8_t)kIntensityOff;
+        if (intensity != _intensity) {
+            if (intensity == kIntensityOff) {
+                sendAll(kRegShutdown, 0);
+            } else {
+                sendAll(kRegIntensity, intensity);
+                if (_intensity == kIntensityOff || _intensity == kIntensityUnknown) {
+                    sendAll(kRegShutdown, 1);
+                }
+            }
+            _intensity = intensity;
+        }
+        if (!_dirty) {
+            return;
+        }
+        _dirty = false;
+        for (uint8_t digit = 0; digit < 8; digit++) {
+            bool changed = !_sentValid;
+            for (uint8_t chip = 0; chip < _chips; chip++) {
+                uint8_t data = digitData(chip, digit);
+                uint8_t* sent = _sent + chip * 8 + digit;
+                changed |= data != *sent;
+                *sent = data;
+                // Module 0 is nearest to MOSI, so it is shifted last.
+                uint8_t* command = _word + (_chips - 1 - chip) * 2;
+                command[0] = (uint8_t)(kRegDigit0 + digit);
+                command[1] = data;
+            }
+            if (changed) {
+                transferWord();
+            }
+        }
+        _sentValid = true;
+    }
+
+private:
+    static const uint8_t kRegDigit0 = 0x01;       ///< Register of digit 0; digits 1-7 follow.
+    static const uint8_t kRegDecodeMode = 0x09;   ///< BCD decode per digit, 0 for raw segments.
+    static const uint8_t kRegIntensity = 0x0A;    ///< PWM intensity, 0-15.
+    static const uint8_t kRegScanLimit = 0x0B;    ///< Number of scanned digits minus one.
+    static const uint8_t kRegShutdown = 0x0C;     ///< 0 for shutdown, 1 for normal operation.
+    static const uint8_t kRegDisplayTest = 0x0F;  ///< 1 lights all LEDs.
+    static const uint8_t kIntensityOff = 0xFE;    ///< `_intensity` while the chips are shut down.
+    static const uint8_t kIntensityUnknown = 0xFF; ///< `_intensity` before the chips were initialized.
+
+    /**
+     * @brief Gets the segment byte of one chip's digit row from the buffer.
+     */
+    uint8_t digitData(uint8_t chip, uint8_t digit) const {
+        uint8_t row = (uint8_t)((chip / _modCols) * 8 + digit);
+        if (row >= _rows) {
+            return 0;
+        }
+        uint8_t firstCol = (uint8_t)((chip % _modCols) * 8);
+        const uint8_t* levels = _buffer + row * _cols + firstCol;
+        uint8_t count = _cols - firstCol < 8 ? (uint8_t)(_cols - firstCol) : 8;
+        uint8_t data = 0;
+        for (uint8_t c = 0; c < count; c++) {
+            if (levels[c] & 0x80) {
+                data |= (uint8_t)(0x80 >> c);
+            }
+        }
+        return data;
+    }
+
+    /**
+     * @brief Writes the same value to one register of every chip.
+     */
+    void sendAll(uint8_t reg, uint8_t value) {
+        for (uint8_t chip = 0; chip < _chips; chip++) {
+            _word[chip * 2] = reg;
+            _word[chip * 2 + 1] = value;
+        }
+        transferWord();
+    }
+
+    /**
+     * @brief Sends the SPI buffer with LOAD held low, and loads it on the rising edge.
+     * The port overwrites the buffer with the received bytes.
+     */
+    void transferWord() {
+        _spi->beginTransaction(_settings);
+        digitalWrite(_loadPin, LOW);
+        _spi->transfer(_word, (size_t)_chips * 2);
+        digitalWrite(_loadPin, HIGH);
+        _spi->endTransaction();
+        LED_STATS_GPIO(2);
+    }
+
+    /**
+     * @brief Common constructor taking one block of storage for all buffers.
+     */
+    LedMax7219Matrix(uint8_t* storage, bool ownsStorage, uint8_t loadPin, uint8_t rowCount, uint8_t colCount, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _rows(rowCount), _cols(colCount), _loadPin(loadPin),
+          _modCols((uint8_t)((colCount + 7) / 8)), _chips((uint8_t)(((rowCount + 7) / 8) * _modCols)), _ownsStorage(ownsStorage),
+          _buffer(storage), _sent(_buffer + (size_t)rowCount * colCount), _word(_sent + (size_t)_chips * 8) {
+        memset(_buffer, 0, (size_t)_rows * _cols);
+        pinMode(_loadPin, OUTPUT);
+        digitalWrite(_loadPin, HIGH);
+        LED_STATS_GPIO(2);
+    }
+
+    uint8_t _rows;          ///< Number of rows in the matrix.
+    uint8_t _cols;          ///< Number of columns in the matrix.
+    uint8_t _loadPin;       ///< The pin connected to the LOAD inputs.
+    uint8_t _modCols;       ///< Number of modules per module row.
+    uint8_t _chips;         ///< Number of chips in the chain.
+    bool _ownsStorage;      ///< True if the storage block was allocated with `new[]` and must be freed.
+    uint8_t* _buffer;       ///< Internal buffer storing the level of each LED.
+    uint8_t* _sent;         ///< The segment bytes last sent, eight per chip.
+    uint8_t* _word;         ///< The word being shifted out, two bytes per chip.
+    SPIClass* _spi = &SPI;  ///< The SPI port driving the chain.
+    SPISettings _settings;  ///< Clock, bit order and mode of the transfers.
+    uint8_t _intensity = kIntensityUnknown; ///< The intensity last sent, or a `kIntensity` state.
+    bool _sentValid = false;    ///< True when `_sent` matches the chips.
+    bool _dirty = true;         ///< True when the buffer changed since the last `show()`.
+    bool _begun = false;        ///< True once `begin()` has initialized the SPI port.
+};
+
+#endif // XDUINORAILS_LED_DRIVERS_MAX7219_H
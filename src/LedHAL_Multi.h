@@ -9,6 +9,8 @@
 #define XDUINORAILS_LED_DRIVERS_MULTI_H
 
 #include "Led.h"
+#include "ColorCorrection.h"
+#include "LedArena.h"
 #include <Arduino.h>
 
 /**
@@ -18,6 +20,8 @@
  * This class implements the Led interface to control multiple LEDs connected to
  * different pins as if they were a single entity. All LEDs in the group are set
  * to the same brightness. It supports both common anode and common cathode wiring.
+ * The last value written to the pins is shadowed, so repeated calls with an
+ * unchanged state do not touch the pins.
  */
 class LedMulti : public Led {
 public:
@@ -33,42 +37,66 @@ public:
      * @param isAnode Set to true for common anode (pin HIGH for on), false for common cathode (pin LOW for on).
      */
     LedMulti(const uint8_t* pins, uint8_t pinCount, uint8_t groupId = 0, uint16_t indexInGroup = 0, bool isAnode = true)
-        : Led(groupId, indexInGroup), _pinCount(pinCount), _isAnode(isAnode) {
-        _pins = new uint8_t[pinCount];
-        for (uint8_t i = 0; i < _pinCount; i++) {
-            _pins[i] = pins[i];
-            pinMode(_pins[i], OUTPUT);
-        }
-        off();
-    }
+        : LedMulti(new uint8_t[pinCount], true, pins, pinCount, groupId, indexInGroup, isAnode) {}
+
+    /**
+     * @brief Constructor that places the pins array in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(pinCount)` bytes available.
+     * @param pins A pointer to an array of Arduino pin numbers.
+     * @param pinCount The number of pins in the array.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     * @param isAnode Set to true for common anode (pin HIGH for on), false for common cathode (pin LOW for on).
+     */
+    LedMulti(LedArena& arena, const uint8_t* pins, uint8_t pinCount, uint8_t groupId = 0, uint16_t indexInGroup = 0, bool isAnode = true)
+        : LedMulti(arena.allocateArray<uint8_t>(pinCount), false, pins, pinCount, groupId, indexInGroup, isAnode) {}
 
     /**
      * @brief Destructor that cleans up the dynamically allocated pins array.
      */
     ~LedMulti() {
-        delete[] _pins;
+        if (_ownsStorage) {
+            delete[] _pins;
+        }
+    }
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * @param pinCount The number of pins.
+     * @return The storage size in bytes.
+     */
+    static size_t storageSize(uint8_t pinCount) {
+        return pinCount;
     }
 
     /**
      * @brief Turns all LEDs in the group on to the currently set brightness.
      */
     void on() override {
+        uint8_t level = _correction ? _correction->level(_brightness) : _brightness;
+        uint8_t value = _isAnode ? level : 255 - level;
+        if (_output == value) {
+            return;
+        }
         for (uint8_t i = 0; i < _pinCount; i++) {
-            if (_isAnode) {
-                analogWrite(_pins[i], _brightness);
-            } else {
-                analogWrite(_pins[i], 255 - _brightness);
-            }
+            analogWrite(_pins[i], value);
         }
+        _output = value;
+        LED_STATS_GPIO(_pinCount);
     }
 
     /**
      * @brief Turns all LEDs in the group off.
      */
     void off() override {
+        if (_output == OUTPUT_OFF) {
+            return;
+        }
         for (uint8_t i = 0; i < _pinCount; i++) {
             digitalWrite(_pins[i], _isAnode ? LOW : HIGH);
         }
+        _output = OUTPUT_OFF;
+        LED_STATS_GPIO(_pinCount);
     }
 
     /**
@@ -93,10 +121,44 @@ public:
         }
     }
 
+    /**
+     * @brief Sets the output correction and rewrites the output if the group is on.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        Led::setColorCorrection(correction);
+        if (_output != OUTPUT_OFF && _output != OUTPUT_UNKNOWN) {
+            on();
+        }
+    }
+
 private:
-    uint8_t* _pins;     ///< Pointer to the dynamically allocated array of GPIO pins.
+    /**
+     * @brief Shadow values besides the PWM duty cycles 0-255.
+     */
+    enum : uint16_t {
+        OUTPUT_OFF = 0x100,         ///< The pins were driven to the off level with `digitalWrite()`.
+        OUTPUT_UNKNOWN = 0xFFFF     ///< The pins have not been written yet.
+    };
+
+    /**
+     * @brief Common constructor taking the storage for the pins array.
+     */
+    LedMulti(uint8_t* storage, bool ownsStorage, const uint8_t* pins, uint8_t pinCount, uint8_t groupId, uint16_t indexInGroup, bool isAnode)
+        : Led(groupId, indexInGroup), _pins(storage), _pinCount(pinCount), _isAnode(isAnode), _ownsStorage(ownsStorage) {
+        for (uint8_t i = 0; i < _pinCount; i++) {
+            _pins[i] = pins[i];
+            pinMode(_pins[i], OUTPUT);
+        }
+        LED_STATS_GPIO(_pinCount);
+        off();
+    }
+
+    uint8_t* _pins;     ///< Pointer to the array of GPIO pins.
     uint8_t _pinCount;  ///< The number of pins in the `_pins` array.
     bool _isAnode;      ///< True if the LEDs are common anode, false for common cathode.
+    bool _ownsStorage;  ///< True if `_pins` was allocated with `new[]` and must be freed.
+    uint16_t _output = OUTPUT_UNKNOWN;  ///< The last value written to all pins.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_MULTI_H
@@ -9,7 +9,9 @@
 #define XDUINORAILS_LED_DRIVERS_NEOPIXEL_H
 
 #include "LedStrip.h"
-#include <Adafruit_NeoPixel.h>
+#include "LedArena.h"
+#include "NeoPixelOutput.h"
+#include "ScaleTable.h"
 
 /**
  * @class LedNeoPixel
@@ -18,6 +20,10 @@
  * This class inherits from LedStrip and acts as a bridge to the Adafruit_NeoPixel
  * library. It allows NeoPixel strips to be treated like any other Led object in
  * the HAL, while also exposing some useful NeoPixel-specific utility functions.
+ *
+ * Pixel colors are kept at full precision in a separate buffer. Brightness is
+ * applied through a scale table only when the colors are converted for output, so
+ * changing it never alters the stored colors.
  */
 class LedNeoPixel : public LedStrip {
 public:
@@ -29,11 +35,41 @@ public:
      * @param indexInGroup An optional index within the group.
      */
     LedNeoPixel(uint8_t pin, uint16_t numLeds, uint8_t groupId = 0, uint16_t indexInGroup = 0)
-        : LedStrip(groupId, indexInGroup), _numLeds(numLeds), _strip(numLeds, pin, NEO_GRB + NEO_KHZ800) {
+        : LedStrip(groupId, indexInGroup), _numLeds(numLeds), _pixels(new RgbColor[numLeds]()), _ownsStorage(true),
+          _strip(numLeds, pin, NEO_GRB + NEO_KHZ800) {
         _strip.begin();
         off();
     }
 
+    /**
+     * @brief Constructor that places the pixel buffer in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(numLeds)` bytes available.
+     * @param pin The Arduino pin connected to the NeoPixel data line.
+     * @param numLeds The number of pixels in the strip.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedNeoPixel(LedArena& arena, uint8_t pin, uint16_t numLeds, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedNeoPixel(arena.allocateArray<uint8_t>(storageSize(numLeds)), pin, numLeds, groupId, indexInGroup) {}
+
+    /**
+     * @brief Destructor that cleans up the dynamically allocated color buffer.
+     */
+    ~LedNeoPixel() {
+        if (_ownsStorage) {
+            delete[] _pixels;
+        }
+    }
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * @param numLeds The number of pixels in the strip.
+     * @return The storage size in bytes: the output buffer followed by the color buffer.
+     */
+    static size_t storageSize(uint16_t numLeds) {
+        return NeoPixelOutput::storageSize(numLeds) + (size_t)numLeds * sizeof(RgbColor);
+    }
+
     /**
      * @brief Turns the entire strip on to full white.
      */
@@ -54,9 +90,9 @@ public:
      */
     void setColor(const RgbColor& color) override {
         for (uint16_t i = 0; i < _numLeds; i++) {
-            _strip.setPixelColor(i, color.r, color.g, color.b);
+            updatePixel(i, color);
         }
-        _strip.show();
+        requestShow();
     }
 
     /**
@@ -67,7 +103,7 @@ public:
      */
     void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
         if (pixelIndex < _numLeds) {
-            _strip.setPixelColor(pixelIndex, color.r, color.g, color.b);
+            updatePixel(pixelIndex, color);
         }
     }
 
@@ -80,33 +116,140 @@ public:
      */
     void setColor(uint16_t pixelIndex, uint32_t color) {
         if (pixelIndex < _numLeds) {
-            _strip.setPixelColor(pixelIndex, color);
+            updatePixel(pixelIndex, {(uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color});
+        }
+    }
+
+    /**
+     * @brief Gets the color of a pixel, without brightness applied.
+     * @param pixelIndex The index of the pixel.
+     * @return The stored color, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < _numLeds) {
+            return _pixels[pixelIndex];
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Sets the colors of a range of pixels from an array.
+     * Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param colors The colors to set, one per pixel.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        for (uint16_t i = start; i < end; i++) {
+            updatePixel(i, colors[i - start]);
+        }
+    }
+
+    /**
+     * @brief Sets a range of pixels to one color.
+     * Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param count The number of pixels to set.
+     * @param color The color to set.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        for (uint16_t i = start; i < end; i++) {
+            updatePixel(i, color);
         }
     }
 
+    /**
+     * @brief Gets direct access to a range of the color buffer and marks it as changed.
+     * The colors are stored without brightness applied.
+     * @param start The index of the first pixel.
+     * @param count The number of pixels. Clamped to the end of the strip.
+     * @return The span of stored colors.
+     */
+    LedSpan<RgbColor> getPixelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        markDirty(start, end);
+        return {_pixels + start, (uint16_t)(end - start)};
+    }
+
     /**
      * @brief Sets the brightness of the entire strip.
+     * The stored colors are not changed; brightness is applied when they are output.
+     * Setting the current brightness again has no effect.
      * @param brightness The brightness level (0-255).
      */
     void setBrightness(uint8_t brightness) override {
+        if (brightness == _brightness) {
+            return;
+        }
         LedStrip::setBrightness(brightness);
-        _strip.setBrightness(brightness);
-        _strip.show();
+        _scale.setScale(brightness);
+        invalidate();
+        requestShow();
     }
 
     /**
      * @brief Pushes the current color data to the physical LED strip.
+     * Does nothing if no pixel changed since the last transmission. With truncated
+     * shows enabled, only the pixels up to the highest changed one are transmitted.
+     * With a transport (@see setTransport()), the transmission runs in the background.
      */
     void show() override {
-        _strip.show();
+        if (!isDirty()) {
+            LED_STATS_SKIP();
+            return;
+        }
+        uint16_t length = showLength(_numLeds);
+        LED_STATS_SHOW(NeoPixelOutput::storageSize(length));
+        _strip.waitIdle();
+        renderCorrected(_dirtyFirst, _dirtyEnd < _numLeds ? _dirtyEnd : _numLeds,
+                        [this](uint16_t first, uint16_t end, const ColorCorrection* correction) {
+                            _strip.writePixels(_pixels, first, end, _scale.data(), correction);
+                        });
+        _strip.transmit(length);
+        clearDirty();
+    }
+
+    /**
+     * @brief Sends frames through a background transport instead of the Adafruit library.
+     *
+     * With a transport, `show()` converts the frame into the output buffer, hands it
+     * to the transport and returns without waiting for the transmission. The next
+     * `show()` waits only if the previous frame is still being sent. Rendering into
+     * the driver is not affected, because it uses a separate buffer.
+     *
+     * @param transport The transport, or `nullptr` to transmit through the library
+     *                  again. Must outlive the driver or be removed before it is destroyed.
+     */
+    void setTransport(StripTransport* transport) {
+        _strip.setTransport(transport);
+    }
+
+    /**
+     * @brief Checks whether a frame is still being sent by the transport.
+     * @return True while an asynchronous transmission is in progress.
+     */
+    bool isBusy() const {
+        return _strip.isBusy();
+    }
+
+    /**
+     * @brief Blocks until the transport has sent the current frame.
+     */
+    void waitIdle() const {
+        _strip.waitIdle();
     }
 
     /**
      * @brief Gets the number of pixels in the strip.
      * @return The number of pixels.
      */
-    uint16_t numPixels() const {
-        return _strip.numPixels();
+    uint16_t numPixels() const override {
+        return _numLeds;
     }
 
     /**
@@ -132,8 +275,36 @@ public:
     }
 
 private:
+    /**
+     * @brief Common constructor for the arena, taking one block for both buffers.
+     */
+    LedNeoPixel(uint8_t* storage, uint8_t pin, uint16_t numLeds, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _numLeds(numLeds),
+          _pixels(reinterpret_cast<RgbColor*>(storage + NeoPixelOutput::storageSize(numLeds))), _ownsStorage(false),
+          _strip(numLeds, pin, NEO_GRB + NEO_KHZ800, storage) {
+        memset(_pixels, 0, (size_t)numLeds * sizeof(RgbColor));
+        _strip.begin();
+        off();
+    }
+
+    /**
+     * @brief Stores the color of a pixel and marks it dirty if it changed.
+     * @param pixelIndex The index of the pixel. Must be less than `_numLeds`.
+     * @param color The new color.
+     */
+    void updatePixel(uint16_t pixelIndex, const RgbColor& color) {
+        RgbColor& pixel = _pixels[pixelIndex];
+        if (pixel.r != color.r || pixel.g != color.g || pixel.b != color.b) {
+            pixel = color;
+            markDirty(pixelIndex);
+        }
+    }
+
     uint16_t _numLeds;          ///< The number of LEDs in the strip.
-    Adafruit_NeoPixel _strip;   ///< The underlying Adafruit_NeoPixel object.
+    RgbColor* _pixels;          ///< Full-precision colors of all pixels.
+    bool _ownsStorage;          ///< True if `_pixels` was allocated with `new[]` and must be freed.
+    ScaleTable _scale;          ///< Brightness scale applied when converting for output.
+    NeoPixelOutput _strip;      ///< The underlying Adafruit_NeoPixel object.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_NEOPIXEL_H
@@ -0,0 +1,335 @@
+/**
+ * @file LedHAL_NeoPixelDithered.h
+ * @brief Driver for NeoPixel (WS2812B) strips with a 16-bit framebuffer and temporal dithering.
+ *
+ * The LEDs only accept 8 bits per channel, so dim colors step visibly and small
+ * values scaled by a low brightness round to zero. This driver keeps 16 bits per
+ * channel and spreads the fractional part over successive frames, which raises the
+ * effective resolution as long as `show()` is called at a high frame rate.
+ */
+#ifndef XDUINORAILS_LED_DRIVERS_NEOPIXEL_DITHERED_H
+#define XDUINORAILS_LED_DRIVERS_NEOPIXEL_DITHERED_H
+
+#include "LedStrip.h"
+#include "LedArena.h"
+#include "NeoPixelOutput.h"
+#include <string.h>
+
+/**
+ * @class LedNeoPixelDithered
+ * @brief Concrete class for NeoPixel strips with 16-bit colors and temporal dithering.
+ *
+ * Colors set through the 8-bit LedStrip interface are stored as `c << 8`; the
+ * 16-bit methods (`setPixelColor16()`, `fill16()`, `getPixelSpan16()`) also set the
+ * fractional low byte (@see RgbColor16). Values above 0xFF00 are output as 255.
+ * Brightness is applied to the 16-bit values before dithering, so dimming does not
+ * lose precision either.
+ *
+ * On every `show()`, each channel is scaled and added to the residual of the last
+ * frame; the high byte is sent and the low byte becomes the new residual (error
+ * diffusion over time). A pixel whose scaled value is not a whole 8-bit step keeps
+ * being re-sent by `show()`, even if it was not changed, so `show()` should be
+ * called every loop iteration or from a periodic timer. Pixels whose values are
+ * exact 8-bit steps are skipped like in LedNeoPixel once they have been sent.
+ */
+class LedNeoPixelDithered : public LedStrip {
+public:
+    /**
+     * @brief Constructor for the LedNeoPixelDithered driver.
+     * @param pin The Arduino pin connected to the NeoPixel data line.
+     * @param numLeds The number of pixels in the strip.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedNeoPixelDithered(uint8_t pin, uint16_t numLeds, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedNeoPixelDithered(new uint8_t[storageSize(numLeds)], true, pin, numLeds, groupId, indexInGroup) {}
+
+    /**
+     * @brief Constructor that places the buffers in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(numLeds)` bytes available.
+     * @param pin The Arduino pin connected to the NeoPixel data line.
+     * @param numLeds The number of pixels in the strip.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedNeoPixelDithered(LedArena& arena, uint8_t pin, uint16_t numLeds, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedNeoPixelDithered(static_cast<uint8_t*>(arena.allocate(storageSize(numLeds), alignof(RgbColor16))), false,
+                              pin, numLeds, groupId, indexInGroup) {}
+
+    /**
+     * @brief Destructor that cleans up dynamically allocated memory.
+     */
+    ~LedNeoPixelDithered() {
+        _strip.waitIdle();
+        if (_ownsStorage) {
+            delete[] reinterpret_cast<uint8_t*>(_pixels); // Start of the shared storage block
+        }
+    }
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * @param numLeds The number of pixels in the strip.
+     * @return The storage size in bytes: the 16-bit colors, the output buffer and the residuals.
+     */
+    static size_t storageSize(uint16_t numLeds) {
+        return (size_t)numLeds * sizeof(RgbColor16) + NeoPixelOutput::storageSize(numLeds) + (size_t)numLeds * 3;
+    }
+
+    /**
+     * @brief Turns the entire strip on to full white.
+     */
+    void on() override {
+        setColor({255, 255, 255});
+    }
+
+    /**
+     * @brief Turns the entire strip off (sets all pixels to black).
+     */
+    void off() override {
+        setColor({0, 0, 0});
+    }
+
+    /**
+     * @brief Sets the color of the entire strip to a single color.
+     * @param color The RgbColor to set.
+     */
+    void setColor(const RgbColor& color) override {
+        fill16(0, _numLeds, expand(color));
+        requestShow();
+    }
+
+    /**
+     * @brief Sets the color of an individual pixel. Does not call `show()`.
+     * @param pixelIndex The index of the pixel to set.
+     * @param color The RgbColor to set.
+     */
+    void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
+        setPixelColor16(pixelIndex, expand(color));
+    }
+
+    /**
+     * @brief Sets the 16-bit color of an individual pixel. Does not call `show()`.
+     * @param pixelIndex The index of the pixel to set.
+     * @param color The RgbColor16 to set.
+     */
+    void setPixelColor16(uint16_t pixelIndex, const RgbColor16& color) {
+        if (pixelIndex < _numLeds) {
+            updatePixel(pixelIndex, color);
+        }
+    }
+
+    /**
+     * @brief Gets the color of a pixel, rounded to 8 bits and without brightness applied.
+     * @param pixelIndex The index of the pixel.
+     * @return The stored color, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < _numLeds) {
+            const RgbColor16& pixel = _pixels[pixelIndex];
+            return {reduce(pixel.r), reduce(pixel.g), reduce(pixel.b)};
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Gets the 16-bit color of a pixel, without brightness applied.
+     * @param pixelIndex The index of the pixel.
+     * @return The stored color, or black if the index is out of range.
+     */
+    RgbColor16 getPixelColor16(uint16_t pixelIndex) const {
+        if (pixelIndex < _numLeds) {
+            return _pixels[pixelIndex];
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Sets the colors of a range of pixels from an array. Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param colors The colors to set, one per pixel.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        for (uint16_t i = start; i < end; i++) {
+            updatePixel(i, expand(colors[i - start]));
+        }
+    }
+
+    /**
+     * @brief Sets a range of pixels to one color. Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param count The number of pixels to set.
+     * @param color The color to set.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        fill16(start, count, expand(color));
+    }
+
+    /**
+     * @brief Sets a range of pixels to one 16-bit color. Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param count The number of pixels to set.
+     * @param color The color to set.
+     */
+    void fill16(uint16_t start, uint16_t count, const RgbColor16& color) {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        for (uint16_t i = start; i < end; i++) {
+            updatePixel(i, color);
+        }
+    }
+
+    /**
+     * @brief Gets direct access to a range of the 16-bit color buffer and marks it as changed.
+     * @param start The index of the first pixel.
+     * @param count The number of pixels. Clamped to the end of the strip.
+     * @return The span of stored colors.
+     */
+    LedSpan<RgbColor16> getPixelSpan16(uint16_t start = 0, uint16_t count = 0xFFFF) {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        markDirty(start, end);
+        return {_pixels + start, (uint16_t)(end - start)};
+    }
+
+    /**
+     * @brief Sets the brightness of the entire strip.
+     * The stored colors are not changed; brightness is applied when they are output.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) override {
+        if (brightness == _brightness) {
+            return;
+        }
+        LedStrip::setBrightness(brightness);
+        invalidate();
+        requestShow();
+    }
+
+    /**
+     * @brief Dithers the current colors into a frame and pushes it to the strip.
+     * Re-sends all pixels that still have a fractional part, plus the changed ones.
+     * Does nothing if neither exists.
+     */
+    void show() override {
+        if (_ditherEnd > 0) {
+            markDirty(0, _ditherEnd);
+        }
+        if (!isDirty()) {
+            LED_STATS_SKIP();
+            return;
+        }
+        uint16_t length = showLength(_numLeds);
+        LED_STATS_SHOW(NeoPixelOutput::storageSize(length));
+        _strip.waitIdle();
+        uint16_t first = _dirtyFirst;
+        uint16_t end = _dirtyEnd < _numLeds ? _dirtyEnd : _numLeds;
+        uint16_t fractionEnd = 0;
+        renderCorrected(first, end, [this, &fractionEnd](uint16_t from, uint16_t to, const ColorCorrection* correction) {
+            uint16_t partEnd = _strip.writeDithered(_pixels, _residuals, from, to, (uint16_t)_brightness + 1, correction);
+            if (partEnd > fractionEnd) {
+                fractionEnd = partEnd;
+            }
+        });
+        // Pixels outside the converted range keep their previous fractional state.
+        if ((first == 0 && end >= _ditherEnd) || fractionEnd > _ditherEnd) {
+            _ditherEnd = fractionEnd;
+        }
+        _strip.transmit(length);
+        clearDirty();
+    }
+
+    /**
+     * @brief Checks whether `show()` still has dithering work to do on an unchanged frame.
+     * @return True if some pixel is between two 8-bit steps after brightness scaling.
+     */
+    bool isDithering() const {
+        return _ditherEnd > 0;
+    }
+
+    /**
+     * @brief Sends frames through a background transport instead of the Adafruit library.
+     * @param transport The transport, or `nullptr` to transmit through the library
+     *                  again. Must outlive the driver or be removed before it is destroyed.
+     */
+    void setTransport(StripTransport* transport) {
+        _strip.setTransport(transport);
+    }
+
+    /**
+     * @brief Checks whether a frame is still being sent by the transport.
+     * @return True while an asynchronous transmission is in progress.
+     */
+    bool isBusy() const {
+        return _strip.isBusy();
+    }
+
+    /**
+     * @brief Blocks until the transport has sent the current frame.
+     */
+    void waitIdle() const {
+        _strip.waitIdle();
+    }
+
+    /**
+     * @brief Gets the number of pixels in the strip.
+     * @return The number of pixels.
+     */
+    uint16_t numPixels() const override {
+        return _numLeds;
+    }
+
+private:
+    /**
+     * @brief Common constructor taking one block of storage for all buffers.
+     */
+    LedNeoPixelDithered(uint8_t* storage, bool ownsStorage, uint8_t pin, uint16_t numLeds, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _numLeds(numLeds), _ditherEnd(0),
+          _pixels(reinterpret_cast<RgbColor16*>(storage)),
+          _residuals(storage + (size_t)numLeds * sizeof(RgbColor16) + NeoPixelOutput::storageSize(numLeds)),
+          _ownsStorage(ownsStorage),
+          _strip(numLeds, pin, NEO_GRB + NEO_KHZ800, storage + (size_t)numLeds * sizeof(RgbColor16)) {
+        memset(_pixels, 0, (size_t)numLeds * sizeof(RgbColor16));
+        memset(_residuals, 0, (size_t)numLeds * 3);
+        _strip.begin();
+        off();
+    }
+
+    /**
+     * @brief Expands an 8-bit color to 8.8 fixed point.
+     */
+    static RgbColor16 expand(const RgbColor& color) {
+        return {(uint16_t)(color.r << 8), (uint16_t)(color.g << 8), (uint16_t)(color.b << 8)};
+    }
+
+    /**
+     * @brief Rounds an 8.8 fixed-point channel value to 8 bits.
+     */
+    static uint8_t reduce(uint16_t value) {
+        return value >= 0xFF00 ? 255 : (uint8_t)((value + 128) >> 8);
+    }
+
+    /**
+     * @brief Stores the color of a pixel and marks it dirty if it changed.
+     * @param pixelIndex The index of the pixel. Must be less than `_numLeds`.
+     * @param color The new color.
+     */
+    void updatePixel(uint16_t pixelIndex, const RgbColor16& color) {
+        RgbColor16& pixel = _pixels[pixelIndex];
+        if (pixel.r != color.r || pixel.g != color.g || pixel.b != color.b) {
+            pixel = color;
+            markDirty(pixelIndex);
+        }
+    }
+
+    uint16_t _numLeds;          ///< The number of LEDs in the strip.
+    uint16_t _ditherEnd;        ///< One past the last pixel with a fractional part, 0 if none.
+    RgbColor16* _pixels;        ///< 16-bit colors of all pixels; start of the storage block.
+    uint8_t* _residuals;        ///< Dithering residuals, three bytes (r, g, b) per pixel.
+    bool _ownsStorage;          ///< True if the storage block was allocated with `new[]` and must be freed.
+    NeoPixelOutput _strip;      ///< The underlying Adafruit_NeoPixel object.
+};
+
+#endif // XDUINORAILS_LED_DRIVERS_NEOPIXEL_DITHERED_H
@@ -0,0 +1,440 @@
+/**
+ * @file LedHAL_ParallelStrip.h
+ * @brief Driver for up to eight WS2812 strips clocked out in parallel.
+ *
+ * This file provides a strip driver that treats several equally long WS2812 chains,
+ * each on its own data pin, as one strip. The output data is kept as bit planes, so
+ * a parallel transport can send all chains in one pass and a frame takes as long
+ * as a single chain.
+ */
+#ifndef XDUINORAILS_LED_DRIVERS_PARALLEL_STRIP_H
+#define XDUINORAILS_LED_DRIVERS_PARALLEL_STRIP_H
+
+#include "LedStrip.h"
+#include "LedArena.h"
+#include "NeoPixelOutput.h"
+#include "ScaleTable.h"
+#include "StripTransport.h"
+#include <string.h>
+
+/**
+ * @class LedParallelStrip
+ * @brief Concrete class for up to eight WS2812 chains driven simultaneously.
+ *
+ * Pixels are addressed as one strip: lane 0 holds pixels `0 .. numLedsPerLane - 1`,
+ * lane 1 the next `numLedsPerLane` pixels, and so on. Colors are kept at full
+ * precision in a render buffer. On `show()`, the changed pixel positions are scaled
+ * by the brightness and transposed into bit planes: for every bit sent on the wire,
+ * one byte whose bit `k` is the value for lane `k`.
+ *
+ * The planes are sent by a parallel StripTransport, such as an
+ * Rp2040PioStripTransport with one lane per pin on consecutive GPIOs. Without a
+ * transport, the lanes are sent one after another through the Adafruit library,
+ * which works on any board but takes as long as all chains together.
+ */
+class LedParallelStrip : public LedStrip {
+public:
+    /// The maximum number of lanes.
+    static const uint8_t kMaxLanes = 8;
+
+    /**
+     * @brief Constructor for the LedParallelStrip driver.
+     * @param pins The data pins of the lanes, one per chain.
+     * @param laneCount The number of elements in `pins`, 1 to `kMaxLanes`. Clamped to that range.
+     * @param numLedsPerLane The number of pixels of each chain. Reduced so that all lanes
+     *                       together have at most 65535 pixels.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedParallelStrip(const uint8_t* pins, uint8_t laneCount, uint16_t numLedsPerLane, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedParallelStrip(new uint8_t[storageSize(laneCount, numLedsPerLane)], true, pins, clampLanes(laneCount),
+                           clampLedsPerLane(laneCount, numLedsPerLane), groupId, indexInGroup) {}
+
+    /**
+     * @brief Constructor that places the pin array and buffers in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(laneCount, numLedsPerLane)` bytes available.
+     * @param pins The data pins of the lanes, one per chain.
+     * @param laneCount The number of elements in `pins`, 1 to `kMaxLanes`. Clamped to that range.
+     * @param numLedsPerLane The number of pixels of each chain. Reduced so that all lanes
+     *                       together have at most 65535 pixels.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedParallelStrip(LedArena& arena, const uint8_t* pins, uint8_t laneCount, uint16_t numLedsPerLane, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedParallelStrip(arena.allocateArray<uint8_t>(storageSize(laneCount, numLedsPerLane)), false, pins, clampLanes(laneCount),
+                           clampLedsPerLane(laneCount, numLedsPerLane), groupId, indexInGroup) {}
+
+    /**
+     * @brief Destructor that cleans up dynamically allocated memory.
+     */
+    ~LedParallelStrip() {
+        if (_transport) {
+            _transport->waitIdle();
+        }
+        if (_ownsStorage) {
+            delete[] _pins; // Start of the shared storage block
+        }
+    }
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * The pins, the render buffer and the bit planes share one contiguous block.
+     * @param laneCount The number of lanes, clamped as by the constructors.
+     * @param numLedsPerLane The number of pixels of each chain, reduced as by the constructors.
+     * @return The storage size in bytes.
+     */
+    static size_t storageSize(uint8_t laneCount, uint16_t numLedsPerLane) {
+        numLedsPerLane = clampLedsPerLane(laneCount, numLedsPerLane);
+        laneCount = clampLanes(laneCount);
+        return laneCount + (size_t)laneCount * numLedsPerLane * sizeof(RgbColor) + planeBytes(numLedsPerLane);
+    }
+
+    /**
+     * @brief Turns all pixels on to full white.
+     */
+    void on() override {
+        setColor({255, 255, 255});
+    }
+
+    /**
+     * @brief Turns all pixels off.
+     */
+    void off() override {
+        setColor({0, 0, 0});
+    }
+
+    /**
+     * @brief Sets all pixels of all lanes to one color and shows them.
+     * @param color The RgbColor to set.
+     */
+    void setColor(const RgbColor& color) override {
+        fill(0, numPixels(), color);
+        requestShow();
+    }
+
+    /**
+     * @brief Sets the color of an individual pixel. Does not call `show()`.
+     * @param pixelIndex The index of the pixel across all lanes.
+     * @param color The RgbColor to set.
+     */
+    void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
+        if (pixelIndex < numPixels()) {
+            updatePixel(pixelIndex, color);
+        }
+    }
+
+    /**
+     * @brief Gets the color of a pixel, without brightness applied.
+     * @param pixelIndex The index of the pixel across all lanes.
+     * @return The stored color, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < numPixels()) {
+            return _pixels[pixelIndex];
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Gets the number of pixels of all lanes together.
+     * @return The number of pixels.
+     */
+    uint16_t numPixels() const override {
+        return (uint16_t)(_laneCount * _numLedsPerLane);
+    }
+
+    /**
+     * @brief Sets the colors of a range of pixels from an array. Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param colors The colors to set, one per pixel.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            updatePixel(i, colors[i - start]);
+        }
+    }
+
+    /**
+     * @brief Sets a range of pixels to one color. Does not call `show()`.
+     * @param start The index of the first pixel to set.
+     * @param count The number of pixels to set.
+     * @param color The color to set.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            updatePixel(i, color);
+        }
+    }
+
+    /**
+     * @brief Gets direct access to a range of the render buffer and marks it as changed.
+     * @param start The index of the first pixel.
+     * @param count The number of pixels. Clamped to the end of the last lane.
+     * @return The span of stored colors.
+     */
+    LedSpan<RgbColor> getPixelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        markDirty(start, end);
+        return {_pixels + start, (uint16_t)(end - start)};
+    }
+
+    /**
+     * @brief Sets the brightness of all lanes.
+     * The stored colors are not changed; brightness is applied when they are output.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) override {
+        if (brightness == _brightness) {
+            return;
+        }
+        LedStrip::setBrightness(brightness);
+        _scale.setScale(brightness);
+        invalidate();
+        requestShow();
+    }
+
+    /**
+     * @brief Pushes the changed pixels to all lanes.
+     * With a transport, the bit planes of the changed pixel positions are updated
+     * and sent to all lanes at once. Without one, each lane with a changed pixel is
+     * sent in turn. Does nothing if no pixel changed since the last transmission.
+     */
+    void show() override {
+        if (!isDirty()) {
+            LED_STATS_SKIP();
+            return;
+        }
+        if (_numLedsPerLane == 0) {
+            // Nothing to send, and the lanes of the dirty range cannot be computed.
+            clearDirty();
+            return;
+        }
+        uint16_t end = _dirtyEnd < numPixels() ? _dirtyEnd : numPixels();
+        if (_transport) {
+            LED_STATS_SHOW(planeBytes(_numLedsPerLane));
+            _transport->waitIdle();
+            // A dirty range within one lane only touches its positions; otherwise all.
+            uint16_t firstLane = _dirtyFirst / _numLedsPerLane;
+            uint16_t lastLane = (end - 1) / _numLedsPerLane;
+            if (firstLane == lastLane) {
+                encodePlanes(_dirtyFirst % _numLedsPerLane, (end - 1) % _numLedsPerLane + 1);
+            } else {
+                encodePlanes(0, _numLedsPerLane);
+            }
+            _transport->transmit(_planes, planeBytes(_numLedsPerLane));
+        } else {
+            uint8_t firstLane = _dirtyFirst / _numLedsPerLane;
+            uint8_t lastLane = (end - 1) / _numLedsPerLane;
+            LED_STATS_SHOW((lastLane - firstLane + 1) * NeoPixelOutput::storageSize(_numLedsPerLane));
+            for (uint8_t lane = firstLane; lane <= lastLane; lane++) {
+                selectLane(lane);
+                uint16_t laneFirst = lane * _numLedsPerLane;
+                renderCorrected(laneFirst, laneFirst + _numLedsPerLane,
+                                [this, laneFirst](uint16_t first, uint16_t end, const ColorCorrection* correction) {
+                                    _laneOutput.writePixels(_pixels + laneFirst, first - laneFirst, end - laneFirst,
+                                                            _scale.data(), correction);
+                                });
+                _laneOutput.show();
+            }
+        }
+        clearDirty();
+    }
+
+    /**
+     * @brief Sends the bit planes through a parallel transport instead of lane by lane.
+     *
+     * The transport must drive `getLaneCount()` chains from bit-plane frames, e.g. an
+     * Rp2040PioStripTransport constructed with the same lane count, with the lanes on
+     * consecutive GPIOs in the order of the pins passed to this driver.
+     *
+     * @param transport The transport, or `nullptr` to send lane by lane again. Must
+     *                  outlive the driver or be removed before it is destroyed.
+     */
+    void setTransport(StripTransport* transport) {
+        if (_transport) {
+            _transport->waitIdle();
+        }
+        _transport = transport;
+        // The plane buffer doubles as lane buffer without a transport; rebuild it.
+        invalidate();
+    }
+
+    /**
+     * @brief Checks whether a frame is still being sent by the transport.
+     * @return True while an asynchronous transmission is in progress.
+     */
+    bool isBusy() const {
+        return _transport && _transport->isBusy();
+    }
+
+    /**
+     * @brief Blocks until the transport has sent the current frame.
+     */
+    void waitIdle() const {
+        if (_transport) {
+            _transport->waitIdle();
+        }
+    }
+
+    /**
+     * @brief Gets the number of lanes.
+     * @return The number of chains driven by this strip.
+     */
+    uint8_t getLaneCount() const {
+        return _laneCount;
+    }
+
+    /**
+     * @brief Gets the number of pixels of each lane.
+     * @return The number of pixels per chain.
+     */
+    uint16_t getNumLedsPerLane() const {
+        return _numLedsPerLane;
+    }
+
+    /**
+     * @brief Transposes one byte of up to eight lanes into eight bit planes.
+     * @param laneBytes The byte of each lane; lane `k` is `laneBytes[k]`.
+     * @param planes Receives the planes in wire order, MSB first: bit `k` of
+     *               `planes[s]` is bit `7 - s` of `laneBytes[k]`.
+     */
+    static void transposeBits(const uint8_t laneBytes[kMaxLanes], uint8_t planes[8]) {
+        uint64_t x = 0;
+        for (uint8_t lane = 0; lane < kMaxLanes; lane++) {
+            x |= (uint64_t)laneBytes[lane] << (8 * lane);
+        }
+        // 8x8 bit matrix transpose by swapping 1x1, 2x2 and 4x4 blocks.
+        uint64_t t;
+        t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+        x ^= t ^ (t << 28);
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            planes[7 - bit] = (uint8_t)(x >> (8 * bit));
+        }
+    }
+
+private:
+    /**
+     * @brief Clamps a lane count to 1 .. `kMaxLanes`.
+     */
+    static uint8_t clampLanes(uint8_t laneCount) {
+        return laneCount == 0 ? 1 : (laneCount > kMaxLanes ? kMaxLanes : laneCount);
+    }
+
+    /**
+     * @brief Reduces the pixels per lane so that the pixel indices of all lanes fit 16 bits.
+     */
+    static uint16_t clampLedsPerLane(uint8_t laneCount, uint16_t numLedsPerLane) {
+        uint16_t maxLeds = 0xFFFF / clampLanes(laneCount);
+        return numLedsPerLane > maxLeds ? maxLeds : numLedsPerLane;
+    }
+
+    /**
+     * @brief Gets the size of the bit planes: 24 bits per pixel position, one byte per bit.
+     */
+    static size_t planeBytes(uint16_t numLedsPerLane) {
+        return (size_t)numLedsPerLane * 24;
+    }
+
+    /**
+     * @brief Common constructor taking one block of storage for the pins and buffers.
+     */
+    LedParallelStrip(uint8_t* storage, bool ownsStorage, const uint8_t* pins, uint8_t laneCount, uint16_t numLedsPerLane, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _pins(storage), _laneCount(laneCount), _numLedsPerLane(numLedsPerLane),
+          _pixels(reinterpret_cast<RgbColor*>(storage + laneCount)),
+          _planes(storage + laneCount + (size_t)laneCount * numLedsPerLane * sizeof(RgbColor)),
+          _ownsStorage(ownsStorage), _transport(nullptr),
+          _laneOutput(numLedsPerLane, pins[0], NEO_GRB + NEO_KHZ800, _planes) {
+        memcpy(_pins, pins, _laneCount);
+        memset(_pixels, 0, (size_t)_laneCount * _numLedsPerLane * sizeof(RgbColor));
+        memset(_planes, 0, planeBytes(_numLedsPerLane));
+        _laneOutput.begin();
+        for (uint8_t lane = 0; lane < _laneCount; lane++) {
+            pinMode(_pins[lane], OUTPUT);
+            digitalWrite(_pins[lane], LOW);
+        }
+        LED_STATS_GPIO(2 * _laneCount);
+        off();
+    }
+
+    /**
+     * @brief Points the lane output at the pin of a lane.
+     * The library releases the previous pin to an input when the pin changes; it is
+     * driven low again so that the data line of an idle chain does not float.
+     * @param lane The index of the lane.
+     */
+    void selectLane(uint8_t lane) {
+        int16_t previous = _laneOutput.getPin();
+        if (previous == _pins[lane]) {
+            return;
+        }
+        _laneOutput.setPin(_pins[lane]);
+        if (previous >= 0) {
+            pinMode(previous, OUTPUT);
+            digitalWrite(previous, LOW);
+            LED_STATS_GPIO(2);
+        }
+    }
+
+    /**
+     * @brief Stores the color of a pixel and marks it dirty if it changed.
+     * @param pixelIndex The index of the pixel. Must be less than `numPixels()`.
+     * @param color The new color.
+     */
+    void updatePixel(uint16_t pixelIndex, const RgbColor& color) {
+        RgbColor& pixel = _pixels[pixelIndex];
+        if (pixel.r != color.r || pixel.g != color.g || pixel.b != color.b) {
+            pixel = color;
+            markDirty(pixelIndex);
+        }
+    }
+
+    /**
+     * @brief Converts a range of pixel positions of all lanes into bit planes.
+     * @param first The first position within a lane.
+     * @param end One past the last position within a lane.
+     */
+    void encodePlanes(uint16_t first, uint16_t end) {
+        const uint8_t* scale = _scale.data();
+        // Wire order of each pixel is green, red, blue.
+        uint8_t laneBytes[3][kMaxLanes] = {{0}};
+        for (uint16_t position = first; position < end; position++) {
+            for (uint8_t lane = 0; lane < _laneCount; lane++) {
+                uint16_t pixelIndex = lane * _numLedsPerLane + position;
+                RgbColor pixel = _pixels[pixelIndex];
+                const ColorCorrection* correction = correctionAt(pixelIndex);
+                if (correction) {
+                    pixel = correction->apply(pixel);
+                }
+                laneBytes[0][lane] = scale[pixel.g];
+                laneBytes[1][lane] = scale[pixel.r];
+                laneBytes[2][lane] = scale[pixel.b];
+            }
+            uint8_t* planes = _planes + (size_t)position * 24;
+            for (uint8_t channel = 0; channel < 3; channel++) {
+                transposeBits(laneBytes[channel], planes + channel * 8);
+            }
+        }
+    }
+
+    uint8_t* _pins;                 ///< The data pins of the lanes.
+    uint8_t _laneCount;             ///< The number of lanes.
+    uint16_t _numLedsPerLane;       ///< The number of pixels of each lane.
+    RgbColor* _pixels;              ///< Full-precision colors of all lanes, lane after lane.
+    uint8_t* _planes;               ///< Bit planes, 24 bytes per pixel position; lane buffer without a transport.
+    bool _ownsStorage;              ///< True if the storage block was allocated with `new[]` and must be freed.
+    StripTransport* _transport;     ///< Parallel transport, or `nullptr` to send lane by lane.
+    ScaleTable _scale;              ///< Brightness scale applied when converting for output.
+    NeoPixelOutput _laneOutput;     ///< Sends one lane at a time from the start of `_planes`.
+};
+
+#endif // XDUINORAILS_LED_DRIVERS_PARALLEL_STRIP_H
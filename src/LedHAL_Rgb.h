@@ -9,6 +9,8 @@
 #define XDUINORAILS_LED_DRIVERS_RGB_H
 
 #include "Led.h"
+#include "ColorCorrection.h"
+#include "ColorMath.h"
 #include <Arduino.h>
 
 /**
@@ -17,7 +19,8 @@
  *
  * This class implements the Led interface for a 3-pin RGB LED. It uses `analogWrite`
  * on the R, G, and B pins to produce a wide range of colors. Brightness is applied
- * by scaling the color values before writing them to the pins.
+ * by scaling the color values before writing them to the pins. The last duty cycle
+ * written to each pin is shadowed, and only channels whose value changed are written.
  */
 class LedRgb : public Led {
 public:
@@ -44,6 +47,7 @@ public:
         pinMode(_pinR, OUTPUT);
         pinMode(_pinG, OUTPUT);
         pinMode(_pinB, OUTPUT);
+        LED_STATS_GPIO(3);
         off();
     }
 
@@ -81,26 +85,52 @@ public:
         applyColor();
     }
 
+    /**
+     * @brief Sets the output correction and reapplies the current color with it.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        Led::setColorCorrection(correction);
+        applyColor();
+    }
+
 private:
     /**
      * @brief Applies the stored color and brightness to the LED pins.
      * This internal method scales the R, G, and B values by the brightness and
-     * calls `analogWrite`, inverting the logic for common anode LEDs.
+     * writes the channels that changed, inverting the logic for common anode LEDs.
      */
     void applyColor() {
-        uint8_t r = map(_color.r, 0, 255, 0, _brightness);
-        uint8_t g = map(_color.g, 0, 255, 0, _brightness);
-        uint8_t b = map(_color.b, 0, 255, 0, _brightness);
+        RgbColor color = _correction ? _correction->apply(_color) : _color;
+        uint8_t r = ColorMath::scale8(color.r, _brightness);
+        uint8_t g = ColorMath::scale8(color.g, _brightness);
+        uint8_t b = ColorMath::scale8(color.b, _brightness);
 
         if (_isAnode) {
-            analogWrite(_pinR, 255 - r);
-            analogWrite(_pinG, 255 - g);
-            analogWrite(_pinB, 255 - b);
+            writeChannel(0, _pinR, 255 - r);
+            writeChannel(1, _pinG, 255 - g);
+            writeChannel(2, _pinB, 255 - b);
         } else {
-            analogWrite(_pinR, r);
-            analogWrite(_pinG, g);
-            analogWrite(_pinB, b);
+            writeChannel(0, _pinR, r);
+            writeChannel(1, _pinG, g);
+            writeChannel(2, _pinB, b);
+        }
+        _outputValid = true;
+    }
+
+    /**
+     * @brief Writes a duty cycle to a channel pin unless it already has that value.
+     * @param channel The channel index (0 = red, 1 = green, 2 = blue).
+     * @param pin The pin of the channel.
+     * @param value The duty cycle to write.
+     */
+    void writeChannel(uint8_t channel, uint8_t pin, uint8_t value) {
+        if (_outputValid && _output[channel] == value) {
+            return;
         }
+        analogWrite(pin, value);
+        _output[channel] = value;
+        LED_STATS_GPIO(1);
     }
 
     uint8_t _pinR;      ///< GPIO pin for the red element.
@@ -108,6 +138,8 @@ private:
     uint8_t _pinB;      ///< GPIO pin for the blue element.
     bool _isAnode;      ///< True if the LED is common anode.
     RgbColor _color;    ///< The currently set color.
+    uint8_t _output[3] = {0, 0, 0};    ///< The last duty cycles written to the R, G and B pins.
+    bool _outputValid = false;          ///< True once `_output` holds the written values.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_RGB_H
@@ -0,0 +1,542 @@
+/**
+ * @file LedHAL_ShiftMatrix.h
+ * @brief Driver for a scanned LED matrix whose rows and columns hang off 74HC595 shift registers.
+ *
+ * The row and column lines are driven by a chain of daisy-chained shift registers
+ * that is loaded through a hardware SPI port, so a matrix of any size needs only
+ * MOSI, SCK and one latch pin. Like LedMatrix, the display relies on Persistence
+ * of Vision and must be refreshed continuously, either by calling `show()` in a
+ * loop or by a PovRefresh.
+ */
+#ifndef XDUINORAILS_LED_DRIVERS_SHIFT_MATRIX_H
+#define XDUINORAILS_LED_DRIVERS_SHIFT_MATRIX_H
+
+#include "LedStrip.h"
+#include "ColorCorrection.h"
+#include "ColorMath.h"
+#include "LedArena.h"
+#include "PovRefresh.h"
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+
+/**
+ * @class LedShiftMatrix
+ * @brief Concrete class for a row/column scanned LED matrix behind a shift register chain.
+ *
+ * The chain is wired MOSI → column registers → row registers, with the output-enable
+ * inputs tied low. Column `c` is output `Q(c % 8)` of column register `c / 8`,
+ * counted from MOSI, and row `r` is output `Q(r % 8)` of row register `r / 8`. By
+ * default a row is active when its output is LOW and a column LED is on when its
+ * output is HIGH, as with LedMatrix; `setActiveLevels()` changes that.
+ *
+ * The registers have no PWM, so the levels are shown with bit angle modulation. They
+ * are converted into one column word per row and bit, with brightness and correction
+ * applied, whenever they changed; under a PovRefresh this happens when `show()`
+ * commits the frame, so the background scan only shifts out words. A scan step copies
+ * the row select bytes and one column word into the SPI buffer, shifts them out and
+ * pulses the latch, which switches rows and columns at the same instant. During
+ * `show()` the word of the next slot is shifted while the current slot is lit, so the
+ * slot length does not include the transfer. In the background, each row and bit is
+ * one step of the refresh, weighted by the bit's significance; every step latches
+ * one transfer after its start, so the slots keep their binary weights.
+ *
+ * @code
+ * LedShiftMatrix panel(10, 16, 32);   // Latch on pin 10, 16 rows, 32 columns
+ *
+ * void setup() {
+ *   panel.begin();
+ * }
+ * @endcode
+ */
+class LedShiftMatrix : public LedStrip, public PovScanner {
+public:
+    /// Default SPI clock. The 74HC595 shifts at 25 MHz or more at 5 V.
+    static const uint32_t kDefaultClockHz = 8000000;
+
+    /**
+     * @brief Constructor for the LedShiftMatrix driver.
+     * @param latchPin The pin connected to the latch (RCLK) inputs of all registers.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedShiftMatrix(uint8_t latchPin, uint8_t rowCount, uint8_t colCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedShiftMatrix(new uint8_t[storageSize(rowCount, colCount)], true, latchPin, rowCount, colCount, groupId, indexInGroup) {}
+
+    /**
+     * @brief Constructor that places the buffers in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(rowCount, colCount)` bytes available.
+     * @param latchPin The pin connected to the latch (RCLK) inputs of all registers.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedShiftMatrix(LedArena& arena, uint8_t latchPin, uint8_t rowCount, uint8_t colCount, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedShiftMatrix(arena.allocateArray<uint8_t>(storageSize(rowCount, colCount)), false, latchPin, rowCount, colCount, groupId, indexInGroup) {}
+
+    /**
+     * @brief Destructor that cleans up dynamically allocated memory.
+     */
+    ~LedShiftMatrix() {
+        if (_ownsStorage) {
+            delete[] _buffer; // Start of the shared storage block
+        }
+    }
+
+    LedShiftMatrix(const LedShiftMatrix&) = delete;
+    LedShiftMatrix& operator=(const LedShiftMatrix&) = delete;
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * The pixel buffer, column words, row select bytes and SPI buffer share one contiguous block.
+     * @param rowCount The number of rows.
+     * @param colCount The number of columns.
+     * @return The storage size in bytes.
+     */
+    static size_t storageSize(uint8_t rowCount, uint8_t colCount) {
+        size_t rowBytes = ((size_t)rowCount + 7) / 8;
+        size_t colBytes = ((size_t)colCount + 7) / 8;
+        return (size_t)rowCount * colCount + (size_t)rowCount * kMaxBamBits * colBytes + (size_t)rowCount * rowBytes + rowBytes + colBytes;
+    }
+
+    /**
+     * @brief Initializes the SPI port and clears the registers.
+     * Call this from `setup()`; until then, nothing is sent.
+     * @param spi The SPI port whose MOSI and SCK pins drive the chain. It should not be shared
+     *            with other devices while the matrix is scanned in the background.
+     * @param clockHz The SPI clock.
+     */
+    void begin(SPIClass& spi = SPI, uint32_t clockHz = kDefaultClockHz) {
+        _spi = &spi;
+        _settings = SPISettings(clockHz, MSBFIRST, SPI_MODE0);
+        _spi->begin();
+        _begun = true;
+        latchBlank(_rowInvert, _colInvert);
+    }
+
+    /**
+     * @brief Turns all LEDs in the matrix on to the current brightness.
+     */
+    void on() override {
+        memset(_buffer, _brightness, (size_t)_rows * _cols);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Turns all LEDs in the matrix off.
+     */
+    void off() override {
+        memset(_buffer, 0, (size_t)_rows * _cols);
+        _planesDirty = true;
+        // The background scan owns the SPI port and picks up the cleared buffer on commit.
+        if (!isBackgroundScanned()) {
+            latchBlank(_rowInvert, _colInvert);
+        }
+    }
+
+    /**
+     * @brief Sets the brightness of the entire matrix based on a color.
+     * @param color The RgbColor whose luminance will be used to set the brightness.
+     */
+    void setColor(const RgbColor& color) override {
+        uint8_t brightness = (color.r + color.g + color.b) / 3;
+        setBrightness(brightness);
+        if (brightness > 0) {
+            on();
+        } else {
+            off();
+        }
+    }
+
+    /**
+     * @brief Sets the brightness of a single LED in the matrix by row and column.
+     * @param col The column of the LED.
+     * @param row The row of the LED.
+     * @param color The RgbColor to determine the brightness.
+     */
+    void setColor(uint8_t col, uint8_t row, const RgbColor& color) {
+        if (row < _rows && col < _cols) {
+            _buffer[row * _cols + col] = (color.r + color.g + color.b) / 3;
+            _planesDirty = true;
+        }
+    }
+
+    /**
+     * @brief Sets the brightness of a single LED by its linear index.
+     * @param pixelIndex The linear index of the pixel (row * cols + col).
+     * @param color The RgbColor to determine the brightness.
+     */
+    void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
+        if (pixelIndex < numPixels()) {
+            _buffer[pixelIndex] = (color.r + color.g + color.b) / 3;
+            _planesDirty = true;
+        }
+    }
+
+    /**
+     * @brief Gets the brightness of a single LED by its linear index.
+     * @param pixelIndex The linear index of the pixel (row * cols + col).
+     * @return The brightness in all three channels, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < numPixels()) {
+            uint8_t level = _buffer[pixelIndex];
+            return {level, level, level};
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Gets the number of LEDs in the matrix, `rows * cols`.
+     * @return The number of LEDs.
+     */
+    uint16_t numPixels() const override {
+        return (uint16_t)_rows * _cols;
+    }
+
+    /**
+     * @brief Sets the brightness of a range of LEDs from the luminance of an array of colors.
+     * @param start The linear index of the first LED to set.
+     * @param colors The colors to use, one per LED.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            const RgbColor& color = colors[i - start];
+            _buffer[i] = (color.r + color.g + color.b) / 3;
+        }
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Sets a range of LEDs to the luminance of one color.
+     * @param start The linear index of the first LED to set.
+     * @param count The number of LEDs to set.
+     * @param color The color to use.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        memset(_buffer + start, (color.r + color.g + color.b) / 3, end - start);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Gets direct access to a range of the brightness buffer, in row-major order.
+     * This driver stores one level per LED, so `getPixelSpan()` returns an empty span.
+     * The column words are rebuilt on the next scan after each call.
+     * @param start The linear index of the first LED.
+     * @param count The number of LEDs. Clamped to the number of LEDs.
+     * @return The span of stored levels.
+     */
+    LedSpan<uint8_t> getLevelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        if (end == start) {
+            return {nullptr, 0};
+        }
+        _planesDirty = true;
+        return {_buffer + start, (uint16_t)(end - start)};
+    }
+
+    /**
+     * @brief Sets the overall brightness for the matrix.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) override {
+        LedStrip::setBrightness(brightness);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Sets the correction applied to the levels on output.
+     * @param correction The correction, or `nullptr` for linear output.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        LedStrip::setColorCorrection(correction);
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Sets the grayscale depth.
+     * Each `show()` lights the next row for `(2^bits - 1)` slots of `slotMicros`,
+     * e.g. 120 µs at 4 bits and 8 µs, and then turns it off again. A slot should be
+     * at least as long as shifting out one word, about 1 µs per register at 8 MHz.
+     * While scanned in the background, the depth applies from the next committed frame,
+     * and the slots divide the frame period instead: the least significant one lasts
+     * `1 / (rows * (2^bits - 1))` of it, which must also exceed the transfer.
+     * @param bits The grayscale depth, 1 (on/off) to 8. The default is 4.
+     * @param slotMicros The on-time of the least significant bit.
+     */
+    void setBitAngleModulation(uint8_t bits, uint16_t slotMicros = 8) {
+        _bamBits = bits == 0 ? 1 : (bits > kMaxBamBits ? (uint8_t)kMaxBamBits : bits);
+        _bamSlotMicros = slotMicros ? slotMicros : 1;
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Gets the grayscale depth.
+     * @return The number of bits.
+     */
+    uint8_t getBitAngleModulation() const {
+        return _bamBits;
+    }
+
+    /**
+     * @brief Sets the output levels that activate a row and light a column.
+     * While scanned in the background, the levels apply from the next committed frame.
+     * @param rowActiveHigh True if a row is active while its output is HIGH (default false).
+     * @param columnActiveHigh True if a column LED is on while its output is HIGH (default true).
+     */
+    void setActiveLevels(bool rowActiveHigh, bool columnActiveHigh) {
+        _rowInvert = rowActiveHigh ? 0x00 : 0xFF;
+        _colInvert = columnActiveHigh ? 0x00 : 0xFF;
+        _planesDirty = true;
+    }
+
+    /**
+     * @brief Refreshes the display by scanning one row. Call this in a loop.
+     * Lights the next row once per bit, most significant bit first, and turns it off
+     * after the last slot. While the matrix is scanned by a PovRefresh, commits the
+     * buffer as the next frame instead.
+     */
+    void show() override {
+        if (isBackgroundScanned()) {
+            commitScanFrame();
+            return;
+        }
+        if (!_begun) {
+            return;
+        }
+        LED_STATS_SCAN();
+        if (_planesDirty) {
+            buildPlanes();
+        }
+        uint8_t row = _currentRow + 1;
+        _currentRow = row < _rows ? row : 0;
+        shiftWord(_planes, _currentRow, (uint8_t)(_bamBits - 1));
+        for (int8_t bit = _bamBits - 1; bit >= 0; bit--) {
+            latch();
+            unsigned long start = micros();
+            // The registers keep showing the latched slot while the next word is shifted in.
+            if (bit > 0) {
+                shiftWord(_planes, _currentRow, (uint8_t)(bit - 1));
+            } else {
+                shiftBlank(_rowInvert, _colInvert);
+            }
+            unsigned long slot = (unsigned long)_bamSlotMicros << bit;
+            unsigned long elapsed = micros() - start;
+            if (elapsed < slot) {
+                delayMicroseconds((unsigned int)(slot - elapsed));
+            }
+        }
+        // The last slot ends here, not at the next call, so that its weight is exact.
+        latch();
+    }
+
+    /**
+     * @brief Gets the size of a background scan frame: the column words and row select
+     * bytes built from the brightness buffer.
+     * @return `kMaxBamBits` column words and one set of row select bytes per row.
+     */
+    size_t scanFrameBytes() const override {
+        return (size_t)_rows * kMaxBamBits * _colBytes + (size_t)_rows * _rowBytes;
+    }
+
+    /**
+     * @brief Gets the number of background scan steps.
+     * @return One step per row and bit.
+     */
+    uint16_t scanStepCount() const override {
+        return (uint16_t)_rows * _bamBits;
+    }
+
+protected:
+    const uint8_t* scanSource() const override {
+        // The row select bytes follow the column words in the storage block.
+        return _planes;
+    }
+
+    void prepareScanFrame() override {
+        if (_planesDirty) {
+            buildPlanes();
+        }
+        _committed.bits = _bamBits;
+        _committed.rowInvert = _rowInvert;
+        _committed.colInvert = _colInvert;
+    }
+
+    void takeScanFrame() override {
+        _scan = _committed;
+    }
+
+    uint8_t scanStep(const uint8_t* frame, uint16_t step) override {
+        LED_STATS_SCAN();
+        // The words were built when the frame was committed.
+        uint8_t bit = (uint8_t)(_scan.bits - 1 - step % _scan.bits);
+        _currentRow = (uint8_t)(step / _scan.bits);
+        shiftWord(frame, _currentRow, bit);
+        latch();
+        // The bit's weight is the length of the step, so the slot lasts until the next latch.
+        return 255;
+    }
+
+    uint16_t scanStepWeight(uint16_t step) const override {
+        return (uint16_t)(1 << (_scan.bits - 1 - step % _scan.bits));
+    }
+
+    void scanBlank() override {
+        latchBlank(_scan.rowInvert, _scan.colInvert);
+    }
+
+private:
+    /// The largest grayscale depth of bit angle modulation.
+    static const uint8_t kMaxBamBits = 8;
+
+    /**
+     * @struct ScanSettings
+     * @brief The settings a background scan frame is committed with.
+     */
+    struct ScanSettings {
+        uint8_t bits;       ///< Grayscale depth of bit angle modulation.
+        uint8_t rowInvert;  ///< XOR mask from row select bits to outputs.
+        uint8_t colInvert;  ///< XOR mask from column bits to outputs.
+    };
+
+    /**
+     * @brief Gets the offset of the column word of a row for one bit of the level, in shift order.
+     */
+    size_t planeOffset(uint8_t row, uint8_t bit) const {
+        return ((size_t)row * kMaxBamBits + bit) * _colBytes;
+    }
+
+    /**
+     * @brief Converts the brightness buffer into column words and the row select bytes,
+     * with brightness, correction and output levels applied.
+     */
+    void buildPlanes() {
+        _planesDirty = false;
+        uint8_t shift = kMaxBamBits - _bamBits;
+        for (uint8_t row = 0; row < _rows; row++) {
+            for (uint8_t bit = 0; bit < _bamBits; bit++) {
+                memset(_planes + planeOffset(row, bit), 0, _colBytes);
+            }
+            for (uint8_t c = 0; c < _cols; c++) {
+                uint8_t level = _buffer[row * _cols + c];
+                if (_correction) {
+                    level = _correction->level(level);
+                }
+                uint8_t value = ColorMath::scale8(level, _brightness) >> shift;
+                // The register nearest to MOSI is shifted last.
+                uint8_t index = (uint8_t)(_colBytes - 1 - (c >> 3));
+                uint8_t mask = (uint8_t)(1 << (c & 7));
+                for (uint8_t bit = 0; value; bit++, value >>= 1) {
+                    if (value & 1) {
+                        _planes[planeOffset(row, bit) + index] |= mask;
+                    }
+                }
+            }
+            for (uint8_t bit = 0; bit < _bamBits; bit++) {
+                uint8_t* word = _planes + planeOffset(row, bit);
+                for (uint8_t i = 0; i < _colBytes; i++) {
+                    word[i] ^= _colInvert;
+                }
+            }
+            uint8_t* select = _rowSelect + (size_t)row * _rowBytes;
+            memset(select, _rowInvert, _rowBytes);
+            select[_rowBytes - 1 - (row >> 3)] ^= (uint8_t)(1 << (row & 7));
+        }
+    }
+
+    /**
+     * @brief Shifts out the row select bytes and one column word of a row, without latching them.
+     * @param words The column words followed by the row select bytes, `_planes` or a scan frame.
+     */
+    void shiftWord(const uint8_t* words, uint8_t row, uint8_t bit) {
+        const uint8_t* rowSelect = words + (size_t)_rows * kMaxBamBits * _colBytes;
+        memcpy(_word, rowSelect + (size_t)row * _rowBytes, _rowBytes);
+        memcpy(_word + _rowBytes, words + planeOffset(row, bit), _colBytes);
+        transferWord();
+    }
+
+    /**
+     * @brief Shifts out a word with all rows inactive and all columns off, without latching it.
+     * @param rowInvert The XOR mask from row select bits to outputs.
+     * @param colInvert The XOR mask from column bits to outputs.
+     */
+    void shiftBlank(uint8_t rowInvert, uint8_t colInvert) {
+        memset(_word, rowInvert, _rowBytes);
+        memset(_word + _rowBytes, colInvert, _colBytes);
+        transferWord();
+    }
+
+    /**
+     * @brief Shifts out and latches a word with all rows inactive, if the SPI port is initialized.
+     * @param rowInvert The XOR mask from row select bits to outputs.
+     * @param colInvert The XOR mask from column bits to outputs.
+     */
+    void latchBlank(uint8_t rowInvert, uint8_t colInvert) {
+        if (_begun) {
+            shiftBlank(rowInvert, colInvert);
+            latch();
+        }
+    }
+
+    /**
+     * @brief Sends the SPI buffer. The port overwrites it with the received bytes.
+     */
+    void transferWord() {
+        _spi->beginTransaction(_settings);
+        _spi->transfer(_word, (size_t)_rowBytes + _colBytes);
+        _spi->endTransaction();
+    }
+
+    /**
+     * @brief Copies the shifted word to the register outputs on the rising edge of the latch.
+     */
+    void latch() {
+        digitalWrite(_latchPin, HIGH);
+        digitalWrite(_latchPin, LOW);
+        LED_STATS_GPIO(2);
+    }
+
+    /**
+     * @brief Common constructor taking one block of storage for all buffers.
+     */
+    LedShiftMatrix(uint8_t* storage, bool ownsStorage, uint8_t latchPin, uint8_t rowCount, uint8_t colCount, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _rows(rowCount), _cols(colCount), _latchPin(latchPin),
+          _rowBytes((uint8_t)((rowCount + 7) / 8)), _colBytes((uint8_t)((colCount + 7) / 8)), _ownsStorage(ownsStorage),
+          _buffer(storage), _planes(_buffer + (size_t)rowCount * colCount),
+          _rowSelect(_planes + (size_t)rowCount * kMaxBamBits * _colBytes), _word(_rowSelect + (size_t)rowCount * _rowBytes) {
+        memset(_buffer, 0, (size_t)_rows * _cols);
+        pinMode(_latchPin, OUTPUT);
+        digitalWrite(_latchPin, LOW);
+        LED_STATS_GPIO(2);
+    }
+
+    uint8_t _rows;          ///< Number of rows in the matrix.
+    uint8_t _cols;          ///< Number of columns in the matrix.
+    uint8_t _latchPin;      ///< The pin connected to the latch inputs.
+    uint8_t _rowBytes;      ///< Number of row registers.
+    uint8_t _colBytes;      ///< Number of column registers.
+    bool _ownsStorage;      ///< True if the storage block was allocated with `new[]` and must be freed.
+    uint8_t* _buffer;       ///< Internal buffer storing the brightness of each LED.
+    uint8_t* _planes;       ///< Column words for bit angle modulation, `kMaxBamBits` per row.
+    uint8_t* _rowSelect;    ///< The row register bytes that activate each row.
+    uint8_t* _word;         ///< The word being shifted out, row registers first.
+    SPIClass* _spi = &SPI;  ///< The SPI port driving the chain.
+    SPISettings _settings;  ///< Clock, bit order and mode of the transfers.
+    uint8_t _currentRow = 0;        ///< The row currently being scanned.
+    uint8_t _bamBits = 4;           ///< Grayscale depth of bit angle modulation.
+    uint16_t _bamSlotMicros = 8;    ///< On-time of the least significant bit.
+    uint8_t _rowInvert = 0xFF;      ///< XOR mask from row select bits to outputs; rows are active LOW by default.
+    uint8_t _colInvert = 0x00;      ///< XOR mask from column bits to outputs.
+    bool _planesDirty = true;       ///< True when the column words are out of date.
+    bool _begun = false;            ///< True once `begin()` has initialized the SPI port.
+    ScanSettings _committed = {4, 0xFF, 0x00};  ///< Settings staged with the committed frame.
+    ScanSettings _scan = {4, 0xFF, 0x00};       ///< Settings of the frame being scanned.
+};
+
+#endif // XDUINORAILS_LED_DRIVERS_SHIFT_MATRIX_H
@@ -9,6 +9,7 @@
 #define XDUINORAILS_LED_DRIVERS_SINGLE_H
 
 #include "Led.h"
+#include "ColorCorrection.h"
 #include <Arduino.h>
 
 /**
@@ -18,6 +19,8 @@
  * This class implements the Led interface to control a single LED. It uses
  * `digitalWrite` to turn the LED on/off and `analogWrite` (PWM) to control its
  * brightness. It supports both common anode and common cathode wiring.
+ * The last value written to the pin is shadowed, so repeated calls with an
+ * unchanged state do not touch the pin.
  */
 class LedSingle : public Led {
 public:
@@ -31,6 +34,7 @@ public:
     LedSingle(uint8_t pin, uint8_t groupId = 0, uint16_t indexInGroup = 0, bool isAnode = true)
         : Led(groupId, indexInGroup), _pin(pin), _isAnode(isAnode) {
         pinMode(_pin, OUTPUT);
+        LED_STATS_GPIO(1);
         off();
     }
 
@@ -39,10 +43,12 @@ public:
      * Uses `analogWrite` to control the LED's brightness via PWM.
      */
     void on() override {
-        if (_isAnode) {
-            analogWrite(_pin, _brightness);
-        } else {
-            analogWrite(_pin, 255 - _brightness);
+        uint8_t level = _correction ? _correction->level(_brightness) : _brightness;
+        uint8_t value = _isAnode ? level : 255 - level;
+        if (_output != value) {
+            analogWrite(_pin, value);
+            _output = value;
+            LED_STATS_GPIO(1);
         }
     }
 
@@ -50,7 +56,11 @@ public:
      * @brief Turns the LED off.
      */
     void off() override {
-        digitalWrite(_pin, _isAnode ? LOW : HIGH);
+        if (_output != OUTPUT_OFF) {
+            digitalWrite(_pin, _isAnode ? LOW : HIGH);
+            _output = OUTPUT_OFF;
+            LED_STATS_GPIO(1);
+        }
     }
 
     /**
@@ -79,9 +89,29 @@ public:
         }
     }
 
+    /**
+     * @brief Sets the output correction and rewrites the output if the LED is on.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        Led::setColorCorrection(correction);
+        if (_output != OUTPUT_OFF && _output != OUTPUT_UNKNOWN) {
+            on();
+        }
+    }
+
 private:
+    /**
+     * @brief Shadow values besides the PWM duty cycles 0-255.
+     */
+    enum : uint16_t {
+        OUTPUT_OFF = 0x100,         ///< The pin was driven to the off level with `digitalWrite()`.
+        OUTPUT_UNKNOWN = 0xFFFF     ///< The pin has not been written yet.
+    };
+
     uint8_t _pin;     ///< The GPIO pin connected to the LED.
     bool _isAnode;    ///< True if the LED is common anode, false for common cathode.
+    uint16_t _output = OUTPUT_UNKNOWN;  ///< The last value written to the pin.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_SINGLE_H
@@ -10,7 +10,9 @@
 #define XDUINORAILS_LED_DRIVERS_WS2811_3X1_H
 
 #include "LedStrip.h"
-#include <Adafruit_NeoPixel.h>
+#include "LedArena.h"
+#include "NeoPixelOutput.h"
+#include "ScaleTable.h"
 
 /**
  * @class LedWs2811_3x1
@@ -20,6 +22,9 @@
  * LEDs. When a color is set, its luminance is calculated and applied equally to the
  * R, G, and B channels of the underlying NeoPixel driver. This effectively treats
  * the WS2811 as a 3-channel PWM driver for three separate LEDs.
+ *
+ * The level of each IC is kept at full precision in a separate buffer. Brightness
+ * is applied through a scale table only when the levels are converted for output.
  */
 class LedWs2811_3x1 : public LedStrip {
 public:
@@ -31,11 +36,41 @@ public:
      * @param indexInGroup An optional index within the group.
      */
     LedWs2811_3x1(uint8_t pin, uint16_t numLeds, uint8_t groupId = 0, uint16_t indexInGroup = 0)
-        : LedStrip(groupId, indexInGroup), _numLeds(numLeds), _strip(numLeds, pin, NEO_GRB + NEO_KHZ800) {
+        : LedStrip(groupId, indexInGroup), _numLeds(numLeds), _levels(new uint8_t[numLeds]()), _ownsStorage(true),
+          _strip(numLeds, pin, NEO_GRB + NEO_KHZ800) {
         _strip.begin();
         off();
     }
 
+    /**
+     * @brief Constructor that places the pixel buffer in an arena instead of the heap.
+     * @param arena The arena to allocate from. Must have `storageSize(numLeds)` bytes available.
+     * @param pin The Arduino pin connected to the WS2811 data line.
+     * @param numLeds The number of WS2811 ICs (pixels) in the chain.
+     * @param groupId An optional ID for grouping LEDs.
+     * @param indexInGroup An optional index within the group.
+     */
+    LedWs2811_3x1(LedArena& arena, uint8_t pin, uint16_t numLeds, uint8_t groupId = 0, uint16_t indexInGroup = 0)
+        : LedWs2811_3x1(arena.allocateArray<uint8_t>(storageSize(numLeds)), pin, numLeds, groupId, indexInGroup) {}
+
+    /**
+     * @brief Destructor that cleans up the dynamically allocated level buffer.
+     */
+    ~LedWs2811_3x1() {
+        if (_ownsStorage) {
+            delete[] _levels;
+        }
+    }
+
+    /**
+     * @brief Gets the number of buffer bytes the driver needs besides the object itself.
+     * @param numLeds The number of WS2811 ICs (pixels) in the chain.
+     * @return The storage size in bytes: the output buffer followed by the level buffer.
+     */
+    static size_t storageSize(uint16_t numLeds) {
+        return NeoPixelOutput::storageSize(numLeds) + numLeds;
+    }
+
     /**
      * @brief Turns all connected LEDs on to maximum brightness.
      */
@@ -56,56 +91,198 @@ public:
      * @param color The RgbColor to use for brightness calculation.
      */
     void setColor(const RgbColor& color) override {
-        uint8_t brightness = (uint8_t)(((uint16_t)color.r * 77 + (uint16_t)color.g * 150 + (uint16_t)color.b * 29) >> 8);
+        uint8_t brightness = luminance(color);
         for (uint16_t i = 0; i < _numLeds; i++) {
-            _strip.setPixelColor(i, brightness, brightness, brightness);
+            updateLevel(i, brightness);
         }
-        show();
+        requestShow();
     }
 
     /**
      * @brief Sets the brightness of a single WS2811 IC's LEDs.
+     * Does not call `show()`.
      * @param pixelIndex The index of the WS2811 IC to control.
      * @param color The RgbColor to use for brightness calculation.
      */
     void setPixelColor(uint16_t pixelIndex, const RgbColor& color) override {
         if (pixelIndex < _numLeds) {
-            uint8_t brightness = (uint8_t)(((uint16_t)color.r * 77 + (uint16_t)color.g * 150 + (uint16_t)color.b * 29) >> 8);
-            _strip.setPixelColor(pixelIndex, brightness, brightness, brightness);
-            show();
+            updateLevel(pixelIndex, luminance(color));
+        }
+    }
+
+    /**
+     * @brief Gets the level of an IC, without brightness applied.
+     * @param pixelIndex The index of the WS2811 IC.
+     * @return The level in all three channels, or black if the index is out of range.
+     */
+    RgbColor getPixelColor(uint16_t pixelIndex) const override {
+        if (pixelIndex < _numLeds) {
+            uint8_t level = _levels[pixelIndex];
+            return {level, level, level};
+        }
+        return {0, 0, 0};
+    }
+
+    /**
+     * @brief Sets the levels of a range of ICs from the luminance of an array of colors.
+     * Does not call `show()`.
+     * @param start The index of the first IC to set.
+     * @param colors The colors to use, one per IC.
+     * @param count The number of elements in `colors`.
+     */
+    void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        for (uint16_t i = start; i < end; i++) {
+            updateLevel(i, luminance(colors[i - start]));
+        }
+    }
+
+    /**
+     * @brief Sets a range of ICs to the luminance of one color.
+     * Does not call `show()`.
+     * @param start The index of the first IC to set.
+     * @param count The number of ICs to set.
+     * @param color The color to use.
+     */
+    void fill(uint16_t start, uint16_t count, const RgbColor& color) override {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        uint8_t level = luminance(color);
+        for (uint16_t i = start; i < end; i++) {
+            updateLevel(i, level);
+        }
+    }
+
+    /**
+     * @brief Gets direct access to a range of the level buffer and marks it as changed.
+     * This driver stores one level per IC, so `getPixelSpan()` returns an empty span.
+     * @param start The index of the first IC.
+     * @param count The number of ICs. Clamped to the end of the chain.
+     * @return The span of stored levels, without brightness applied.
+     */
+    LedSpan<uint8_t> getLevelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) {
+        uint16_t end = rangeEnd(start, count, _numLeds);
+        if (end == start) {
+            return {nullptr, 0};
         }
+        markDirty(start, end);
+        return {_levels + start, (uint16_t)(end - start)};
     }
 
     /**
      * @brief Sets the brightness for all LEDs connected to all ICs.
+     * The stored levels are not changed; brightness scales them when they are output.
+     * Setting the current brightness again has no effect.
      * @param brightness The brightness level (0-255).
      */
     void setBrightness(uint8_t brightness) override {
-        LedStrip::setBrightness(brightness);
-        for (uint16_t i = 0; i < _numLeds; i++) {
-            _strip.setPixelColor(i, _brightness, _brightness, _brightness);
+        if (brightness == _brightness) {
+            return;
         }
-        _strip.show();
+        LedStrip::setBrightness(brightness);
+        _scale.setScale(brightness);
+        invalidate();
+        requestShow();
     }
 
     /**
      * @brief Pushes the current color data to the physical WS2811 ICs.
+     * Does nothing if no pixel changed since the last transmission. With truncated
+     * shows enabled, only the pixels up to the highest changed one are transmitted.
+     * With a transport (@see setTransport()), the transmission runs in the background.
      */
     void show() override {
-        _strip.show();
+        if (!isDirty()) {
+            LED_STATS_SKIP();
+            return;
+        }
+        uint16_t length = showLength(_numLeds);
+        LED_STATS_SHOW(NeoPixelOutput::storageSize(length));
+        _strip.waitIdle();
+        renderCorrected(_dirtyFirst, _dirtyEnd < _numLeds ? _dirtyEnd : _numLeds,
+                        [this](uint16_t first, uint16_t end, const ColorCorrection* correction) {
+                            _strip.writeLevels(_levels, first, end, _scale.data(), correction);
+                        });
+        _strip.transmit(length);
+        clearDirty();
+    }
+
+    /**
+     * @brief Sends frames through a background transport instead of the Adafruit library.
+     *
+     * With a transport, `show()` converts the frame into the output buffer, hands it
+     * to the transport and returns without waiting for the transmission. The next
+     * `show()` waits only if the previous frame is still being sent. Rendering into
+     * the driver is not affected, because it uses a separate buffer.
+     *
+     * @param transport The transport, or `nullptr` to transmit through the library
+     *                  again. Must outlive the driver or be removed before it is destroyed.
+     */
+    void setTransport(StripTransport* transport) {
+        _strip.setTransport(transport);
+    }
+
+    /**
+     * @brief Checks whether a frame is still being sent by the transport.
+     * @return True while an asynchronous transmission is in progress.
+     */
+    bool isBusy() const {
+        return _strip.isBusy();
+    }
+
+    /**
+     * @brief Blocks until the transport has sent the current frame.
+     */
+    void waitIdle() const {
+        _strip.waitIdle();
     }
 
     /**
      * @brief Gets the number of WS2811 ICs (pixels) in the chain.
      * @return The number of pixels.
      */
-    uint16_t numPixels() const {
-        return _strip.numPixels();
+    uint16_t numPixels() const override {
+        return _numLeds;
     }
 
 private:
+    /**
+     * @brief Common constructor for the arena, taking one block for both buffers.
+     */
+    LedWs2811_3x1(uint8_t* storage, uint8_t pin, uint16_t numLeds, uint8_t groupId, uint16_t indexInGroup)
+        : LedStrip(groupId, indexInGroup), _numLeds(numLeds),
+          _levels(storage + NeoPixelOutput::storageSize(numLeds)), _ownsStorage(false),
+          _strip(numLeds, pin, NEO_GRB + NEO_KHZ800, storage) {
+        memset(_levels, 0, numLeds);
+        _strip.begin();
+        off();
+    }
+
+    /**
+     * @brief Calculates the perceived luminance of a color.
+     * @param color The color.
+     * @return The weighted sum 0.30 R + 0.59 G + 0.11 B, as a level (0-255).
+     */
+    static uint8_t luminance(const RgbColor& color) {
+        return (uint8_t)(((uint16_t)color.r * 77 + (uint16_t)color.g * 150 + (uint16_t)color.b * 29) >> 8);
+    }
+
+    /**
+     * @brief Stores the level of an IC and marks it dirty if it changed.
+     * @param pixelIndex The index of the IC. Must be less than `_numLeds`.
+     * @param level The new level.
+     */
+    void updateLevel(uint16_t pixelIndex, uint8_t level) {
+        if (_levels[pixelIndex] != level) {
+            _levels[pixelIndex] = level;
+            markDirty(pixelIndex);
+        }
+    }
+
     uint16_t _numLeds;          ///< The number of WS2811 ICs in the chain.
-    Adafruit_NeoPixel _strip;   ///< The underlying Adafruit_NeoPixel object.
+    uint8_t* _levels;           ///< Full-precision level of every IC.
+    bool _ownsStorage;          ///< True if `_levels` was allocated with `new[]` and must be freed.
+    ScaleTable _scale;          ///< Brightness scale applied when converting for output.
+    NeoPixelOutput _strip;      ///< The underlying Adafruit_NeoPixel object.
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_WS2811_3X1_H
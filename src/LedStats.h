@@ -0,0 +1,128 @@
+/**
+ * @file LedStats.h
+ * @brief Optional runtime instrumentation of the LED drivers.
+ *
+ * Instrumentation is disabled by default and then compiles to nothing: the drivers
+ * carry no extra members and execute no extra code. To enable it, define
+ * `XDUINORAILS_LED_STATS` to 1 before including any header of this library, e.g.
+ * at the top of the sketch:
+ *
+ * @code
+ * #define XDUINORAILS_LED_STATS 1
+ * #include <ArduinoLedDriverHAL.h>
+ * @endcode
+ *
+ * Each driver then counts its `show()` calls, the bytes pushed to strips, its GPIO
+ * calls, the time spent in `show()`, and shows that were skipped because nothing
+ * changed since the previous one. The HAL aggregates the counters of all drivers.
+ */
+#ifndef XDUINORAILS_LED_STATS_H
+#define XDUINORAILS_LED_STATS_H
+
+#ifndef XDUINORAILS_LED_STATS
+#define XDUINORAILS_LED_STATS 0
+#endif
+
+#if XDUINORAILS_LED_STATS
+
+#include <Arduino.h>
+
+/**
+ * @struct LedStats
+ * @brief Counters collected by a driver, or aggregated over several drivers.
+ */
+struct LedStats {
+    uint32_t showCalls = 0;         ///< Number of `show()` calls (scan steps for POV drivers).
+    uint32_t redundantShows = 0;    ///< Strip shows skipped because nothing changed since the previous show.
+    uint32_t bytesPushed = 0;       ///< Bytes transmitted to addressable strips.
+    uint32_t gpioWrites = 0;        ///< Calls to `pinMode`, `digitalWrite` and `analogWrite`.
+    uint32_t showMicrosTotal = 0;   ///< Cumulative time spent in `show()`, in microseconds.
+    uint32_t showMicrosMax = 0;     ///< Longest single `show()`, in microseconds.
+
+    /**
+     * @brief Adds the counters of another driver to this snapshot.
+     * The maximum show time becomes the larger of both.
+     * @param other The counters to add.
+     */
+    void add(const LedStats& other) {
+        showCalls += other.showCalls;
+        redundantShows += other.redundantShows;
+        bytesPushed += other.bytesPushed;
+        gpioWrites += other.gpioWrites;
+        showMicrosTotal += other.showMicrosTotal;
+        if (other.showMicrosMax > showMicrosMax) {
+            showMicrosMax = other.showMicrosMax;
+        }
+    }
+
+    /**
+     * @brief Prints the counters on one line, e.g. to `Serial`.
+     * @param out The stream to print to.
+     */
+    void printTo(Print& out) const {
+        out.print("shows=");
+        out.print(showCalls);
+        out.print(" redundant=");
+        out.print(redundantShows);
+        out.print(" bytes=");
+        out.print(bytesPushed);
+        out.print(" gpio=");
+        out.print(gpioWrites);
+        out.print(" us_total=");
+        out.print(showMicrosTotal);
+        out.print(" us_max=");
+        out.println(showMicrosMax);
+    }
+};
+
+/**
+ * @class LedShowTimer
+ * @brief Scope guard that accounts one `show()` call in a LedStats record.
+ */
+class LedShowTimer {
+public:
+    /**
+     * @brief Counts the call and starts timing it.
+     * @param stats The record to update.
+     * @param bytes The number of bytes the call transmits.
+     */
+    LedShowTimer(LedStats& stats, uint32_t bytes) : _stats(stats), _start(micros()) {
+        _stats.showCalls++;
+        _stats.bytesPushed += bytes;
+    }
+
+    /**
+     * @brief Adds the elapsed time to the record.
+     */
+    ~LedShowTimer() {
+        uint32_t elapsed = (uint32_t)micros() - _start;
+        _stats.showMicrosTotal += elapsed;
+        if (elapsed > _stats.showMicrosMax) {
+            _stats.showMicrosMax = elapsed;
+        }
+    }
+
+private:
+    LedStats& _stats;   ///< The record to update.
+    uint32_t _start;    ///< micros() at the start of the call.
+};
+
+/// Accounts the enclosing strip `show()` transmitting `bytes` bytes.
+#define LED_STATS_SHOW(bytes) LedShowTimer ledShowTimer_(_stats, (bytes))
+/// Accounts a strip `show()` that was skipped because nothing changed.
+#define LED_STATS_SKIP() (_stats.showCalls++, _stats.redundantShows++)
+/// Accounts the enclosing POV scan step. Use as first statement.
+#define LED_STATS_SCAN() LedShowTimer ledShowTimer_(_stats, 0)
+/// Adds `count` GPIO calls.
+#define LED_STATS_GPIO(count) (_stats.gpioWrites += (count))
+
+#else
+
+#define LED_STATS_SHOW(bytes) do {} while (0)
+#define LED_STATS_SKIP() do {} while (0)
+#define LED_STATS_SCAN() do {} while (0)
+#define LED_STATS_GPIO(count) do {} while (0)
+
+#endif // XDUINORAILS_LED_STATS
+
+#endif // XDUINORAILS_LED_STATS_H
@@ -10,6 +10,39 @@
 #define XDUINORAILS_LED_STRIP_H
 
 #include "Led.h"
+#include "ColorHsv.h"
+#include "ColorMath.h"
+
+/**
+ * @struct LedSpan
+ * @brief A view of a contiguous range of a driver's pixel buffer.
+ *
+ * Returned by the framebuffer accessors of the strip drivers. An empty span
+ * (`data == nullptr`) means the driver has no buffer of the requested type.
+ *
+ * @tparam T The element type of the buffer, e.g. RgbColor or a uint8_t level.
+ */
+template <typename T>
+struct LedSpan {
+    T* data;        ///< The first element of the range, or `nullptr` if empty.
+    uint16_t size;  ///< The number of elements in the range.
+
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    T& operator[](uint16_t index) const { return data[index]; }
+};
+
+/**
+ * @struct LedSegmentCorrection
+ * @brief An output correction for a range of pixels of a strip.
+ * @see LedStrip::setSegmentCorrections()
+ */
+struct LedSegmentCorrection {
+    uint16_t first;                     ///< The first pixel of the segment.
+    uint16_t count;                     ///< The number of pixels of the segment.
+    const ColorCorrection* correction;  ///< The correction, or `nullptr` for linear output.
+};
 
 /**
  * @class LedStrip
@@ -19,6 +52,17 @@
  * drivers that control addressable LED strips (e.g., NeoPixel, WS2811). It
  * introduces methods to set the color of individual pixels and a `show()` method
  * to update the physical strip with the new color data.
+ *
+ * The base class also tracks which pixels changed since the last transmission.
+ * Drivers mark changed pixels with `markDirty()` and skip `show()` while nothing
+ * is dirty, so calling `show()` on a static strip costs almost nothing.
+ *
+ * WS281x chains keep the data of pixels that receive nothing in a transmission.
+ * With truncated shows enabled, drivers of such chains only transmit up to the
+ * highest dirty pixel, so a change near the start of a long chain is fast.
+ *
+ * Besides single pixels, whole ranges can be written with `setPixels()` and
+ * `fill()`, or rendered directly into the driver's buffer via `getPixelSpan()`.
  */
 class LedStrip : public Led {
 public:
@@ -39,6 +83,143 @@ public:
      */
     virtual void setPixelColor(uint16_t pixelIndex, const RgbColor& color) = 0;
 
+    /**
+     * @brief Gets the color of a single pixel from the driver's buffer.
+     * Drivers that store a single level per pixel return it in all three channels.
+     * @param pixelIndex The zero-based index of the pixel.
+     * @return The color of the pixel, or black if the index is out of range.
+     */
+    virtual RgbColor getPixelColor(uint16_t pixelIndex) const = 0;
+
+    /**
+     * @brief Gets the number of pixels of the strip.
+     * @return The number of pixels.
+     */
+    virtual uint16_t numPixels() const = 0;
+
+    /**
+     * @brief Sets the colors of a range of pixels from an array.
+     * Pixels beyond the end of the strip are ignored. Like `setPixelColor()`, the
+     * change is not sent to the hardware until `show()` is called.
+     * @param start The index of the first pixel to set.
+     * @param colors The colors to set, one per pixel.
+     * @param count The number of elements in `colors`.
+     */
+    virtual void setPixels(uint16_t start, const RgbColor* colors, uint16_t count) {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            setPixelColor(i, colors[i - start]);
+        }
+    }
+
+    /**
+     * @brief Sets a range of pixels to one color.
+     * Pixels beyond the end of the strip are ignored. Like `setPixelColor()`, the
+     * change is not sent to the hardware until `show()` is called.
+     * @param start The index of the first pixel to set.
+     * @param count The number of pixels to set.
+     * @param color The color to set.
+     */
+    virtual void fill(uint16_t start, uint16_t count, const RgbColor& color) {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        for (uint16_t i = start; i < end; i++) {
+            setPixelColor(i, color);
+        }
+    }
+
+    /**
+     * @brief Gets direct access to a range of the driver's color buffer.
+     *
+     * Effect code can render straight into the returned span instead of calling
+     * `setPixelColor()` per pixel. The range is marked as changed, so the next
+     * `show()` outputs whatever was written; request only the range you render.
+     * The span stays valid for the lifetime of the driver.
+     *
+     * @param start The index of the first pixel.
+     * @param count The number of pixels. Clamped to the end of the strip.
+     * @return The span, or an empty span if the driver has no RgbColor buffer.
+     */
+    virtual LedSpan<RgbColor> getPixelSpan(uint16_t start = 0, uint16_t count = 0xFFFF) {
+        (void)start;
+        (void)count;
+        return {nullptr, 0};
+    }
+
+    /**
+     * @brief Dims all pixels, e.g. to let the trail of a moving light fade out.
+     * Like `setPixelColor()`, the change is not sent to the hardware until `show()` is called.
+     * @param fadeBy The amount to dim by; 0 leaves the pixels unchanged, 255 turns them black.
+     */
+    void fadeToBlack(uint8_t fadeBy) {
+        LedSpan<RgbColor> span = getPixelSpan();
+        if (!span.empty()) {
+            ColorMath::fadeToBlack(span.data, span.size, fadeBy);
+            return;
+        }
+        uint16_t count = numPixels();
+        for (uint16_t i = 0; i < count; i++) {
+            setPixelColor(i, ColorMath::scale8(getPixelColor(i), (uint8_t)(255 - fadeBy)));
+        }
+    }
+
+    /**
+     * @brief Fills a range of pixels with hues that advance by a fixed step.
+     *
+     * The colors are rendered straight into the driver's buffer in one pass. They are
+     * linear; use a ColorCorrection for gamma. Like `setPixelColor()`, the change is
+     * not sent to the hardware until `show()` is called.
+     *
+     * @param start The index of the first pixel.
+     * @param count The number of pixels. Clamped to the end of the strip.
+     * @param hueStart The hue of the first pixel, 0 to 65535 around the circle starting at red.
+     * @param hueStep The hue difference between neighbors, e.g. `65536 / count` for one full circle.
+     * @param sat The saturation; 0 is white, 255 the pure hue.
+     * @param val The value; 0 is black.
+     */
+    void fillRainbow(uint16_t start, uint16_t count, uint16_t hueStart, uint16_t hueStep, uint8_t sat = 255,
+                     uint8_t val = 255) {
+        LedSpan<RgbColor> span = getPixelSpan(start, count);
+        if (!span.empty()) {
+            ColorMath::fillRainbow(span.data, span.size, hueStart, hueStep, sat, val);
+            return;
+        }
+        uint16_t end = rangeEnd(start, count, numPixels());
+        RgbColor chunk[kFillChunk];
+        for (uint16_t i = start; i < end;) {
+            uint16_t n = (end - i < kFillChunk) ? end - i : kFillChunk;
+            ColorMath::fillRainbow(chunk, n, hueStart, hueStep, sat, val);
+            setPixels(i, chunk, n);
+            hueStart += (uint16_t)(hueStep * n);
+            i += n;
+        }
+    }
+
+    /**
+     * @brief Fills a range of pixels with a gradient between two HSV colors.
+     * The hue takes the shorter way around the circle (@see HsvGradient). Like
+     * `setPixelColor()`, the change is not sent to the hardware until `show()` is called.
+     * @param start The index of the first pixel.
+     * @param count The number of pixels. Clamped to the end of the strip.
+     * @param from The color of the first pixel.
+     * @param to The color of the last pixel.
+     */
+    void fillGradient(uint16_t start, uint16_t count, const HsvColor& from, const HsvColor& to) {
+        uint16_t end = rangeEnd(start, count, numPixels());
+        HsvGradient gradient(from, to, end - start);
+        LedSpan<RgbColor> span = getPixelSpan(start, count);
+        if (!span.empty()) {
+            gradient.fill(span.data, span.size);
+            return;
+        }
+        RgbColor chunk[kFillChunk];
+        for (uint16_t i = start; i < end;) {
+            uint16_t n = (end - i < kFillChunk) ? end - i : kFillChunk;
+            gradient.fill(chunk, n);
+            setPixels(i, chunk, n);
+            i += n;
+        }
+    }
+
     /**
      * @brief Pushes the current color data to the physical LED strip.
      *
@@ -59,6 +240,214 @@ public:
     void setBrightness(uint8_t brightness) override {
         _brightness = brightness;
     }
+
+    /**
+     * @brief Sets the output correction and re-sends the whole strip with it.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        Led::setColorCorrection(correction);
+        invalidate();
+        requestShow();
+    }
+
+    /**
+     * @brief Sets different output corrections for parts of the strip.
+     *
+     * Strips assembled from LEDs of different batches can give each segment its own
+     * calibrated correction (@see ColorCorrection). Pixels outside all segments use the
+     * correction set with `setColorCorrection()`. The whole strip is re-sent.
+     *
+     * @param segments The segments, sorted by `first` and not overlapping, or `nullptr`
+     *                 to remove them. The array is not copied and must outlive the strip.
+     * @param count The number of elements in `segments`.
+     */
+    void setSegmentCorrections(const LedSegmentCorrection* segments, uint8_t count) {
+        _segments = segments;
+        _segmentCount = segments ? count : 0;
+        invalidate();
+        requestShow();
+    }
+
+    /**
+     * @brief Opens a frame transaction.
+     * Until `commitFrame()` is called, changes that would normally be pushed to the
+     * strip immediately are only recorded in the buffer.
+     */
+    void beginFrame() override {
+        _inFrame = true;
+    }
+
+    /**
+     * @brief Closes a frame transaction and calls `show()` once if any change was deferred.
+     */
+    void commitFrame() override {
+        _inFrame = false;
+        if (_showPending) {
+            _showPending = false;
+            show();
+        }
+    }
+
+    /**
+     * @brief Marks the whole strip as changed, so the next `show()` transmits it.
+     * Use this if the strip lost power or its contents were overwritten by other code.
+     */
+    void invalidate() {
+        markDirty(0, 0xFFFF);
+    }
+
+    /**
+     * @brief Checks whether any pixel changed since the last transmission.
+     * @return True if the next `show()` will transmit.
+     */
+    bool isDirty() const {
+        return _dirtyFirst < _dirtyEnd;
+    }
+
+    /**
+     * @brief Enables or disables truncated shows.
+     * When enabled, `show()` transmits only the pixels up to and including the highest
+     * pixel changed since the last transmission. Pixels further down the chain keep
+     * their previous state. Disabled by default.
+     * @param enable True to transmit only up to the highest dirty pixel.
+     */
+    void setTruncatedShow(bool enable) {
+        _truncatedShow = enable;
+    }
+
+    /**
+     * @brief Checks whether truncated shows are enabled.
+     * @return True if `show()` transmits only up to the highest dirty pixel.
+     */
+    bool getTruncatedShow() const {
+        return _truncatedShow;
+    }
+
+    /**
+     * @brief Pushes the buffer to the strip, or defers it if a frame is open.
+     * Drivers and effects call this instead of `show()` wherever a change should
+     * become visible without an explicit `show()` from the caller.
+     */
+    void requestShow() {
+        if (_inFrame) {
+            _showPending = true;
+        } else {
+            show();
+        }
+    }
+
+protected:
+    /// Pixels rendered at a time by the fills of drivers without an RgbColor buffer.
+    static const uint8_t kFillChunk = 16;
+
+    /**
+     * @brief Clamps a pixel range to the strip.
+     * @param start The index of the first pixel.
+     * @param count The number of pixels.
+     * @param size The number of pixels of the strip.
+     * @return One past the last pixel of the range that exists, or `start` if none does.
+     */
+    static uint16_t rangeEnd(uint16_t start, uint16_t count, uint16_t size) {
+        if (start >= size) {
+            return start;
+        }
+        return (count < size - start) ? start + count : size;
+    }
+
+    /**
+     * @brief Splits a pixel range at the segment boundaries and renders each part with its correction.
+     * @param first The first pixel to render.
+     * @param end One past the last pixel to render.
+     * @param render Called as `render(first, end, correction)` for each part, in order.
+     */
+    template <typename Render>
+    void renderCorrected(uint16_t first, uint16_t end, Render render) const {
+        for (uint8_t s = 0; s < _segmentCount && first < end; s++) {
+            const LedSegmentCorrection& segment = _segments[s];
+            if (segment.first >= end) {
+                break;
+            }
+            uint16_t segmentEnd = rangeEnd(segment.first, segment.count, end);
+            if (segmentEnd <= first) {
+                continue;
+            }
+            if (segment.first > first) {
+                render(first, segment.first, _correction);
+                first = segment.first;
+            }
+            render(first, segmentEnd, segment.correction);
+            first = segmentEnd;
+        }
+        if (first < end) {
+            render(first, end, _correction);
+        }
+    }
+
+    /**
+     * @brief Gets the correction of a single pixel, for drivers that cannot render ranges.
+     * @param pixelIndex The index of the pixel.
+     * @return The correction of the segment containing the pixel, or the strip's correction.
+     */
+    const ColorCorrection* correctionAt(uint16_t pixelIndex) const {
+        for (uint8_t s = 0; s < _segmentCount; s++) {
+            const LedSegmentCorrection& segment = _segments[s];
+            if (pixelIndex < segment.first) {
+                break;
+            }
+            if (pixelIndex - segment.first < segment.count) {
+                return segment.correction;
+            }
+        }
+        return _correction;
+    }
+
+    /**
+     * @brief Gets the number of pixels the next transmission has to send.
+     * @param numLeds The number of pixels in the strip.
+     * @return `numLeds`, or the end of the dirty range if truncated shows are enabled.
+     */
+    uint16_t showLength(uint16_t numLeds) const {
+        return (_truncatedShow && _dirtyEnd < numLeds) ? _dirtyEnd : numLeds;
+    }
+
+    /**
+     * @brief Extends the dirty range to include the pixels `[first, end)`.
+     * @param first The first changed pixel.
+     * @param end One past the last changed pixel.
+     */
+    void markDirty(uint16_t first, uint16_t end) {
+        if (first < _dirtyFirst) {
+            _dirtyFirst = first;
+        }
+        if (end > _dirtyEnd) {
+            _dirtyEnd = end;
+        }
+    }
+
+    /**
+     * @brief Extends the dirty range to include a single pixel.
+     * @param pixelIndex The changed pixel. Must be less than 0xFFFF.
+     */
+    void markDirty(uint16_t pixelIndex) {
+        markDirty(pixelIndex, pixelIndex + 1);
+    }
+
+    /**
+     * @brief Clears the dirty range after the buffer was transmitted.
+     */
+    void clearDirty() {
+        _dirtyFirst = 0xFFFF;
+        _dirtyEnd = 0;
+    }
+
+    bool _inFrame = false;      ///< True while a frame transaction is open.
+    bool _showPending = false;  ///< True if a `show()` was deferred during the open frame.
+    uint16_t _dirtyFirst = 0;       ///< First pixel changed since the last transmission.
+    uint16_t _dirtyEnd = 0xFFFF;    ///< One past the last pixel changed since the last transmission.
+    bool _truncatedShow = false;    ///< True if `show()` transmits only up to `_dirtyEnd`.
+    const LedSegmentCorrection* _segments = nullptr;    ///< Per-segment corrections, sorted by first pixel.
+    uint8_t _segmentCount = 0;                          ///< The number of elements in `_segments`.
 };
 
 #endif // XDUINORAILS_LED_STRIP_H
@@ -0,0 +1,267 @@
+/**
+ * @file NeoPixelOutput.h
+ * @brief Adafruit_NeoPixel adapter used by the addressable strip drivers.
+ *
+ * This file provides a thin subclass of Adafruit_NeoPixel that can transmit from
+ * pixel storage supplied by the caller instead of a buffer allocated by the
+ * library, transmit only the beginning of the chain, and hand frames to an
+ * asynchronous StripTransport instead of the library. It is shared by LedNeoPixel
+ * and LedWs2811_3x1.
+ */
+#ifndef XDUINORAILS_NEOPIXEL_OUTPUT_H
+#define XDUINORAILS_NEOPIXEL_OUTPUT_H
+
+#include <Adafruit_NeoPixel.h>
+#include <string.h>
+#include "Led.h"
+#include "ColorCorrection.h"
+#include "StripTransport.h"
+
+/**
+ * @class NeoPixelOutput
+ * @brief Adafruit_NeoPixel with optional caller-owned pixel storage.
+ *
+ * When constructed with a storage pointer, the pixel buffer is not allocated by
+ * the library and is not freed on destruction. The storage must hold three bytes
+ * per pixel and must outlive this object.
+ */
+class NeoPixelOutput : public Adafruit_NeoPixel {
+public:
+    /**
+     * @brief Constructs an output whose pixel buffer is allocated by the library.
+     * @param numLeds The number of pixels in the chain.
+     * @param pin The Arduino pin connected to the data line.
+     * @param type The pixel color order and data rate flags.
+     */
+    NeoPixelOutput(uint16_t numLeds, int16_t pin, neoPixelType type)
+        : Adafruit_NeoPixel(numLeds, pin, type), _ownsStorage(true), _transport(nullptr) {}
+
+    /**
+     * @brief Constructs an output that uses caller-provided pixel storage.
+     * @param numLeds The number of pixels in the chain.
+     * @param pin The Arduino pin connected to the data line.
+     * @param type The pixel color order and data rate flags.
+     * @param storage A buffer of at least `storageSize(numLeds)` bytes.
+     */
+    NeoPixelOutput(uint16_t numLeds, int16_t pin, neoPixelType type, uint8_t* storage)
+        : Adafruit_NeoPixel(), _ownsStorage(false), _transport(nullptr) {
+        updateType(type);
+        setPin(pin);
+        memset(storage, 0, storageSize(numLeds));
+        pixels = storage;
+        numLEDs = numLeds;
+        numBytes = storageSize(numLeds);
+    }
+
+    /**
+     * @brief Destructor. Waits for an asynchronous transmission to finish and detaches
+     * caller-provided storage so the library does not free it.
+     */
+    ~NeoPixelOutput() {
+        waitIdle();
+        if (!_ownsStorage) {
+            pixels = nullptr;
+        }
+    }
+
+    /**
+     * @brief Converts a range of colors into the output buffer, scaling each channel.
+     * The library brightness is bypassed; scaling is done only through `scale`.
+     * Only valid for three-byte pixel types.
+     * @param source The colors of all pixels of the chain.
+     * @param first The first pixel to convert.
+     * @param end One past the last pixel to convert. Must not exceed `numPixels()`.
+     * @param scale A 256-entry table mapping each channel value to its output value.
+     * @param correction The output correction applied before `scale`, or `nullptr`.
+     */
+    void writePixels(const RgbColor* source, uint16_t first, uint16_t end, const uint8_t* scale,
+                     const ColorCorrection* correction = nullptr) {
+        uint8_t* p = &pixels[(size_t)first * 3];
+        if (correction) {
+            const uint8_t* red = correction->table(0);
+            const uint8_t* green = correction->table(1);
+            const uint8_t* blue = correction->table(2);
+            for (uint16_t i = first; i < end; i++, p += 3) {
+                p[rOffset] = scale[red[source[i].r]];
+                p[gOffset] = scale[green[source[i].g]];
+                p[bOffset] = scale[blue[source[i].b]];
+            }
+            return;
+        }
+        for (uint16_t i = first; i < end; i++, p += 3) {
+            p[rOffset] = scale[source[i].r];
+            p[gOffset] = scale[source[i].g];
+            p[bOffset] = scale[source[i].b];
+        }
+    }
+
+    /**
+     * @brief Converts a range of levels into the output buffer, one level for all channels.
+     * Only valid for three-byte pixel types.
+     * @param levels The levels of all pixels of the chain.
+     * @param first The first pixel to convert.
+     * @param end One past the last pixel to convert. Must not exceed `numPixels()`.
+     * @param scale A 256-entry table mapping each level to its output value.
+     * @param correction The output correction applied before `scale`, or `nullptr`.
+     */
+    void writeLevels(const uint8_t* levels, uint16_t first, uint16_t end, const uint8_t* scale,
+                     const ColorCorrection* correction = nullptr) {
+        const uint8_t* level = correction ? correction->table(ColorCorrection::LEVEL) : nullptr;
+        uint8_t* p = &pixels[(size_t)first * 3];
+        for (uint16_t i = first; i < end; i++, p += 3) {
+            uint8_t value = scale[level ? level[levels[i]] : levels[i]];
+            p[0] = value;
+            p[1] = value;
+            p[2] = value;
+        }
+    }
+
+    /**
+     * @brief Converts a range of 16-bit colors into the output buffer with temporal dithering.
+     *
+     * Each channel is scaled, the residual of the previous frame is added, and the
+     * high byte is output while the low byte is kept as residual for the next frame.
+     * Over successive frames, the average output equals the 16-bit value. Only valid
+     * for three-byte pixel types.
+     *
+     * @param source The colors of all pixels of the chain.
+     * @param residuals The residuals of all pixels, three bytes (r, g, b) per pixel.
+     * @param first The first pixel to convert.
+     * @param end One past the last pixel to convert. Must not exceed `numPixels()`.
+     * @param factor The brightness factor, 1 to 256 (256 leaves the colors unchanged).
+     * @param correction The output correction applied before scaling, or `nullptr`.
+     *                   Its tables are interpolated between 8-bit steps.
+     * @return One past the last converted pixel whose output changes between frames,
+     *         or 0 if all converted pixels are exact 8-bit values after scaling.
+     */
+    uint16_t writeDithered(const RgbColor16* source, uint8_t* residuals, uint16_t first, uint16_t end, uint16_t factor,
+                           const ColorCorrection* correction = nullptr) {
+        uint8_t* p = &pixels[(size_t)first * 3];
+        uint8_t* residual = &residuals[(size_t)first * 3];
+        uint16_t fractionEnd = 0;
+        for (uint16_t i = first; i < end; i++, p += 3, residual += 3) {
+            RgbColor16 color = source[i];
+            if (correction) {
+                color = {interpolate(correction->table(0), color.r), interpolate(correction->table(1), color.g),
+                         interpolate(correction->table(2), color.b)};
+            }
+            uint8_t fraction = ditherChannel(color.r, factor, residual[0], p[rOffset]);
+            fraction |= ditherChannel(color.g, factor, residual[1], p[gOffset]);
+            fraction |= ditherChannel(color.b, factor, residual[2], p[bOffset]);
+            if (fraction) {
+                fractionEnd = i + 1;
+            }
+        }
+        return fractionEnd;
+    }
+
+    /**
+     * @brief Transmits only the first pixels of the chain.
+     * The remaining pixels are not clocked out and keep their previous state.
+     * @param count The number of pixels to transmit. Must not exceed `numPixels()`.
+     */
+    void showPrefix(uint16_t count) {
+        uint16_t fullBytes = numBytes;
+        numBytes = storageSize(count);
+        show();
+        numBytes = fullBytes;
+    }
+
+    /**
+     * @brief Sets the transport used by `transmit()`.
+     * @param transport The transport, or `nullptr` to transmit through the library.
+     */
+    void setTransport(StripTransport* transport) {
+        waitIdle();
+        _transport = transport;
+    }
+
+    /**
+     * @brief Gets the transport used by `transmit()`.
+     * @return The transport, or `nullptr` if the library transmits.
+     */
+    StripTransport* getTransport() const {
+        return _transport;
+    }
+
+    /**
+     * @brief Transmits the first pixels of the chain.
+     * With a transport, the transmission runs in the background and the pixel buffer
+     * must not be changed until `isBusy()` returns false. Without one, this blocks.
+     * @param count The number of pixels to transmit. Must not exceed `numPixels()`.
+     */
+    void transmit(uint16_t count) {
+        if (_transport) {
+            _transport->transmit(pixels, storageSize(count));
+        } else if (count < numLEDs) {
+            showPrefix(count);
+        } else {
+            show();
+        }
+    }
+
+    /**
+     * @brief Checks whether an asynchronous transmission is in progress.
+     * @return True if the pixel buffer is still being sent.
+     */
+    bool isBusy() const {
+        return _transport && _transport->isBusy();
+    }
+
+    /**
+     * @brief Blocks until an asynchronous transmission has finished.
+     */
+    void waitIdle() const {
+        if (_transport) {
+            _transport->waitIdle();
+        }
+    }
+
+    /**
+     * @brief Gets the number of bytes of pixel storage needed for a chain.
+     * @param numLeds The number of pixels in the chain.
+     * @return The storage size in bytes.
+     */
+    static size_t storageSize(uint16_t numLeds) {
+        return (size_t)numLeds * 3;
+    }
+
+private:
+    /**
+     * @brief Looks up an 8.8 fixed-point value in an 8-bit table, interpolating linearly.
+     * @param table A 256-entry monotonic table.
+     * @param value The 8.8 fixed-point input.
+     * @return The 8.8 fixed-point output.
+     */
+    static uint16_t interpolate(const uint8_t* table, uint16_t value) {
+        uint8_t step = value >> 8;
+        uint8_t low = table[step];
+        uint8_t high = step < 255 ? table[step + 1] : low;
+        return (uint16_t)((low << 8) + (high - low) * (value & 0xFF));
+    }
+
+    /**
+     * @brief Dithers one channel: outputs the high byte and keeps the low byte as residual.
+     * @param value The 16-bit channel value.
+     * @param factor The brightness factor, 1 to 256.
+     * @param residual The residual of the previous frame; updated.
+     * @param out Receives the output byte.
+     * @return The fractional part of the scaled value, non-zero if the output changes between frames.
+     */
+    static uint8_t ditherChannel(uint16_t value, uint16_t factor, uint8_t& residual, uint8_t& out) {
+        uint32_t scaled = ((uint32_t)value * factor) >> 8;
+        // Above full scale the output is a steady 255, so nothing is left to dither.
+        if (scaled > 0xFF00) {
+            scaled = 0xFF00;
+        }
+        uint16_t sum = (uint16_t)(scaled + residual);
+        out = (uint8_t)(sum >> 8);
+        residual = (uint8_t)sum;
+        return (uint8_t)scaled;
+    }
+
+    bool _ownsStorage;              ///< True if the pixel buffer was allocated by the library.
+    StripTransport* _transport;     ///< Background transmitter, or `nullptr` to use the library.
+};
+
+#endif // XDUINORAILS_NEOPIXEL_OUTPUT_H
@@ -0,0 +1,595 @@
+/**
+ * @file PovRefresh.h
+ * @brief Timer-driven background refresh of multiplexed (POV) displays.
+ *
+ * LedMatrix and LedCharliePlex light one row or LED at a time, so the picture only
+ * stays stable while `show()` is called in a tight loop, and it flickers whenever the
+ * loop stalls. A PovRefresh instead scans the registered drivers step by step at a
+ * fixed rate, from a timer interrupt, a second core or a thread. The sketch draws into
+ * the driver as before and calls `show()` to commit the frame: the frame is copied into
+ * a back buffer, which the scan takes over at the start of its next frame, so the
+ * display never shows a half-drawn frame.
+ *
+ * PovRefresh itself has no timer. Call `poll(micros())` from the loop on any board, or
+ * use a backend that calls `service()` from the background: Rp2040PovRefresh
+ * (@see PovRefresh_Rp2040.h) on the RP2040 and HostPovRefresh on the host.
+ *
+ * @code
+ * Rp2040PovRefresh refresh;
+ *
+ * void setup() {
+ *   LedMatrix* matrix = static_cast<LedMatrix*>(ledHal.addLeds(MATRIX, pins, 16, 8));
+ *   refresh.setRefreshRate(200);
+ *   refresh.add(*matrix);
+ *   refresh.begin();
+ * }
+ *
+ * void loop() {
+ *   matrix->setPixelColor(i, color);
+ *   matrix->show();   // Commits the frame; the scan runs on its own
+ * }
+ * @endcode
+ */
+#ifndef XDUINORAILS_POV_REFRESH_H
+#define XDUINORAILS_POV_REFRESH_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "LedArena.h"
+
+class PovRefresh;
+
+/**
+ * @class PovScanner
+ * @brief Interface of a driver that a PovRefresh can scan in the background.
+ *
+ * A frame is scanned in a fixed number of steps. Each step lights part of the display
+ * from a frame buffer and stays lit until the next step or until the refresh blanks it
+ * early. The steps share the frame period in proportion to their weights. The frame
+ * buffer is a copy of the driver's drawing buffer owned by the refresh.
+ */
+class PovScanner {
+public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~PovScanner() {}
+
+    /**
+     * @brief Checks whether the driver is scanned by a PovRefresh.
+     * @return True if `show()` commits frames instead of scanning.
+     */
+    bool isBackgroundScanned() const {
+        return _refresh != nullptr;
+    }
+
+    /**
+     * @brief Gets the size of the frame buffer.
+     * @return The size in bytes.
+     */
+    virtual size_t scanFrameBytes() const = 0;
+
+    /**
+     * @brief Gets the number of steps per frame with the current settings.
+     * A frame is scanned with the step count it was committed with.
+     * @return The number of steps.
+     */
+    virtual uint16_t scanStepCount() const = 0;
+
+protected:
+    /**
+     * @brief Gets the buffer the driver draws into.
+     * @return The first of `scanFrameBytes()` bytes.
+     */
+    virtual const uint8_t* scanSource() const = 0;
+
+    /**
+     * @brief Brings the drawing buffer up to date before it is copied into a frame.
+     * Called in the foreground when the driver is added and on every commit, so that
+     * derived data, such as bit planes, is computed here rather than in `scanStep()`.
+     * The scan does not take over the committed frame while this runs, so settings that
+     * change how a frame is scanned can be staged here for `takeScanFrame()`.
+     * The default does nothing.
+     */
+    virtual void prepareScanFrame() {}
+
+    /**
+     * @brief Adopts the settings staged by `prepareScanFrame()` for the frame the scan takes over.
+     * Called by the scan before the first step of a newly committed frame, and when the
+     * driver is added. `scanStep()` and `scanBlank()` must only use settings adopted
+     * here, since the foreground may change the driver's settings at any time.
+     * The default does nothing.
+     */
+    virtual void takeScanFrame() {}
+
+    /**
+     * @brief Turns off the previous step and lights one step of a frame.
+     * @param frame The frame buffer, laid out like `scanSource()`.
+     * @param step The step, below the `scanStepCount()` the frame was committed with.
+     * @return The fraction of the step to stay lit, in 1/256 steps; 255 until
+     *         the next step, 0 if nothing was lit.
+     */
+    virtual uint8_t scanStep(const uint8_t* frame, uint16_t step) = 0;
+
+    /**
+     * @brief Gets the weight of a step of the frame being scanned.
+     * Each step lasts the part of the frame period given by its weight over the sum of
+     * the weights of all steps, so bit angle modulation can give each bit a slot in
+     * proportion to its significance. Called by the scan; use only settings adopted in
+     * `takeScanFrame()`. The default gives all steps the same length.
+     * @param step The step, below the `scanStepCount()` the frame was committed with.
+     * @return The weight, at least 1.
+     */
+    virtual uint16_t scanStepWeight(uint16_t step) const {
+        (void)step;
+        return 1;
+    }
+
+    /**
+     * @brief Turns off the lit step.
+     */
+    virtual void scanBlank() = 0;
+
+    /**
+     * @brief Hands the drawing buffer to the refresh; called by `show()` while scanned.
+     */
+    void commitScanFrame();
+
+private:
+    friend class PovRefresh;
+
+    PovRefresh* _refresh = nullptr; ///< The refresh scanning the driver, or `nullptr`.
+    PovScanner* _next = nullptr;    ///< The next driver of the refresh.
+    uint8_t* _front = nullptr;      ///< The frame being scanned.
+    uint8_t* _back = nullptr;       ///< The committed frame, or the next one being copied.
+    bool _pending = false;          ///< True when `_back` holds a complete frame to take over.
+    bool _ownsFrames = false;       ///< True if the frame buffers were allocated with `new[]`.
+    bool _lit = false;              ///< True while a step with a duty below 255 waits to be blanked.
+    uint16_t _step = 0;             ///< The next step to scan.
+    uint16_t _stepCount = 0;        ///< The step count of the frame being scanned.
+    uint16_t _backStepCount = 0;    ///< The step count of the committed frame.
+    uint32_t _frameWeight = 0;      ///< The sum of the step weights of the frame being scanned.
+    uint32_t _weightDone = 0;       ///< The sum of the weights of the steps scanned in this frame.
+    uint32_t _slot = 0;             ///< The length of one unit of weight, in 1/256 µs.
+    uint32_t _stepDue = 0;          ///< `micros()` time of the next step.
+    uint32_t _blankDue = 0;         ///< `micros()` time at which the lit step is blanked.
+};
+
+/**
+ * @struct PovRefreshStats
+ * @brief Measured timing of a PovRefresh.
+ */
+struct PovRefreshStats {
+    uint32_t frames = 0;            ///< Number of completed frames.
+    uint32_t steps = 0;             ///< Number of scanned steps, of all drivers.
+    uint32_t overruns = 0;          ///< Frames that ended before all their steps were scanned.
+    uint32_t frameMicros = 0;       ///< Duration of the last complete frame.
+    uint16_t refreshHz = 0;         ///< Refresh rate of the last complete frame.
+    uint32_t maxJitterMicros = 0;   ///< Largest delay of a step after its scheduled time.
+    uint64_t jitterSumMicros = 0;   ///< Sum of the delays of all steps, for the mean.
+
+    /**
+     * @brief Gets the mean delay of a step after its scheduled time.
+     * @return The mean jitter in microseconds.
+     */
+    uint32_t meanJitterMicros() const {
+        return steps ? (uint32_t)(jitterSumMicros / steps) : 0;
+    }
+};
+
+/**
+ * @class PovRefresh
+ * @brief Scans PovScanners at a target refresh rate.
+ *
+ * Frames start on a fixed grid of one frame period, and every driver scans all its
+ * steps in each frame. A driver's steps share the frame period in proportion to their
+ * weights (@see PovScanner::scanStepWeight()), so drivers with different step counts
+ * or weights are all scanned at the target rate. A step is scheduled relative to the
+ * start of its frame, so the lateness of one step shows up as jitter rather than
+ * shifting the steps that follow. Steps still left when the frame period ends are
+ * skipped, and counted as an overrun.
+ *
+ * `service()` and `show()` of a scanned driver may run concurrently, in an interrupt,
+ * on another core or on another thread. The frame handover is guarded by
+ * `enterCommit()`/`exitCommit()` in the foreground and `enterScan()`/`exitScan()` around
+ * `service()`. The defaults suit `service()` called from an interrupt on the same core;
+ * backends override them.
+ */
+class PovRefresh {
+public:
+    /// Returned by `service()` when no driver is registered.
+    static const uint32_t kIdle = 0xFFFFFFFF;
+
+    /**
+     * @brief Constructor.
+     * @param refreshHz The target number of frames per second.
+     */
+    explicit PovRefresh(uint16_t refreshHz = 100)
+        : _first(nullptr), _refreshHz(refreshHz ? refreshHz : 1), _framePeriod(0), _frameStart(0), _frameBegan(0),
+          _nextEvent(0), _started(false) {
+        updateSchedule();
+    }
+
+    /**
+     * @brief Destructor that blanks and releases all drivers.
+     */
+    virtual ~PovRefresh() {
+        while (_first) {
+            remove(*_first);
+        }
+    }
+
+    PovRefresh(const PovRefresh&) = delete;
+    PovRefresh& operator=(const PovRefresh&) = delete;
+
+    /**
+     * @brief Starts scanning a driver, with frame buffers on the heap.
+     * The current content of the driver is the first frame.
+     * @param scanner The driver. Must stay valid until it is removed.
+     * @return False if the driver is already scanned.
+     */
+    bool add(PovScanner& scanner) {
+        if (scanner._refresh) {
+            return false;
+        }
+        attach(scanner, new uint8_t[2 * scanner.scanFrameBytes()], true);
+        return true;
+    }
+
+    /**
+     * @brief Starts scanning a driver, with frame buffers in an arena.
+     * @param scanner The driver. Must stay valid until it is removed.
+     * @param arena The arena to allocate from. Needs `2 * scanner.scanFrameBytes()` bytes.
+     * @return False if the driver is already scanned or the arena is exhausted.
+     */
+    bool add(PovScanner& scanner, LedArena& arena) {
+        if (scanner._refresh) {
+            return false;
+        }
+        uint8_t* frames = arena.allocateArray<uint8_t>(2 * scanner.scanFrameBytes());
+        if (!frames) {
+            return false;
+        }
+        attach(scanner, frames, false);
+        return true;
+    }
+
+    /**
+     * @brief Stops scanning a driver and turns it off; `show()` scans it again.
+     * @param scanner The driver.
+     */
+    void remove(PovScanner& scanner) {
+        enterCommit();
+        for (PovScanner** link = &_first; *link; link = &(*link)->_next) {
+            if (*link == &scanner) {
+                *link = scanner._next;
+                break;
+            }
+        }
+        scanner.scanBlank();
+        scanner._next = nullptr;
+        scanner._refresh = nullptr;
+        if (!_first) {
+            _started = false;
+        }
+        exitCommit();
+        if (scanner._ownsFrames) {
+            delete[] (scanner._front < scanner._back ? scanner._front : scanner._back);
+        }
+        scanner._front = nullptr;
+        scanner._back = nullptr;
+    }
+
+    /**
+     * @brief Sets the target number of frames per second.
+     * @param refreshHz The refresh rate.
+     */
+    void setRefreshRate(uint16_t refreshHz) {
+        enterCommit();
+        _refreshHz = refreshHz ? refreshHz : 1;
+        updateSchedule();
+        exitCommit();
+    }
+
+    /**
+     * @brief Gets the target number of frames per second.
+     * @return The refresh rate.
+     */
+    uint16_t getRefreshRate() const {
+        return _refreshHz;
+    }
+
+    /**
+     * @brief Gets the time between two frame starts at the target rate.
+     * @return The frame period in microseconds.
+     */
+    uint32_t getFramePeriod() const {
+        return _framePeriod;
+    }
+
+    /**
+     * @brief Scans the steps and blanks the LEDs that are due.
+     * Called by the backends from the background, or by `poll()`.
+     * @param now The current `micros()` time.
+     * @return The microseconds until the next call is due, or `kIdle` if no driver is registered.
+     */
+    uint32_t service(uint32_t now) {
+        enterScan();
+        uint32_t wait = kIdle;
+        if (_first) {
+            if (!_started) {
+                _started = true;
+                _frameBegan = now;
+                startFrame(now);
+            } else if (now - _frameStart >= _framePeriod) {
+                endFrame(now);
+            }
+            for (PovScanner* scanner = _first; scanner; scanner = scanner->_next) {
+                if (scanner->_step < scanner->_stepCount && (int32_t)(now - scanner->_stepDue) >= 0) {
+                    step(*scanner, now);
+                } else if (scanner->_lit && (int32_t)(now - scanner->_blankDue) >= 0) {
+                    scanner->scanBlank();
+                    scanner->_lit = false;
+                }
+            }
+            wait = untilNextEvent(now);
+        }
+        exitScan();
+        return wait;
+    }
+
+    /**
+     * @brief Calls `service()` if a step or blank is due. For boards without a backend.
+     * @param now The current `micros()` time.
+     * @return True if something was due.
+     */
+    bool poll(uint32_t now) {
+        if (!_first || (_started && (int32_t)(now - _nextEvent) < 0)) {
+            return false;
+        }
+        _nextEvent = now + service(now);
+        return true;
+    }
+
+    /**
+     * @brief Gets the measured refresh rate and jitter.
+     * @return The statistics since construction or the last reset.
+     */
+    PovRefreshStats getStats() {
+        enterCommit();
+        PovRefreshStats stats = _stats;
+        exitCommit();
+        return stats;
+    }
+
+    /**
+     * @brief Clears the statistics.
+     */
+    void resetStats() {
+        enterCommit();
+        _stats = PovRefreshStats();
+        exitCommit();
+    }
+
+protected:
+    /**
+     * @brief Locks out `service()` while the foreground changes shared state.
+     * The default disables interrupts.
+     */
+    virtual void enterCommit() {
+        noInterrupts();
+    }
+
+    /**
+     * @brief Ends a section started with `enterCommit()`.
+     */
+    virtual void exitCommit() {
+        interrupts();
+    }
+
+    /**
+     * @brief Locks out the foreground while `service()` runs.
+     * The default does nothing, as an interrupt handler cannot be interrupted by the loop.
+     */
+    virtual void enterScan() {}
+
+    /**
+     * @brief Ends a section started with `enterScan()`.
+     */
+    virtual void exitScan() {}
+
+    /**
+     * @brief Turns off all drivers and restarts the schedule on the next `service()`.
+     * Called by backends when they stop calling `service()`.
+     */
+    void blankAll() {
+        enterScan();
+        for (PovScanner* scanner = _first; scanner; scanner = scanner->_next) {
+            scanner->scanBlank();
+            scanner->_lit = false;
+        }
+        _started = false;
+        exitScan();
+    }
+
+private:
+    friend class PovScanner;
+
+    /**
+     * @brief Links a driver and copies its prepared content into both frame buffers.
+     * The driver joins the scan at the next frame start.
+     */
+    void attach(PovScanner& scanner, uint8_t* frames, bool ownsFrames) {
+        size_t bytes = scanner.scanFrameBytes();
+        scanner.prepareScanFrame();
+        memcpy(frames, scanner.scanSource(), bytes);
+        memcpy(frames + bytes, frames, bytes);
+        scanner._front = frames;
+        scanner._back = frames + bytes;
+        scanner._ownsFrames = ownsFrames;
+        scanner._pending = false;
+        scanner._lit = false;
+        scanner._stepCount = scanner.scanStepCount();
+        scanner._backStepCount = scanner._stepCount;
+        scanner._step = scanner._stepCount;
+        scanner.takeScanFrame();
+        scanner._frameWeight = frameWeight(scanner);
+        enterCommit();
+        scheduleSlot(scanner);
+        scanner._refresh = this;
+        scanner._next = _first;
+        _first = &scanner;
+        exitCommit();
+    }
+
+    /**
+     * @brief Prepares the drawing buffer of a driver, copies it into its back buffer and
+     * marks it for takeover.
+     */
+    void commit(PovScanner& scanner) {
+        // The scan must not take over the back buffer, or the settings staged with it,
+        // while they are being written.
+        enterCommit();
+        scanner._pending = false;
+        exitCommit();
+        scanner.prepareScanFrame();
+        scanner._backStepCount = scanner.scanStepCount();
+        memcpy(scanner._back, scanner.scanSource(), scanner.scanFrameBytes());
+        enterCommit();
+        scanner._pending = true;
+        exitCommit();
+    }
+
+    /**
+     * @brief Ends the current frame, records its timing and starts the next one on the grid.
+     */
+    void endFrame(uint32_t now) {
+        for (PovScanner* scanner = _first; scanner; scanner = scanner->_next) {
+            if (scanner->_step < scanner->_stepCount) {
+                _stats.overruns++;
+                break;
+            }
+        }
+        _stats.frames++;
+        _stats.frameMicros = now - _frameBegan;
+        _stats.refreshHz = _stats.frameMicros ? (uint16_t)((1000000UL + _stats.frameMicros / 2) / _stats.frameMicros) : 0;
+        _frameBegan = now;
+        uint32_t start = _frameStart + _framePeriod;
+        // After falling behind by a whole frame, restart the grid instead of catching up.
+        startFrame(now - start >= _framePeriod ? now : start);
+    }
+
+    /**
+     * @brief Takes over the committed frames and schedules the first step of all drivers.
+     */
+    void startFrame(uint32_t start) {
+        _frameStart = start;
+        for (PovScanner* scanner = _first; scanner; scanner = scanner->_next) {
+            if (scanner->_pending) {
+                uint8_t* front = scanner->_front;
+                scanner->_front = scanner->_back;
+                scanner->_back = front;
+                scanner->_pending = false;
+                scanner->_stepCount = scanner->_backStepCount;
+                scanner->takeScanFrame();
+                scanner->_frameWeight = frameWeight(*scanner);
+                scheduleSlot(*scanner);
+            }
+            scanner->_step = 0;
+            scanner->_weightDone = 0;
+            scanner->_stepDue = start;
+        }
+    }
+
+    /**
+     * @brief Scans the next step of a driver and schedules the one after it.
+     */
+    void step(PovScanner& scanner, uint32_t now) {
+        uint32_t late = now - scanner._stepDue;
+        _stats.steps++;
+        _stats.jitterSumMicros += late;
+        if (late > _stats.maxJitterMicros) {
+            _stats.maxJitterMicros = late;
+        }
+        uint32_t begin = scanner._stepDue;
+        scanner._weightDone += scanner.scanStepWeight(scanner._step);
+        uint8_t duty = scanner.scanStep(scanner._front, scanner._step++);
+        // Scheduled from the frame start, so rounding does not add up over the steps.
+        scanner._stepDue = _frameStart + ((scanner._weightDone * scanner._slot) >> 8);
+        scanner._lit = duty > 0 && duty < 255;
+        scanner._blankDue = begin + (uint32_t)(((uint64_t)(scanner._stepDue - begin) * duty) >> 8);
+    }
+
+    /**
+     * @brief Gets the time until the next frame start, step or blank.
+     */
+    uint32_t untilNextEvent(uint32_t now) const {
+        uint32_t wait = until(_frameStart + _framePeriod, now);
+        for (PovScanner* scanner = _first; scanner; scanner = scanner->_next) {
+            if (scanner->_step < scanner->_stepCount) {
+                uint32_t step = until(scanner->_stepDue, now);
+                wait = step < wait ? step : wait;
+            }
+            if (scanner->_lit) {
+                uint32_t blank = until(scanner->_blankDue, now);
+                wait = blank < wait ? blank : wait;
+            }
+        }
+        return wait;
+    }
+
+    /**
+     * @brief Gets the time from `now` until `due`, or 0 if it has passed.
+     */
+    static uint32_t until(uint32_t due, uint32_t now) {
+        return (int32_t)(due - now) > 0 ? due - now : 0;
+    }
+
+    /**
+     * @brief Sums the step weights of the frame a driver scans.
+     */
+    static uint32_t frameWeight(const PovScanner& scanner) {
+        uint32_t weight = 0;
+        for (uint16_t step = 0; step < scanner._stepCount; step++) {
+            weight += scanner.scanStepWeight(step);
+        }
+        return weight;
+    }
+
+    /**
+     * @brief Computes the length of one unit of a driver's step weight from the frame period.
+     */
+    void scheduleSlot(PovScanner& scanner) const {
+        // The frame period is at most one second, so it fits 32 bits in 1/256 µs.
+        scanner._slot = scanner._frameWeight ? (_framePeriod << 8) / scanner._frameWeight : 0;
+    }
+
+    /**
+     * @brief Recomputes the frame period from the refresh rate, and the slots from it.
+     */
+    void updateSchedule() {
+        _framePeriod = 1000000UL / _refreshHz;
+        for (PovScanner* scanner = _first; scanner; scanner = scanner->_next) {
+            scheduleSlot(*scanner);
+        }
+    }
+
+    PovScanner* _first;         ///< The first registered driver.
+    uint16_t _refreshHz;        ///< The target number of frames per second.
+    uint32_t _framePeriod;      ///< Time between two frame starts.
+    uint32_t _frameStart;       ///< `micros()` time at which the current frame is scheduled to start.
+    uint32_t _frameBegan;       ///< `micros()` time at which the current frame was started.
+    uint32_t _nextEvent;        ///< `micros()` time of the next event, for `poll()`.
+    bool _started;              ///< True once the frame grid has been started.
+    PovRefreshStats _stats;     ///< Measured timing.
+};
+
+inline void PovScanner::commitScanFrame() {
+    if (_refresh) {
+        _refresh->commit(*this);
+    }
+}
+
+#endif // XDUINORAILS_POV_REFRESH_H
@@ -0,0 +1,136 @@
+/**
+ * @file PovRefresh_Rp2040.h
+ * @brief Background POV refresh for the RP2040, driven by a hardware alarm.
+ *
+ * The scan runs in the interrupt of a hardware timer alarm, on the core that called
+ * `begin()`. Called from `setup1()`, the scan runs entirely on the second core, and the
+ * first core only draws and commits frames.
+ */
+#ifndef XDUINORAILS_POV_REFRESH_RP2040_H
+#define XDUINORAILS_POV_REFRESH_RP2040_H
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+#include <Arduino.h>
+#include <hardware/sync.h>
+#include <pico/time.h>
+#include "PovRefresh.h"
+
+/**
+ * @class Rp2040PovRefresh
+ * @brief PovRefresh that scans from a hardware alarm interrupt.
+ *
+ * Uses its own alarm pool on an unused hardware alarm, so it does not compete with
+ * `delay()` and other users of the default pool, and one hardware spin lock for the
+ * frame handover between the cores.
+ *
+ * @code
+ * Rp2040PovRefresh refresh(200);
+ *
+ * void setup() {
+ *   refresh.add(*matrix);
+ * }
+ *
+ * void setup1() {
+ *   refresh.begin();   // Scan on core 1
+ * }
+ * @endcode
+ */
+class Rp2040PovRefresh : public PovRefresh {
+public:
+    /**
+     * @brief Constructor that claims the spin lock. The alarm is claimed by `begin()`.
+     * @param refreshHz The target number of frames per second.
+     */
+    explicit Rp2040PovRefresh(uint16_t refreshHz = 100)
+        : PovRefresh(refreshHz), _pool(nullptr), _alarm(0), _lockNum(spin_lock_claim_unused(true)),
+          _lock(spin_lock_init(_lockNum)), _commitIrq(0), _scanIrq(0) {}
+
+    /**
+     * @brief Destructor that stops the scan and releases the hardware.
+     */
+    ~Rp2040PovRefresh() {
+        end();
+        spin_lock_unclaim(_lockNum);
+    }
+
+    /**
+     * @brief Claims a hardware alarm and starts the scan on the calling core.
+     * @return True on success, false if no hardware alarm is free.
+     */
+    bool begin() {
+        if (_pool) {
+            return true;
+        }
+        _pool = alarm_pool_create_with_unused_hardware_alarm(1);
+        if (!_pool) {
+            return false;
+        }
+        _alarm = alarm_pool_add_alarm_in_us(_pool, kIdleMicros, alarmCallback, this, true);
+        return _alarm > 0;
+    }
+
+    /**
+     * @brief Stops the scan, turns all drivers off and releases the hardware alarm.
+     */
+    void end() {
+        if (!_pool) {
+            return;
+        }
+        if (_alarm > 0) {
+            alarm_pool_cancel_alarm(_pool, _alarm);
+            _alarm = 0;
+        }
+        alarm_pool_destroy(_pool);
+        _pool = nullptr;
+        blankAll();
+    }
+
+protected:
+    void enterCommit() override {
+        _commitIrq = spin_lock_blocking(_lock);
+    }
+
+    void exitCommit() override {
+        spin_unlock(_lock, _commitIrq);
+    }
+
+    void enterScan() override {
+        _scanIrq = spin_lock_blocking(_lock);
+    }
+
+    void exitScan() override {
+        spin_unlock(_lock, _scanIrq);
+    }
+
+private:
+    /// Alarm interval while no driver is registered.
+    static const uint32_t kIdleMicros = 10000;
+
+    /**
+     * @brief Scans the due steps and reschedules the alarm for the next event.
+     */
+    static int64_t alarmCallback(alarm_id_t id, void* userData) {
+        (void)id;
+        Rp2040PovRefresh* self = static_cast<Rp2040PovRefresh*>(userData);
+        uint32_t now = time_us_32();
+        uint32_t wait = self->service(now);
+        if (wait == kIdle) {
+            return kIdleMicros;
+        }
+        // A positive value counts from the return of the callback, so subtract the time spent.
+        int32_t remaining = (int32_t)(now + wait - time_us_32());
+        return remaining > 0 ? remaining : 1;
+    }
+
+    alarm_pool_t* _pool;        ///< The alarm pool on the claimed hardware alarm, while started.
+    alarm_id_t _alarm;          ///< The scan alarm, or 0.
+    uint _lockNum;              ///< The number of the claimed spin lock.
+    spin_lock_t* _lock;         ///< Guards the frame handover between the cores.
+    uint32_t _commitIrq;        ///< Interrupt state saved by `enterCommit()`.
+    uint32_t _scanIrq;          ///< Interrupt state saved by `enterScan()`.
+};
+
+#endif // ARDUINO_ARCH_RP2040
+
+#endif // XDUINORAILS_POV_REFRESH_RP2040_H
@@ -0,0 +1,64 @@
+/**
+ * @file ScaleTable.h
+ * @brief Lookup table that scales 8-bit channel values by a brightness factor.
+ *
+ * The strip drivers keep their pixel data at full precision and apply brightness
+ * only when converting it to the output buffer. Looking the scaled value up in a
+ * table avoids a multiplication per channel, which is slow on small AVR cores.
+ */
+#ifndef XDUINORAILS_SCALE_TABLE_H
+#define XDUINORAILS_SCALE_TABLE_H
+
+#include <stdint.h>
+
+/**
+ * @class ScaleTable
+ * @brief 256-entry table mapping a channel value to `value * (scale + 1) / 256`.
+ *
+ * A scale of 255 maps every value to itself, a scale of 0 maps every value to 0.
+ * The formula matches the brightness scaling of the Adafruit NeoPixel library.
+ */
+class ScaleTable {
+public:
+    /**
+     * @brief Constructs an identity table (scale 255).
+     */
+    ScaleTable() {
+        setScale(255);
+    }
+
+    /**
+     * @brief Recomputes the table for a new scale factor.
+     * @param scale The scale factor (0-255).
+     */
+    void setScale(uint8_t scale) {
+        uint16_t factor = (uint16_t)scale + 1;
+        uint16_t accumulator = 0;
+        for (uint16_t value = 0; value < 256; value++) {
+            _table[value] = (uint8_t)(accumulator >> 8);
+            accumulator += factor;
+        }
+    }
+
+    /**
+     * @brief Scales a channel value.
+     * @param value The value to scale.
+     * @return The scaled value.
+     */
+    uint8_t operator[](uint8_t value) const {
+        return _table[value];
+    }
+
+    /**
+     * @brief Gets the table for use in tight loops.
+     * @return A pointer to the 256 table entries.
+     */
+    const uint8_t* data() const {
+        return _table;
+    }
+
+private:
+    uint8_t _table[256];    ///< Scaled value for every input value.
+};
+
+#endif // XDUINORAILS_SCALE_TABLE_H
@@ -0,0 +1,352 @@
+/**
+ * @file StaticLedDriverHAL.h
+ * @brief Fixed-capacity, heap-free implementation of the LedDriverHAL.
+ *
+ * This file provides a variant of ArduinoLedDriverHAL whose capacity is fixed at
+ * compile time. All drivers and their pin and pixel buffers are placement-constructed
+ * into a single statically sized arena, so no heap memory is used at runtime and
+ * the RAM footprint is known when the sketch is built.
+ */
+#ifndef STATIC_LED_DRIVER_HAL_H
+#define STATIC_LED_DRIVER_HAL_H
+
+#include <string.h>
+#include "xDuinoRails_LED-Drivers.h"
+#include "LedArena.h"
+#include "LedFactory.h"
+
+/**
+ * @class StaticLedDriverHAL
+ * @brief LedDriverHAL implementation backed by a fixed-size arena.
+ *
+ * The HAL can hold up to `MaxDrivers` drivers, which share an arena of `ArenaBytes`
+ * bytes for the driver objects and their buffers. `addLeds()` returns `nullptr` when
+ * either limit would be exceeded. The bytes needed for a driver are `sizeof` the
+ * driver class plus its `storageSize()`, if it has one, plus alignment padding;
+ * `getArenaUsed()` reports the exact amount after setup.
+ *
+ * Group members are kept in one contiguous array ordered by group, so group
+ * operations iterate only over the addressed group.
+ *
+ * @tparam MaxDrivers The maximum number of drivers.
+ * @tparam ArenaBytes The size of the arena in bytes.
+ */
+template <uint16_t MaxDrivers, size_t ArenaBytes>
+class StaticLedDriverHAL : public LedDriverHAL {
+public:
+    /**
+     * @brief Constructor for the HAL. Does not allocate any memory.
+     */
+    StaticLedDriverHAL()
+        : _arena(_storage, ArenaBytes), _ledCount(0), _groupCount(0), _frameDepth(0), _correction(nullptr) {}
+
+    StaticLedDriverHAL(const StaticLedDriverHAL&) = delete;
+    StaticLedDriverHAL& operator=(const StaticLedDriverHAL&) = delete;
+
+    /**
+     * @brief Destructor that destroys all drivers in reverse order of creation.
+     * The arena memory itself is part of this object and needs no deallocation.
+     */
+    ~StaticLedDriverHAL() override {
+        for (uint16_t i = _ledCount; i > 0; i--) {
+            _leds[i - 1]->~Led();
+        }
+    }
+
+    /**
+     * @brief Factory method to create and add a new LED driver instance.
+     *
+     * The driver and its buffers are placed in the arena. The `indexInGroup` for the
+     * new LED is taken from the group index.
+     *
+     * @param type The type of LED driver to create (@see LedType).
+     * @param pins An array of pin numbers. The required pins vary by driver.
+     * @param pinCount The number of elements in the `pins` array.
+     * @param numLeds The number of LEDs for strip or matrix drivers.
+     * @param groupId An ID for grouping LEDs for simultaneous control.
+     * @return A pointer to the newly created Led object. The HAL retains ownership.
+     *         Returns `nullptr` if the parameters are invalid for the requested type,
+     *         or if the driver or arena capacity is exhausted.
+     */
+    Led* addLeds(LedType type, const uint8_t* pins, uint8_t pinCount, uint16_t numLeds = 0, uint8_t groupId = 0) override {
+        if (_ledCount >= MaxDrivers) {
+            return nullptr;
+        }
+        uint16_t groupIndex = findGroup(groupId);
+        uint16_t indexInGroup = groupIndex < _groupCount ? _groups[groupIndex].count : 0;
+
+        LedArenaBuilder builder(_arena);
+        Led* newLed = createLed(builder, type, pins, pinCount, numLeds, groupId, indexInGroup);
+
+        if (newLed) {
+            _leds[_ledCount++] = newLed;
+            if (groupIndex >= _groupCount) {
+                groupIndex = insertGroup(groupId);
+            }
+            appendToGroup(groupIndex, newLed);
+            if (_frameDepth > 0) {
+                newLed->beginFrame();
+            }
+            if (_correction) {
+                newLed->setColorCorrection(_correction);
+            }
+        }
+        return newLed;
+    }
+
+    /**
+     * @brief Retrieves a pointer to a specific LED driver by its global index.
+     * @param globalIndex The zero-based index of the LED driver to retrieve.
+     * @return A pointer to the Led object, or `nullptr` if the index is out of bounds.
+     */
+    Led* getLed(uint16_t globalIndex) override {
+        if (globalIndex < _ledCount) {
+            return _leds[globalIndex];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Sets the color for all LED drivers within a specified group.
+     * @param groupId The ID of the group to control.
+     * @param color The RgbColor to set.
+     */
+    void setGroupColor(uint8_t groupId, const RgbColor& color) override {
+        uint16_t groupIndex = findGroup(groupId);
+        if (groupIndex < _groupCount) {
+            Led** members = _groupMembers + _groups[groupIndex].start;
+            for (uint16_t i = 0; i < _groups[groupIndex].count; i++) {
+                members[i]->setColor(color);
+            }
+        }
+    }
+
+    /**
+     * @brief Sets the brightness for all LED drivers within a specified group.
+     * @param groupId The ID of the group to control.
+     * @param brightness The brightness level (0-255).
+     */
+    void setGroupBrightness(uint8_t groupId, uint8_t brightness) override {
+        uint16_t groupIndex = findGroup(groupId);
+        if (groupIndex < _groupCount) {
+            Led** members = _groupMembers + _groups[groupIndex].start;
+            for (uint16_t i = 0; i < _groups[groupIndex].count; i++) {
+                members[i]->setBrightness(brightness);
+            }
+        }
+    }
+
+    /**
+     * @brief Sets the output correction of all LED drivers, including ones added later.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     */
+    void setColorCorrection(const ColorCorrection* correction) override {
+        _correction = correction;
+        for (uint16_t i = 0; i < _ledCount; i++) {
+            _leds[i]->setColorCorrection(correction);
+        }
+    }
+
+    /**
+     * @brief Sets the output correction for all LED drivers within a specified group.
+     * @param groupId The ID of the group to configure.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     */
+    void setGroupColorCorrection(uint8_t groupId, const ColorCorrection* correction) override {
+        uint16_t groupIndex = findGroup(groupId);
+        if (groupIndex < _groupCount) {
+            Led** members = _groupMembers + _groups[groupIndex].start;
+            for (uint16_t i = 0; i < _groups[groupIndex].count; i++) {
+                members[i]->setColorCorrection(correction);
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of LED drivers in a group.
+     * @param groupId The ID of the group to query.
+     * @return The number of Led objects in the group, or 0 if the group is unknown.
+     */
+    uint16_t getGroupSize(uint8_t groupId) override {
+        uint16_t groupIndex = findGroup(groupId);
+        return groupIndex < _groupCount ? _groups[groupIndex].count : 0;
+    }
+
+    /**
+     * @brief Retrieves a pointer to a member of a group by its index within that group.
+     * @param groupId The ID of the group.
+     * @param indexInGroup The zero-based index of the LED driver within the group.
+     * @return A pointer to the Led object, or `nullptr` if the group or index is invalid.
+     */
+    Led* getGroupLed(uint8_t groupId, uint16_t indexInGroup) override {
+        uint16_t groupIndex = findGroup(groupId);
+        if (groupIndex < _groupCount && indexInGroup < _groups[groupIndex].count) {
+            return _groupMembers[_groups[groupIndex].start + indexInGroup];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Opens a frame transaction across all LED drivers.
+     * Nested calls are counted; only the outermost frame is forwarded to the drivers.
+     */
+    void beginFrame() override {
+        if (_frameDepth++ == 0) {
+            for (uint16_t i = 0; i < _ledCount; i++) {
+                _leds[i]->beginFrame();
+            }
+        }
+    }
+
+    /**
+     * @brief Closes a frame transaction, flushing each driver with deferred output once.
+     */
+    void commitFrame() override {
+        if (_frameDepth > 0 && --_frameDepth == 0) {
+            for (uint16_t i = 0; i < _ledCount; i++) {
+                _leds[i]->commitFrame();
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of drivers created so far.
+     * @return The number of drivers.
+     */
+    uint16_t getLedCount() const { return _ledCount; }
+
+    /**
+     * @brief Gets the number of arena bytes used by drivers and their buffers.
+     * @return The number of bytes used, including alignment padding.
+     */
+    size_t getArenaUsed() const { return _arena.used(); }
+
+    /**
+     * @brief Gets the total size of the arena.
+     * @return The arena capacity in bytes (`ArenaBytes`).
+     */
+    size_t getArenaCapacity() const { return _arena.capacity(); }
+
+#if XDUINORAILS_LED_STATS
+    /**
+     * @brief Sums the instrumentation counters of all LED drivers.
+     * Only available when `XDUINORAILS_LED_STATS` is enabled (@see LedStats.h).
+     * @return The aggregate counters; `showMicrosMax` is the maximum over all drivers.
+     */
+    LedStats getStats() const {
+        LedStats total;
+        for (uint16_t i = 0; i < _ledCount; i++) {
+            total.add(_leds[i]->getStats());
+        }
+        return total;
+    }
+
+    /**
+     * @brief Clears the instrumentation counters of all LED drivers.
+     */
+    void resetStats() {
+        for (uint16_t i = 0; i < _ledCount; i++) {
+            _leds[i]->resetStats();
+        }
+    }
+
+    /**
+     * @brief Prints the counters of each LED driver and the aggregate, e.g. to `Serial`.
+     * @param out The stream to print to.
+     */
+    void printStats(Print& out) const {
+        for (uint16_t i = 0; i < _ledCount; i++) {
+            out.print("led ");
+            out.print(i);
+            out.print(" group ");
+            out.print(_leds[i]->getGroupId());
+            out.print(": ");
+            _leds[i]->getStats().printTo(out);
+        }
+        out.print("total: ");
+        getStats().printTo(out);
+    }
+#endif
+
+private:
+    /**
+     * @struct GroupEntry
+     * @brief Index entry describing the slice of `_groupMembers` that belongs to a group.
+     */
+    struct GroupEntry {
+        uint8_t id;         ///< The group ID.
+        uint16_t start;     ///< Index of the first member in `_groupMembers`.
+        uint16_t count;     ///< Number of members in the group.
+    };
+
+    /**
+     * @brief Finds the position of a group in the sorted index.
+     * @param groupId The ID of the group to find.
+     * @return The position of the group entry, or `_groupCount` if the group is unknown.
+     */
+    uint16_t findGroup(uint8_t groupId) const {
+        uint16_t pos = lowerBound(groupId);
+        return (pos < _groupCount && _groups[pos].id == groupId) ? pos : _groupCount;
+    }
+
+    /**
+     * @brief Binary search for the first group entry whose ID is not less than `groupId`.
+     */
+    uint16_t lowerBound(uint8_t groupId) const {
+        uint16_t low = 0;
+        uint16_t high = _groupCount;
+        while (low < high) {
+            uint16_t mid = (low + high) / 2;
+            if (_groups[mid].id < groupId) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    /**
+     * @brief Inserts an empty group entry, keeping the index sorted by ID.
+     * @param groupId The ID of the new group. Must not already be present.
+     * @return The position of the new group entry.
+     */
+    uint16_t insertGroup(uint8_t groupId) {
+        uint16_t pos = lowerBound(groupId);
+        // The new group starts where the next group's members begin.
+        uint16_t start = pos < _groupCount ? _groups[pos].start : _ledCount - 1;
+        memmove(&_groups[pos + 1], &_groups[pos], (_groupCount - pos) * sizeof(GroupEntry));
+        _groups[pos] = {groupId, start, 0};
+        _groupCount++;
+        return pos;
+    }
+
+    /**
+     * @brief Appends a driver to the end of a group's slice of `_groupMembers`.
+     * Members of later groups are shifted up by one. This only happens during setup.
+     * @param groupIndex The position of the group entry.
+     * @param led The driver to append. Must already be counted in `_ledCount`.
+     */
+    void appendToGroup(uint16_t groupIndex, Led* led) {
+        uint16_t pos = _groups[groupIndex].start + _groups[groupIndex].count;
+        uint16_t memberCount = _ledCount - 1;
+        memmove(&_groupMembers[pos + 1], &_groupMembers[pos], (memberCount - pos) * sizeof(Led*));
+        _groupMembers[pos] = led;
+        _groups[groupIndex].count++;
+        for (uint16_t i = groupIndex + 1; i < _groupCount; i++) {
+            _groups[i].start++;
+        }
+    }
+
+    alignas(alignof(max_align_t)) uint8_t _storage[ArenaBytes];  ///< Memory for all drivers and their buffers.
+    LedArena _arena;                    ///< Allocator over `_storage`.
+    Led* _leds[MaxDrivers];             ///< All drivers in order of creation.
+    Led* _groupMembers[MaxDrivers];     ///< All drivers ordered by group, then by index within the group.
+    GroupEntry _groups[MaxDrivers];     ///< Group index entries, sorted by group ID.
+    uint16_t _ledCount;                 ///< Number of drivers created so far.
+    uint16_t _groupCount;               ///< Number of entries in `_groups`.
+    uint8_t _frameDepth;                ///< Nesting depth of open frame transactions.
+    const ColorCorrection* _correction; ///< Correction for drivers added later.
+};
+
+#endif // STATIC_LED_DRIVER_HAL_H
@@ -0,0 +1,636 @@
+/**
+ * @file StaticLedHAL.h
+ * @brief Compile-time configured LED HAL without virtual dispatch.
+ *
+ * This file provides StaticLedHAL, a variadic template that holds a fixed set of
+ * drivers whose types, pins and pixel counts are template parameters. All calls
+ * are resolved at compile time: there is no Led vtable, no LedType switch and no
+ * pin array lookup, so pin numbers become constants the compiler can fold and
+ * group operations are unrolled over the configured drivers.
+ *
+ * The layout is fixed when the sketch is built, for example:
+ * @code
+ * StaticLedHAL<StaticLed::Single<13>,
+ *              StaticLed::Rgb<9, 10, 11, 1>,
+ *              StaticLed::NeoPixel<6, 300, 1>> leds;
+ * @endcode
+ *
+ * Use ArduinoLedDriverHAL (or StaticLedDriverHAL for a heap-free variant of it)
+ * when the layout is only known at runtime.
+ */
+#ifndef STATIC_LED_HAL_H
+#define STATIC_LED_HAL_H
+
+#include <stddef.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Led.h"
+#include "ColorCorrection.h"
+#include "ColorMath.h"
+#include "NeoPixelOutput.h"
+#include "ScaleTable.h"
+#include <Arduino.h>
+
+/**
+ * @namespace StaticLed
+ * @brief Driver types for use with StaticLedHAL.
+ *
+ * Each type mirrors the behavior of the corresponding dynamic driver, but takes
+ * its pins and sizes as template parameters and has no virtual functions. Every
+ * type exposes a `groupId` constant, `begin()`, `on()`, `off()`, `setColor()`,
+ * `setBrightness()`, `setColorCorrection()`, `beginFrame()` and `commitFrame()`.
+ */
+namespace StaticLed {
+
+/**
+ * @struct Pins
+ * @brief Compile-time list of pin numbers.
+ * @tparam P The pin numbers.
+ */
+template <uint8_t... P>
+struct Pins {};
+
+/**
+ * @class Single
+ * @brief Compile-time counterpart of LedSingle.
+ * @tparam Pin The Arduino pin the LED is connected to.
+ * @tparam GroupId The group the LED belongs to.
+ * @tparam IsAnode True for common anode (pin HIGH for on), false for common cathode.
+ */
+template <uint8_t Pin, uint8_t GroupId = 0, bool IsAnode = true>
+class Single {
+public:
+    static constexpr uint8_t groupId = GroupId;   ///< The group the LED belongs to.
+
+    /**
+     * @brief Configures the pin and turns the LED off. Call from `setup()`.
+     */
+    void begin() {
+        pinMode(Pin, OUTPUT);
+        off();
+    }
+
+    /**
+     * @brief Turns the LED on to the currently set brightness.
+     */
+    void on() {
+        uint8_t level = _correction ? _correction->level(_brightness) : _brightness;
+        analogWrite(Pin, IsAnode ? level : 255 - level);
+        _lit = true;
+    }
+
+    /**
+     * @brief Turns the LED off.
+     */
+    void off() {
+        digitalWrite(Pin, IsAnode ? LOW : HIGH);
+        _lit = false;
+    }
+
+    /**
+     * @brief Sets the brightness from the average of the color components.
+     * @param color The RgbColor to use for brightness calculation.
+     */
+    void setColor(const RgbColor& color) {
+        setBrightness((color.r + color.g + color.b) / 3);
+    }
+
+    /**
+     * @brief Sets the brightness, turning the LED off at 0.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) {
+        _brightness = brightness;
+        if (brightness > 0) {
+            on();
+        } else {
+            off();
+        }
+    }
+
+    /**
+     * @brief Sets the output correction and rewrites the output if the LED is on.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) {
+        _correction = correction;
+        if (_lit) {
+            on();
+        }
+    }
+
+    void beginFrame() {}    ///< Outputs are written directly; nothing to defer.
+    void commitFrame() {}   ///< Outputs are written directly; nothing to flush.
+
+private:
+    uint8_t _brightness = 255;  ///< Current brightness level (0-255).
+    bool _lit = false;          ///< True while the output is on.
+    const ColorCorrection* _correction = nullptr;   ///< Output correction, or `nullptr` for linear output.
+};
+
+/**
+ * @class Multi
+ * @brief Compile-time counterpart of LedMulti.
+ * @tparam PinList A StaticLed::Pins list of the pins driven together.
+ * @tparam GroupId The group the LEDs belong to.
+ * @tparam IsAnode True for common anode (pin HIGH for on), false for common cathode.
+ */
+template <typename PinList, uint8_t GroupId = 0, bool IsAnode = true>
+class Multi;
+
+template <uint8_t... P, uint8_t GroupId, bool IsAnode>
+class Multi<Pins<P...>, GroupId, IsAnode> {
+public:
+    static constexpr uint8_t groupId = GroupId;   ///< The group the LEDs belong to.
+
+    /**
+     * @brief Configures the pins and turns the LEDs off. Call from `setup()`.
+     */
+    void begin() {
+        int unused[] = {0, (pinMode(P, OUTPUT), 0)...};
+        (void)unused;
+        off();
+    }
+
+    /**
+     * @brief Turns all LEDs on to the currently set brightness.
+     */
+    void on() {
+        uint8_t level = _correction ? _correction->level(_brightness) : _brightness;
+        uint8_t value = IsAnode ? level : 255 - level;
+        int unused[] = {0, (analogWrite(P, value), 0)...};
+        (void)unused;
+        _lit = true;
+    }
+
+    /**
+     * @brief Turns all LEDs off.
+     */
+    void off() {
+        int unused[] = {0, (digitalWrite(P, IsAnode ? LOW : HIGH), 0)...};
+        (void)unused;
+        _lit = false;
+    }
+
+    /**
+     * @brief Sets the brightness from the average of the color components.
+     * @param color The RgbColor to use for brightness calculation.
+     */
+    void setColor(const RgbColor& color) {
+        setBrightness((color.r + color.g + color.b) / 3);
+    }
+
+    /**
+     * @brief Sets the brightness of all LEDs, turning them off at 0.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) {
+        _brightness = brightness;
+        if (brightness > 0) {
+            on();
+        } else {
+            off();
+        }
+    }
+
+    /**
+     * @brief Sets the output correction and rewrites the output if the LEDs are on.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) {
+        _correction = correction;
+        if (_lit) {
+            on();
+        }
+    }
+
+    void beginFrame() {}    ///< Outputs are written directly; nothing to defer.
+    void commitFrame() {}   ///< Outputs are written directly; nothing to flush.
+
+private:
+    uint8_t _brightness = 255;  ///< Current brightness level (0-255).
+    bool _lit = false;          ///< True while the output is on.
+    const ColorCorrection* _correction = nullptr;   ///< Output correction, or `nullptr` for linear output.
+};
+
+/**
+ * @class Rgb
+ * @brief Compile-time counterpart of LedRgb.
+ * @tparam PinR The pin connected to the red element.
+ * @tparam PinG The pin connected to the green element.
+ * @tparam PinB The pin connected to the blue element.
+ * @tparam GroupId The group the LED belongs to.
+ * @tparam IsAnode True for common anode wiring, false for common cathode.
+ */
+template <uint8_t PinR, uint8_t PinG, uint8_t PinB, uint8_t GroupId = 0, bool IsAnode = true>
+class Rgb {
+public:
+    static constexpr uint8_t groupId = GroupId;   ///< The group the LED belongs to.
+
+    /**
+     * @brief Configures the pins and turns the LED off. Call from `setup()`.
+     */
+    void begin() {
+        pinMode(PinR, OUTPUT);
+        pinMode(PinG, OUTPUT);
+        pinMode(PinB, OUTPUT);
+        off();
+    }
+
+    /**
+     * @brief Turns the LED on to full white at the current brightness.
+     */
+    void on() {
+        setColor({255, 255, 255});
+    }
+
+    /**
+     * @brief Turns the LED off (sets color to black).
+     */
+    void off() {
+        setColor({0, 0, 0});
+    }
+
+    /**
+     * @brief Sets the color of the LED, scaled by the current brightness.
+     * @param color The RgbColor to set.
+     */
+    void setColor(const RgbColor& color) {
+        _color = color;
+        applyColor();
+    }
+
+    /**
+     * @brief Sets the brightness and reapplies the current color.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) {
+        _brightness = brightness;
+        applyColor();
+    }
+
+    /**
+     * @brief Sets the output correction and rewrites the color.
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) {
+        _correction = correction;
+        applyColor();
+    }
+
+    void beginFrame() {}    ///< Outputs are written directly; nothing to defer.
+    void commitFrame() {}   ///< Outputs are written directly; nothing to flush.
+
+private:
+    /**
+     * @brief Writes the stored color, scaled by brightness, to the three pins.
+     */
+    void applyColor() {
+        RgbColor color = _correction ? _correction->apply(_color) : _color;
+        uint8_t r = ColorMath::scale8(color.r, _brightness);
+        uint8_t g = ColorMath::scale8(color.g, _brightness);
+        uint8_t b = ColorMath::scale8(color.b, _brightness);
+        analogWrite(PinR, IsAnode ? 255 - r : r);
+        analogWrite(PinG, IsAnode ? 255 - g : g);
+        analogWrite(PinB, IsAnode ? 255 - b : b);
+    }
+
+    RgbColor _color = {0, 0, 0};    ///< The currently set color.
+    uint8_t _brightness = 255;      ///< Current brightness level (0-255).
+    const ColorCorrection* _correction = nullptr;   ///< Output correction, or `nullptr` for linear output.
+};
+
+/**
+ * @class NeoPixel
+ * @brief Compile-time counterpart of LedNeoPixel.
+ *
+ * The color and output buffers are member arrays, so the strip needs no heap memory.
+ * Like LedNeoPixel, the colors are kept at full precision and brightness is applied
+ * through a scale table when they are converted for output, and whole-strip changes
+ * are shown immediately unless a frame is open.
+ *
+ * @tparam Pin The Arduino pin connected to the data line.
+ * @tparam Count The number of pixels in the strip.
+ * @tparam GroupId The group the strip belongs to.
+ */
+template <uint8_t Pin, uint16_t Count, uint8_t GroupId = 0>
+class NeoPixel {
+public:
+    static constexpr uint8_t groupId = GroupId;   ///< The group the strip belongs to.
+
+    NeoPixel() : _colors(), _strip(Count, Pin, NEO_GRB + NEO_KHZ800, _pixels) {}
+
+    /**
+     * @brief Initializes the output and turns the strip off. Call from `setup()`.
+     */
+    void begin() {
+        _strip.begin();
+        off();
+    }
+
+    /**
+     * @brief Turns the entire strip on to full white.
+     */
+    void on() {
+        setColor({255, 255, 255});
+    }
+
+    /**
+     * @brief Turns the entire strip off.
+     */
+    void off() {
+        setColor({0, 0, 0});
+    }
+
+    /**
+     * @brief Sets the color of the entire strip and shows it (or defers if a frame is open).
+     * @param color The RgbColor to set.
+     */
+    void setColor(const RgbColor& color) {
+        for (uint16_t i = 0; i < Count; i++) {
+            _colors[i] = color;
+        }
+        requestShow();
+    }
+
+    /**
+     * @brief Sets the color of an individual pixel. Does not call `show()`.
+     * @param pixelIndex The index of the pixel to set.
+     * @param color The RgbColor to set.
+     */
+    void setPixelColor(uint16_t pixelIndex, const RgbColor& color) {
+        if (pixelIndex < Count) {
+            _colors[pixelIndex] = color;
+        }
+    }
+
+    /**
+     * @brief Sets the brightness of the entire strip and shows it (or defers if a frame is open).
+     * The stored colors are not changed; brightness is applied when they are output.
+     * @param brightness The brightness level (0-255).
+     */
+    void setBrightness(uint8_t brightness) {
+        _scale.setScale(brightness);
+        requestShow();
+    }
+
+    /**
+     * @brief Sets the output correction and shows the strip (or defers if a frame is open).
+     * @param correction The correction, or `nullptr` to output linear values.
+     */
+    void setColorCorrection(const ColorCorrection* correction) {
+        _correction = correction;
+        requestShow();
+    }
+
+    /**
+     * @brief Converts the colors with the current brightness and correction and pushes them to the strip.
+     */
+    void show() {
+        _strip.writePixels(_colors, 0, Count, _scale.data(), _correction);
+        _strip.transmit(Count);
+    }
+
+    /**
+     * @brief Opens a frame transaction; implicit shows are deferred until `commitFrame()`.
+     */
+    void beginFrame() {
+        _inFrame = true;
+    }
+
+    /**
+     * @brief Closes a frame transaction and shows the strip once if a show was deferred.
+     */
+    void commitFrame() {
+        _inFrame = false;
+        if (_showPending) {
+            _showPending = false;
+            show();
+        }
+    }
+
+    /**
+     * @brief Gets the number of pixels in the strip.
+     * @return The number of pixels.
+     */
+    static constexpr uint16_t numPixels() { return Count; }
+
+private:
+    /**
+     * @brief Shows the strip now, or marks it for flushing at `commitFrame()` if a frame is open.
+     */
+    void requestShow() {
+        if (_inFrame) {
+            _showPending = true;
+        } else {
+            show();
+        }
+    }
+
+    RgbColor _colors[Count];        ///< Full-precision colors of all pixels.
+    uint8_t _pixels[Count * 3];     ///< Output buffer used by `_strip`, with brightness applied.
+    ScaleTable _scale;              ///< Brightness scale applied when converting for output.
+    NeoPixelOutput _strip;          ///< The underlying Adafruit_NeoPixel object.
+    const ColorCorrection* _correction = nullptr;   ///< Output correction, or `nullptr` for linear output.
+    bool _inFrame = false;          ///< True while a frame transaction is open.
+    bool _showPending = false;      ///< True if a `show()` was deferred during the open frame.
+};
+
+} // namespace StaticLed
+
+/**
+ * @class StaticLedHAL
+ * @brief LED HAL whose drivers are fixed at compile time.
+ *
+ * Holds one instance of each driver type in `Drivers`. Drivers are addressed by
+ * their position with `get<I>()`. Group operations are expanded at compile time
+ * into one direct call per matching driver; with a compile-time group ID the
+ * non-matching drivers are removed entirely.
+ *
+ * @tparam Drivers The StaticLed driver types, in order.
+ */
+template <typename... Drivers>
+class StaticLedHAL {
+public:
+    /**
+     * @brief The number of drivers held by the HAL.
+     */
+    static constexpr size_t size() { return sizeof...(Drivers); }
+
+    /**
+     * @brief Configures all drivers. Call from `setup()`.
+     */
+    void begin() {
+        forEach(Begin());
+    }
+
+    /**
+     * @brief Accesses a driver by its position in the template argument list.
+     * @tparam I The zero-based position of the driver.
+     * @return A reference to the driver.
+     */
+    template <size_t I>
+    typename std::tuple_element<I, std::tuple<Drivers...>>::type& get() {
+        return std::get<I>(_drivers);
+    }
+
+    /**
+     * @brief Sets the color for all drivers within a group known at runtime.
+     * @param groupId The ID of the group to control.
+     * @param color The RgbColor to set.
+     */
+    void setGroupColor(uint8_t groupId, const RgbColor& color) {
+        forEach(InGroup<SetColor>{groupId, SetColor{color}});
+    }
+
+    /**
+     * @brief Sets the brightness for all drivers within a group known at runtime.
+     * @param groupId The ID of the group to control.
+     * @param brightness The brightness level (0-255).
+     */
+    void setGroupBrightness(uint8_t groupId, uint8_t brightness) {
+        forEach(InGroup<SetBrightness>{groupId, SetBrightness{brightness}});
+    }
+
+    /**
+     * @brief Sets the color for all drivers within a group known at compile time.
+     * Only calls for the members of `GroupId` are generated.
+     * @tparam GroupId The ID of the group to control.
+     * @param color The RgbColor to set.
+     */
+    template <uint8_t GroupId>
+    void setGroupColor(const RgbColor& color) {
+        forEach(InStaticGroup<GroupId, SetColor>{SetColor{color}});
+    }
+
+    /**
+     * @brief Sets the brightness for all drivers within a group known at compile time.
+     * Only calls for the members of `GroupId` are generated.
+     * @tparam GroupId The ID of the group to control.
+     * @param brightness The brightness level (0-255).
+     */
+    template <uint8_t GroupId>
+    void setGroupBrightness(uint8_t brightness) {
+        forEach(InStaticGroup<GroupId, SetBrightness>{SetBrightness{brightness}});
+    }
+
+    /**
+     * @brief Sets the output correction of all drivers.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     *                   Call again after changing it, so that the drivers re-render their outputs.
+     */
+    void setColorCorrection(const ColorCorrection* correction) {
+        forEach(SetColorCorrection{correction});
+    }
+
+    /**
+     * @brief Sets the output correction for all drivers within a group known at runtime.
+     * @param groupId The ID of the group to configure.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     */
+    void setGroupColorCorrection(uint8_t groupId, const ColorCorrection* correction) {
+        forEach(InGroup<SetColorCorrection>{groupId, SetColorCorrection{correction}});
+    }
+
+    /**
+     * @brief Opens a frame transaction across all drivers.
+     * Nested calls are counted; only the outermost frame is forwarded to the drivers.
+     */
+    void beginFrame() {
+        if (_frameDepth++ == 0) {
+            forEach(BeginFrame());
+        }
+    }
+
+    /**
+     * @brief Closes a frame transaction, flushing each driver with deferred output once.
+     */
+    void commitFrame() {
+        if (_frameDepth > 0 && --_frameDepth == 0) {
+            forEach(CommitFrame());
+        }
+    }
+
+private:
+    /** @name Driver calls
+     * Function objects passed to `forEach()`. The HAL is kept to C++11, which has no
+     * generic lambdas, so each call is a struct with a templated call operator.
+     */
+    ///@{
+    struct Begin {
+        template <typename Driver>
+        void operator()(Driver& driver) const { driver.begin(); }
+    };
+
+    struct BeginFrame {
+        template <typename Driver>
+        void operator()(Driver& driver) const { driver.beginFrame(); }
+    };
+
+    struct CommitFrame {
+        template <typename Driver>
+        void operator()(Driver& driver) const { driver.commitFrame(); }
+    };
+
+    struct SetColor {
+        const RgbColor& color;
+        template <typename Driver>
+        void operator()(Driver& driver) const { driver.setColor(color); }
+    };
+
+    struct SetBrightness {
+        uint8_t brightness;
+        template <typename Driver>
+        void operator()(Driver& driver) const { driver.setBrightness(brightness); }
+    };
+
+    struct SetColorCorrection {
+        const ColorCorrection* correction;
+        template <typename Driver>
+        void operator()(Driver& driver) const { driver.setColorCorrection(correction); }
+    };
+
+    /// Forwards a call to the drivers of a group known at runtime.
+    template <typename Call>
+    struct InGroup {
+        uint8_t groupId;
+        Call call;
+        template <typename Driver>
+        void operator()(Driver& driver) const {
+            if (Driver::groupId == groupId) {
+                call(driver);
+            }
+        }
+    };
+
+    /// Forwards a call to the drivers of a group known at compile time.
+    template <uint8_t GroupId, typename Call>
+    struct InStaticGroup {
+        Call call;
+        template <typename Driver>
+        void operator()(Driver& driver) const {
+            if (Driver::groupId == GroupId) {
+                call(driver);
+            }
+        }
+    };
+    ///@}
+
+    /**
+     * @brief Calls `function` once for every driver from position `I` on, expanded at compile time.
+     */
+    template <size_t I = 0, typename Function>
+    typename std::enable_if<(I < sizeof...(Drivers))>::type forEach(const Function& function) {
+        function(std::get<I>(_drivers));
+        forEach<I + 1>(function);
+    }
+
+    template <size_t I, typename Function>
+    typename std::enable_if<(I == sizeof...(Drivers))>::type forEach(const Function&) {}
+
+    std::tuple<Drivers...> _drivers;    ///< The driver instances.
+    uint8_t _frameDepth = 0;            ///< Nesting depth of open frame transactions.
+};
+
+#endif // STATIC_LED_HAL_H
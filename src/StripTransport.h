@@ -0,0 +1,84 @@
+/**
+ * @file StripTransport.h
+ * @brief Interface for asynchronous transmission of addressable strip data.
+ *
+ * By default the strip drivers transmit through the Adafruit NeoPixel library,
+ * which bit-bangs the data with interrupts disabled and returns only when the
+ * whole chain was sent. A StripTransport instead takes a frame, starts sending it
+ * in the background (e.g. PIO and DMA on the RP2040) and returns immediately.
+ */
+#ifndef XDUINORAILS_STRIP_TRANSPORT_H
+#define XDUINORAILS_STRIP_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class StripTransport
+ * @brief Abstract base class for background transmitters of strip data.
+ *
+ * A transport sends one frame at a time. The data passed to `transmit()` must stay
+ * valid and unchanged until the transport is idle again. The strip drivers ensure
+ * this by rendering into a separate buffer and calling `waitIdle()` before they
+ * convert the next frame into the transmit buffer.
+ */
+class StripTransport {
+public:
+    /**
+     * @brief Function called when a frame was sent.
+     * May be called from an interrupt handler or another thread, depending on the
+     * transport; keep it short.
+     * @param context The pointer passed to `setCompletionCallback()`.
+     */
+    typedef void (*CompletionCallback)(void* context);
+
+    virtual ~StripTransport() {}
+
+    /**
+     * @brief Starts transmitting a frame and returns without waiting for it.
+     * Must only be called while the transport is idle.
+     * @param data The bytes to send, in wire order.
+     * @param length The number of bytes to send.
+     */
+    virtual void transmit(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * @brief Checks whether a frame, including the latch interval after it, is in progress.
+     * @return True if the transport is busy.
+     */
+    virtual bool isBusy() = 0;
+
+    /**
+     * @brief Blocks until the transport is idle.
+     */
+    virtual void waitIdle() {
+        while (isBusy()) {
+        }
+    }
+
+    /**
+     * @brief Sets the function to call whenever a frame was sent.
+     * @param callback The function, or `nullptr` to remove it.
+     * @param context A pointer passed to the function.
+     */
+    void setCompletionCallback(CompletionCallback callback, void* context = nullptr) {
+        _callback = callback;
+        _context = context;
+    }
+
+protected:
+    /**
+     * @brief Calls the completion callback, if one is set.
+     */
+    void notifyComplete() {
+        if (_callback) {
+            _callback(_context);
+        }
+    }
+
+private:
+    CompletionCallback _callback = nullptr;     ///< The completion callback.
+    void* _context = nullptr;                   ///< The context passed to `_callback`.
+};
+
+#endif // XDUINORAILS_STRIP_TRANSPORT_H
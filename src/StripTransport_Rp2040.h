@@ -0,0 +1,248 @@
+/**
+ * @file StripTransport_Rp2040.h
+ * @brief WS2812 transport for the RP2040 using a PIO state machine fed by DMA.
+ *
+ * The PIO program generates the 800 kHz WS2812 waveform, and a DMA channel feeds
+ * it from the frame buffer. The CPU is only involved when a frame starts and in
+ * the DMA completion interrupt, so interrupts stay enabled during transmission.
+ * With several lanes, up to eight chains on consecutive GPIOs are driven at once
+ * from bit-plane data (@see LedParallelStrip).
+ */
+#ifndef XDUINORAILS_STRIP_TRANSPORT_RP2040_H
+#define XDUINORAILS_STRIP_TRANSPORT_RP2040_H
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+#include <Arduino.h>
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/pio.h>
+#include "StripTransport.h"
+
+/**
+ * @class Rp2040PioStripTransport
+ * @brief StripTransport for WS2812 chains on the RP2040.
+ *
+ * Uses one PIO state machine (from PIO0 or PIO1, whichever has room) and one DMA
+ * channel. The DMA channel writes single bytes to the TX FIFO; the bus replicates
+ * them into all byte lanes and the state machine shifts out the top eight bits.
+ *
+ * With one lane, each byte of a frame is eight bits of one chain, MSB first. With
+ * several lanes, each byte is one bit slot of all chains: bit `k` goes to the chain
+ * on GPIO `pin + k`, so a frame takes an eighth of the time per byte.
+ *
+ * @code
+ * Rp2040PioStripTransport transport(6);
+ * LedNeoPixel strip(6, 300);
+ *
+ * void setup() {
+ *   transport.begin();
+ *   strip.setTransport(&transport);
+ * }
+ * @endcode
+ */
+class Rp2040PioStripTransport : public StripTransport {
+public:
+    /**
+     * @brief Constructor. Does not touch the hardware until `begin()` is called.
+     * @param pin The GPIO connected to the data line of the (first) chain.
+     * @param laneCount The number of chains on consecutive GPIOs, 1 to 8. With more
+     *                  than one, frames are bit planes as produced by LedParallelStrip.
+     */
+    explicit Rp2040PioStripTransport(uint8_t pin, uint8_t laneCount = 1)
+        : _pin(pin), _laneCount(laneCount < 1 ? 1 : (laneCount > 8 ? 8 : laneCount)),
+          _pio(nullptr), _sm(-1), _dma(-1), _offset(0), _active(false), _endMicros(0) {}
+
+    /**
+     * @brief Destructor that waits for the current frame and releases the hardware.
+     */
+    ~Rp2040PioStripTransport() {
+        if (_dma >= 0) {
+            waitIdle();
+            dma_channel_set_irq0_enabled(_dma, false);
+            instances()[_dma] = nullptr;
+            dma_channel_unclaim(_dma);
+        }
+        if (_sm >= 0) {
+            pio_sm_set_enabled(_pio, _sm, false);
+            pio_remove_program(_pio, &program(), _offset);
+            pio_sm_unclaim(_pio, _sm);
+        }
+    }
+
+    /**
+     * @brief Claims a state machine and a DMA channel and starts the PIO program.
+     * @return True on success, false if no state machine, program space or DMA channel is free.
+     */
+    bool begin() {
+        if (!claimStateMachine(pio0) && !claimStateMachine(pio1)) {
+            return false;
+        }
+        _dma = dma_claim_unused_channel(false);
+        if (_dma < 0) {
+            return false;
+        }
+
+        for (uint8_t lane = 0; lane < _laneCount; lane++) {
+            pio_gpio_init(_pio, _pin + lane);
+        }
+        pio_sm_set_consecutive_pindirs(_pio, _sm, _pin, _laneCount, true);
+        pio_sm_config config = pio_get_default_sm_config();
+        sm_config_set_wrap(&config, _offset, _offset + 3);
+        if (_laneCount == 1) {
+            sm_config_set_sideset(&config, 1, false, false);
+            sm_config_set_sideset_pins(&config, _pin);
+        } else {
+            sm_config_set_out_pins(&config, _pin, _laneCount);
+        }
+        sm_config_set_out_shift(&config, false, true, 8);
+        sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+        // Ten PIO cycles per bit at 800 kHz.
+        sm_config_set_clkdiv(&config, clock_get_hz(clk_sys) / (800000.0f * 10));
+        pio_sm_init(_pio, _sm, _offset, &config);
+        pio_sm_set_enabled(_pio, _sm, true);
+
+        dma_channel_config dmaConfig = dma_channel_get_default_config(_dma);
+        channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_8);
+        channel_config_set_read_increment(&dmaConfig, true);
+        channel_config_set_write_increment(&dmaConfig, false);
+        channel_config_set_dreq(&dmaConfig, pio_get_dreq(_pio, _sm, true));
+        dma_channel_configure(_dma, &dmaConfig, &_pio->txf[_sm], nullptr, 0, false);
+
+        instances()[_dma] = this;
+        static bool handlerInstalled = false;
+        if (!handlerInstalled) {
+            irq_add_shared_handler(DMA_IRQ_0, dmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(DMA_IRQ_0, true);
+            handlerInstalled = true;
+        }
+        dma_channel_set_irq0_enabled(_dma, true);
+        return true;
+    }
+
+    /**
+     * @brief Starts the DMA transfer of a frame.
+     * @param data The bytes to send, in wire order.
+     * @param length The number of bytes to send.
+     */
+    void transmit(const uint8_t* data, size_t length) override {
+        if (_dma < 0 || length == 0) {
+            return;
+        }
+        // Estimate the end until the completion interrupt records the exact time.
+        _endMicros = time_us_32() + byteMicros(length) + kLatchMicros;
+        _active = true;
+        dma_channel_transfer_from_buffer_now(_dma, data, length);
+    }
+
+    /**
+     * @brief Checks whether a frame or its latch interval is in progress.
+     * @return True if the transport is busy.
+     */
+    bool isBusy() override {
+        if (!_active) {
+            return false;
+        }
+        if (dma_channel_is_busy(_dma) || (int32_t)(time_us_32() - _endMicros) < 0) {
+            return true;
+        }
+        _active = false;
+        return false;
+    }
+
+private:
+    /// Bytes that can still be in the FIFO and the shift register when the DMA completes.
+    static const uint32_t kTailBytes = 9;
+    /// Minimum low time that latches the data into the chain.
+    static const uint32_t kLatchMicros = 300;
+
+    /**
+     * @brief Gets the wire time of a number of bytes at 800 kHz (1.25 µs per bit slot).
+     */
+    uint32_t byteMicros(size_t length) const {
+        uint32_t bitSlots = (uint32_t)length * (_laneCount == 1 ? 8 : 1);
+        return bitSlots * 5 / 4;
+    }
+
+    /**
+     * @brief Gets the PIO program for the lane count, ten cycles per bit with T1 = 2, T2 = 5, T3 = 3.
+     */
+    const pio_program_t& program() const {
+        static const uint16_t serialInstructions[] = {
+            0x6221, // 0: out    x, 1            side 0 [2]
+            0x1123, // 1: jmp    !x, 3           side 1 [1]
+            0x1400, // 2: jmp    0               side 1 [4]
+            0xa442, // 3: nop                    side 0 [4]
+        };
+        static const uint16_t parallelInstructions[] = {
+            0x6028, // 0: out    x, 8
+            0xa10b, // 1: mov    pins, !null     [1]
+            0xa401, // 2: mov    pins, x         [4]
+            0xa103, // 3: mov    pins, null      [1]
+        };
+        static const pio_program_t serial = {serialInstructions, 4, -1};
+        static const pio_program_t parallel = {parallelInstructions, 4, -1};
+        return _laneCount == 1 ? serial : parallel;
+    }
+
+    /**
+     * @brief Gets the transports indexed by their DMA channel.
+     */
+    static Rp2040PioStripTransport** instances() {
+        static Rp2040PioStripTransport* list[NUM_DMA_CHANNELS] = {};
+        return list;
+    }
+
+    /**
+     * @brief Shared DMA_IRQ_0 handler that completes the frames of all transports.
+     */
+    static void dmaIrqHandler() {
+        Rp2040PioStripTransport** list = instances();
+        for (uint8_t channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+            if (list[channel] && dma_channel_get_irq0_status(channel)) {
+                dma_channel_acknowledge_irq0(channel);
+                list[channel]->onDmaComplete();
+            }
+        }
+    }
+
+    /**
+     * @brief Tries to claim a state machine and load the program on a PIO block.
+     * @return True if both succeeded.
+     */
+    bool claimStateMachine(PIO pio) {
+        if (!pio_can_add_program(pio, &program())) {
+            return false;
+        }
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) {
+            return false;
+        }
+        _pio = pio;
+        _sm = sm;
+        _offset = pio_add_program(pio, &program());
+        return true;
+    }
+
+    /**
+     * @brief Called from the interrupt handler when the DMA handed the last byte to the PIO.
+     */
+    void onDmaComplete() {
+        _endMicros = time_us_32() + byteMicros(kTailBytes) + kLatchMicros;
+        notifyComplete();
+    }
+
+    uint8_t _pin;                   ///< The data pin of the first chain.
+    uint8_t _laneCount;             ///< The number of chains driven in parallel.
+    PIO _pio;                       ///< The PIO block running the program.
+    int _sm;                        ///< The claimed state machine, or -1.
+    int _dma;                       ///< The claimed DMA channel, or -1.
+    uint _offset;                   ///< The program offset in the PIO instruction memory.
+    volatile bool _active;          ///< True from `transmit()` until the latch interval has passed.
+    volatile uint32_t _endMicros;   ///< Time at which the latch interval of the current frame ends.
+};
+
+#endif // ARDUINO_ARCH_RP2040
+
+#endif // XDUINORAILS_STRIP_TRANSPORT_RP2040_H
@@ -0,0 +1,145 @@
+/**
+ * @file StripTransport_Spi.h
+ * @brief WS2812 transport that sends the data through a hardware SPI port.
+ *
+ * The frame is expanded into SPI symbols (@see Ws2812SpiEncoder) and shifted out
+ * on MOSI by the SPI peripheral. Unlike the bit-banged output of the Adafruit
+ * library, the waveform does not depend on instruction timing, so interrupts stay
+ * enabled and the driver works at any CPU clock that can reach the SPI rate.
+ */
+#ifndef XDUINORAILS_STRIP_TRANSPORT_SPI_H
+#define XDUINORAILS_STRIP_TRANSPORT_SPI_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "StripTransport.h"
+#include "Ws2812SpiEncoder.h"
+
+/**
+ * @class SpiStripTransport
+ * @brief StripTransport for a WS2812 chain connected to the MOSI pin of an SPI port.
+ *
+ * `transmit()` encodes the frame into its own buffer and hands it to
+ * `SPIClass::transfer()`, which cores with SPI DMA or deep FIFOs (RP2040, ESP32,
+ * SAMD) send without per-byte CPU work. The call returns when the SPI transfer has
+ * finished; the transport then stays busy for the latch interval, so the next
+ * frame can be drawn meanwhile. The SCK and MISO pins of the port are not used by
+ * the chain but are claimed by the SPI peripheral.
+ *
+ * @code
+ * SpiStripTransport transport(300 * 3);
+ * LedNeoPixel strip(6, 300); // The pin is unused with the transport.
+ *
+ * void setup() {
+ *   transport.begin();
+ *   strip.setTransport(&transport);
+ * }
+ * @endcode
+ */
+class SpiStripTransport : public StripTransport {
+public:
+    /**
+     * @brief Constructor that allocates the encode buffer.
+     * @param maxLength The largest frame in bytes, e.g. three bytes per pixel.
+     *                  Longer frames are truncated.
+     * @param spi The SPI port whose MOSI pin drives the chain.
+     * @param clockHz The SPI clock. The core selects the nearest rate it supports
+     *                at or below it; it should stay within ±25% of 3.2 MHz.
+     */
+    explicit SpiStripTransport(size_t maxLength, SPIClass& spi = SPI, uint32_t clockHz = Ws2812SpiEncoder::kSpiClockHz)
+        : _spi(spi), _settings(clockHz, MSBFIRST, SPI_MODE0), _clockHz(clockHz), _maxLength(maxLength),
+          _buffer(new uint8_t[Ws2812SpiEncoder::encodedSize(maxLength)]), _active(false), _endMicros(0) {}
+
+    /**
+     * @brief Destructor that waits for the latch interval and frees the encode buffer.
+     */
+    ~SpiStripTransport() {
+        waitIdle();
+        delete[] _buffer;
+    }
+
+    SpiStripTransport(const SpiStripTransport&) = delete;
+    SpiStripTransport& operator=(const SpiStripTransport&) = delete;
+
+    /**
+     * @brief Initializes the SPI port.
+     */
+    void begin() {
+        _spi.begin();
+    }
+
+    /**
+     * @brief Encodes a frame and sends it through the SPI port.
+     * @param data The bytes to send, in wire order.
+     * @param length The number of bytes to send. Clamped to the maximum length.
+     */
+    void transmit(const uint8_t* data, size_t length) override {
+        if (length > _maxLength) {
+            length = _maxLength;
+        }
+        if (length == 0) {
+            return;
+        }
+        size_t encodedLength = Ws2812SpiEncoder::encodedSize(length);
+        Ws2812SpiEncoder::encode(data, length, _buffer);
+        _spi.beginTransaction(_settings);
+        // The buffer is re-encoded for every frame, so received bytes may overwrite it.
+        _spi.transfer(_buffer, encodedLength);
+        _spi.endTransaction();
+        _endMicros = micros() + kLatchMicros;
+        _active = true;
+    }
+
+    /**
+     * @brief Checks whether the latch interval after the last frame is in progress.
+     * Calls the completion callback once the interval has passed.
+     * @return True if the transport is busy.
+     */
+    bool isBusy() override {
+        if (!_active) {
+            return false;
+        }
+        if ((long)(micros() - _endMicros) < 0) {
+            return true;
+        }
+        _active = false;
+        notifyComplete();
+        return false;
+    }
+
+    /**
+     * @brief Sleeps for the rest of the latch interval.
+     */
+    void waitIdle() override {
+        if (_active) {
+            long remaining = (long)(_endMicros - micros());
+            if (remaining > 0) {
+                delayMicroseconds((unsigned int)remaining);
+            }
+            while (isBusy()) {
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the SPI clock requested from the core.
+     * @return The clock in Hz.
+     */
+    uint32_t getClockHz() const {
+        return _clockHz;
+    }
+
+private:
+    /// Minimum low time that latches the data into the chain.
+    static const uint32_t kLatchMicros = 300;
+
+    SPIClass& _spi;             ///< The SPI port driving the chain.
+    SPISettings _settings;      ///< Clock, bit order and mode of the transfers.
+    uint32_t _clockHz;          ///< The requested SPI clock.
+    size_t _maxLength;          ///< The largest frame in data bytes.
+    uint8_t* _buffer;           ///< The encoded frame, four bytes per data byte.
+    bool _active;               ///< True from `transmit()` until the latch interval has passed.
+    unsigned long _endMicros;   ///< Time at which the latch interval of the last frame ends.
+};
+
+#endif // XDUINORAILS_STRIP_TRANSPORT_SPI_H
@@ -0,0 +1,93 @@
+/**
+ * @file Ws2812SpiEncoder.h
+ * @brief Conversion of WS2812 data bytes into an SPI bit stream.
+ *
+ * A WS2812 bit is a high pulse followed by a low time, 1.25 µs in total. Sent at
+ * 3.2 MHz, four SPI bits make up one WS2812 bit: `1000` is a 0 (312 ns high) and
+ * `1110` is a 1 (937 ns high). The MOSI line of a hardware SPI port then produces
+ * the waveform without any CPU timing.
+ */
+#ifndef XDUINORAILS_WS2812_SPI_ENCODER_H
+#define XDUINORAILS_WS2812_SPI_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class Ws2812SpiEncoder
+ * @brief Expands WS2812 data bytes into SPI symbols, four SPI bytes per data byte.
+ *
+ * Each data byte is split into two nibbles, and each nibble is looked up in a
+ * 16-entry table of 16-bit symbols. Both `encode()` and `encodeReference()`
+ * produce the same output; the latter converts bit by bit and serves as the
+ * specification the table is checked against.
+ */
+class Ws2812SpiEncoder {
+public:
+    /// The SPI clock at which four SPI bits take as long as one WS2812 bit.
+    static const uint32_t kSpiClockHz = 3200000;
+    /// The number of SPI bytes per data byte.
+    static const uint8_t kBytesPerByte = 4;
+    /// The four-bit SPI symbol of a WS2812 0 bit.
+    static const uint8_t kSymbol0 = 0x8;
+    /// The four-bit SPI symbol of a WS2812 1 bit.
+    static const uint8_t kSymbol1 = 0xE;
+
+    /**
+     * @brief Gets the number of SPI bytes needed for a number of data bytes.
+     * @param length The number of data bytes.
+     * @return The size of the encoded stream.
+     */
+    static size_t encodedSize(size_t length) {
+        return length * kBytesPerByte;
+    }
+
+    /**
+     * @brief Encodes data bytes through the nibble table.
+     * @param data The bytes in wire order.
+     * @param length The number of bytes in `data`.
+     * @param out Receives `encodedSize(length)` bytes, MSB first.
+     */
+    static void encode(const uint8_t* data, size_t length, uint8_t* out) {
+        const uint16_t* table = nibbleTable();
+        for (size_t i = 0; i < length; i++) {
+            uint8_t value = data[i];
+            uint32_t symbols = ((uint32_t)table[value >> 4] << 16) | table[value & 0x0F];
+            out[4 * i] = (uint8_t)(symbols >> 24);
+            out[4 * i + 1] = (uint8_t)(symbols >> 16);
+            out[4 * i + 2] = (uint8_t)(symbols >> 8);
+            out[4 * i + 3] = (uint8_t)symbols;
+        }
+    }
+
+    /**
+     * @brief Encodes data bytes one bit at a time.
+     * Slower than `encode()`; used to verify it.
+     * @param data The bytes in wire order.
+     * @param length The number of bytes in `data`.
+     * @param out Receives `encodedSize(length)` bytes, MSB first.
+     */
+    static void encodeReference(const uint8_t* data, size_t length, uint8_t* out) {
+        for (size_t i = 0; i < length; i++) {
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                uint8_t symbol = (data[i] & (0x80 >> bit)) ? kSymbol1 : kSymbol0;
+                uint8_t& target = out[i * kBytesPerByte + bit / 2];
+                target = (bit & 1) ? (uint8_t)(target | symbol) : (uint8_t)(symbol << 4);
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Gets the SPI symbols of the four bits of every nibble, MSB first.
+     */
+    static const uint16_t* nibbleTable() {
+        static const uint16_t table[16] = {
+            0x8888, 0x888E, 0x88E8, 0x88EE, 0x8E88, 0x8E8E, 0x8EE8, 0x8EEE,
+            0xE888, 0xE88E, 0xE8E8, 0xE8EE, 0xEE88, 0xEE8E, 0xEEE8, 0xEEEE,
+        };
+        return table;
+    }
+};
+
+#endif // XDUINORAILS_WS2812_SPI_ENCODER_H
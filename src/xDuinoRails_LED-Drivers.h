@@ -26,7 +26,9 @@ enum LedType {
     NEOPIXEL,       ///< For controlling Adafruit NeoPixel (WS2812B) addressable LED strips. @see LedNeoPixel
     WS2811_3x1,     ///< For a WS2811 IC driving three individual single-color LEDs. @see LedWs2811_3x1
     CHARLIEPLEX,    ///< For a charlieplexed matrix of LEDs. @see LedCharliePlex
-    MATRIX          ///< For a row/column scanned LED matrix. @see LedMatrix
+    MATRIX,         ///< For a row/column scanned LED matrix. @see LedMatrix
+    PARALLEL_NEOPIXEL, ///< For up to eight equally long NeoPixel strips sent in parallel; `numLeds` is per strip. @see LedParallelStrip
+    NEOPIXEL_DITHERED ///< For NeoPixel strips with 16-bit colors and temporal dithering. @see LedNeoPixelDithered
 };
 
 /**
@@ -85,6 +87,59 @@ public:
      * @param brightness The brightness level (0-255).
      */
     virtual void setGroupBrightness(uint8_t groupId, uint8_t brightness) = 0;
+
+    /**
+     * @brief Sets the output correction of all LED drivers, including ones added later.
+     *
+     * @param correction The correction (gamma, master brightness, color temperature), or
+     *                   `nullptr` for linear output. Must outlive the HAL. Call again after
+     *                   changing it, so that the drivers re-render their outputs.
+     */
+    virtual void setColorCorrection(const ColorCorrection* correction) = 0;
+
+    /**
+     * @brief Sets the output correction for all LED drivers within a specified group.
+     *
+     * @param groupId The ID of the group to configure.
+     * @param correction The correction, or `nullptr` for linear output. Must outlive the HAL.
+     */
+    virtual void setGroupColorCorrection(uint8_t groupId, const ColorCorrection* correction) = 0;
+
+    /**
+     * @brief Gets the number of LED drivers in a group.
+     *
+     * @param groupId The ID of the group to query.
+     * @return The number of Led objects in the group, or 0 if the group is unknown.
+     */
+    virtual uint16_t getGroupSize(uint8_t groupId) = 0;
+
+    /**
+     * @brief Retrieves a pointer to a member of a group by its index within that group.
+     *
+     * Together with `getGroupSize()` this allows iterating over the members of a group
+     * without scanning all LED drivers. The index matches `Led::getIndexInGroup()`.
+     *
+     * @param groupId The ID of the group.
+     * @param indexInGroup The zero-based index of the LED driver within the group.
+     * @return A pointer to the Led object, or nullptr if the group or index is invalid.
+     */
+    virtual Led* getGroupLed(uint8_t groupId, uint16_t indexInGroup) = 0;
+
+    /**
+     * @brief Opens a frame transaction across all LED drivers.
+     *
+     * Until the matching `commitFrame()`, drivers only update their buffers instead of
+     * pushing every change to the hardware. Frames may be nested; only the outermost
+     * `commitFrame()` flushes.
+     */
+    virtual void beginFrame() = 0;
+
+    /**
+     * @brief Closes a frame transaction.
+     *
+     * Each driver that deferred output during the frame is flushed exactly once.
+     */
+    virtual void commitFrame() = 0;
 };
 
 #endif // XDUINORAILS_LED_DRIVERS_H